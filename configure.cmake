@@ -240,6 +240,29 @@ IF(UNIX)
       "and the library (libwrap) are installed.")
     ENDIF()
   ENDIF()
+
+  OPTION(WITH_NUMA "Compile with NUMA aware thread and memory placement" ON)
+  IF(WITH_NUMA AND CMAKE_SYSTEM_NAME MATCHES "Linux")
+    SET(SAVE_CMAKE_REQUIRED_LIBRARIES ${CMAKE_REQUIRED_LIBRARIES})
+    SET(CMAKE_REQUIRED_LIBRARIES ${CMAKE_REQUIRED_LIBRARIES} numa)
+    CHECK_C_SOURCE_COMPILES(
+    "
+    #include <numa.h>
+    #include <numaif.h>
+    int main()
+    {
+      struct bitmask *nodes= numa_all_nodes_ptr;
+      set_mempolicy(MPOL_DEFAULT, 0, 0);
+      return numa_available() + numa_node_of_cpu(0) + (nodes != 0);
+    }"
+    HAVE_LIBNUMA)
+    SET(CMAKE_REQUIRED_LIBRARIES ${SAVE_CMAKE_REQUIRED_LIBRARIES})
+    IF(HAVE_LIBNUMA)
+      SET(LIBNUMA "numa")
+    ELSE()
+      MESSAGE(STATUS "libnuma not found, building without NUMA support")
+    ENDIF()
+  ENDIF()
 ENDIF()
 
 #
@@ -225,6 +225,9 @@ C_MODE_START
 /* lf_hash overhead per element (that is, sizeof(LF_SLIST) */
 extern const int LF_HASH_OVERHEAD;
 
+/* initializes an element inserted into the hash from the given data */
+typedef void lf_hash_init_func(uchar *dst, const uchar *src);
+
 typedef struct {
   LF_DYNARRAY array;                    /* hash itself */
   LF_ALLOCATOR alloc;                   /* allocator for elements */
@@ -232,6 +235,7 @@ typedef struct {
   CHARSET_INFO *charset;                /* see HASH */
   uint key_offset, key_length;          /* see HASH */
   uint element_size;                    /* size of memcpy'ed area on insert */
+  lf_hash_init_func *initializer;       /* used instead of memcpy if set */
   uint flags;                           /* LF_HASH_UNIQUE, etc */
   int32 volatile size;                  /* size of array */
   int32 volatile count;                 /* number of elements in the hash */
@@ -254,6 +254,7 @@ extern ulong myisam_concurrent_insert;
 extern my_bool myisam_flush,myisam_delay_key_write,myisam_single_user;
 extern my_off_t myisam_max_temp_length;
 extern ulong myisam_data_pointer_size;
+extern KEY_CACHE *myisam_internal_key_cache;	/* For internal tmp tables */
 
 /* usually used to check if a symlink points into the mysql data home */
 /* which is normally forbidden                                        */
@@ -574,6 +574,8 @@ void increment_thd_innodb_stats(MYSQL_THD thd,
                     long page_access);
 unsigned long thd_log_slow_verbosity(const MYSQL_THD thd);
 int thd_opt_slow_log();
+/* Maximum number of threads that may scan a table for one statement */
+unsigned long thd_parallel_degree(const MYSQL_THD thd);
 #define EXTENDED_SLOWLOG
 
 #define EXTENDED_FOR_USERSTAT
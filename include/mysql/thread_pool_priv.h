@@ -42,9 +42,8 @@
 #include <sql_profile.h>
 #include <table.h>
 #include "field.h"
-#include <set>
+#include <global_threads.h>
 
-typedef std::set<THD*>::iterator Thread_iterator;
 /* Needed to get access to scheduler variables */
 void* thd_get_scheduler_data(THD *thd);
 void thd_set_scheduler_data(THD *thd, void *data);
@@ -71,9 +70,10 @@ ulong  thd_get_net_wait_timeout(THD *thd);
 my_socket thd_get_fd(THD *thd);
 int thd_store_globals(THD* thd);
 
-/* Interface to global thread list iterator functions */
-Thread_iterator thd_get_global_thread_list_begin();
-Thread_iterator thd_get_global_thread_list_end();
+/*
+  The global thread list is visited with do_for_all_thd() and the other
+  functions of global_threads.h
+*/
 
 /* Print to the MySQL error log */
 void sql_print_error(const char *format, ...);
@@ -706,7 +706,7 @@ void init_embedded_mysql(MYSQL *mysql, int client_flag)
 void *create_embedded_thd(int client_flag)
 {
   THD * thd= new THD;
-  thd->thread_id= thd->variables.pseudo_thread_id= thread_id++;
+  thd->thread_id= thd->variables.pseudo_thread_id= next_thread_id();
 
   thd->thread_stack= (char*) &thd;
   if (thd->store_globals())
@@ -738,9 +738,7 @@ void *create_embedded_thd(int client_flag)
   thd->data_tail= &thd->first_data;
   memset(&thd->net, 0, sizeof(thd->net));
 
-  mysql_mutex_lock(&LOCK_thread_count);
   add_global_thread(thd);
-  mysql_mutex_unlock(&LOCK_thread_count);
   thd->mysys_var= 0;
   return thd;
 err:
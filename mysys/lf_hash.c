@@ -311,6 +311,9 @@ static int initialize_bucket(LF_HASH *, LF_SLIST * volatile*, uint, LF_PINS *);
   DYNAMIC_ARRAY. In this case they should be initialize in the
   LF_ALLOCATOR::constructor, and lf_hash_insert should not overwrite them.
   See wt_init() for example.
+  If LF_HASH::initializer is set after lf_hash_init, lf_hash_insert calls
+  it instead of memcpy, to initialize the element from the data it gets.
+  This is useful when the data is not an element but, for example, its key.
 */
 void lf_hash_init(LF_HASH *hash, uint element_size, uint flags,
                   uint key_offset, uint key_length, my_hash_get_key get_key,
@@ -322,6 +325,7 @@ void lf_hash_init(LF_HASH *hash, uint element_size, uint flags,
   hash->size= 1;
   hash->count= 0;
   hash->element_size= element_size;
+  hash->initializer= 0;
   hash->flags= flags;
   hash->charset= charset ? charset : &my_charset_bin;
   hash->key_offset= key_offset;
@@ -342,7 +346,11 @@ void lf_hash_destroy(LF_HASH *hash)
   {
     intptr next= el->link;
     if (el->hashnr & 1)
+    {
+      if (hash->alloc.destructor)
+        hash->alloc.destructor((uchar *)el);
       lf_alloc_direct_free(&hash->alloc, el); /* normal node */
+    }
     else
       my_free(el); /* dummy node */
     el= (LF_SLIST *)next;
@@ -354,7 +362,8 @@ void lf_hash_destroy(LF_HASH *hash)
 /*
   DESCRIPTION
     inserts a new element to a hash. it will have a _copy_ of
-    data, not a pointer to it.
+    data, not a pointer to it (or an element made by LF_HASH::initializer
+    from the data).
 
   RETURN
     0 - inserted
@@ -373,7 +382,10 @@ int lf_hash_insert(LF_HASH *hash, LF_PINS *pins, const void *data)
   node= (LF_SLIST *)_lf_alloc_new(pins);
   if (unlikely(!node))
     return -1;
-  memcpy(node+1, data, hash->element_size);
+  if (hash->initializer)
+    hash->initializer((uchar *)(node+1), (const uchar *)data);
+  else
+    memcpy(node+1, data, hash->element_size);
   node->key= hash_key(hash, (uchar *)(node+1), &node->keylen);
   hashnr= calc_hash(hash, node->key, node->keylen);
   bucket= hashnr % hash->size;
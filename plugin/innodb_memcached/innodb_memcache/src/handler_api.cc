@@ -47,6 +47,7 @@ Created 3/14/2011 Jimmy Yang
 #include "log_event.h"
 #include "innodb_config.h"
 #include "binlog.h"
+#include "global_threads.h"
 
 /** Some handler functions defined in sql/sql_table.cc and sql/handler.cc etc.
 and being used here */
@@ -87,7 +88,7 @@ handler_create_thd(
 	}
 
 	my_net_init(&thd->net,(st_vio*) 0);
-	thd->variables.pseudo_thread_id = thread_id++;
+	thd->variables.pseudo_thread_id = next_thread_id();
 	thd->thread_id = thd->variables.pseudo_thread_id;
 	thd->thread_stack = reinterpret_cast<char*>(&thd);
 	thd->store_globals();
@@ -1948,16 +1948,15 @@ static bool binlog_savepoint_rollback_can_release_mdl(handlerton *hton,
       Now they sync is done for next read.
 */
 
-static void adjust_linfo_offsets(my_off_t purge_offset)
+class Adjust_offset : public Do_THD_Impl
 {
-  mysql_mutex_lock(&LOCK_thread_count);
+public:
+  Adjust_offset(my_off_t value) : m_purge_offset(value) {}
 
-  Thread_iterator it= global_thread_list_begin();
-  Thread_iterator end= global_thread_list_end();
-  for (; it != end; ++it)
+  virtual void operator()(THD *thd)
   {
     LOG_INFO* linfo;
-    if ((linfo = (*it)->current_linfo))
+    if ((linfo = thd->current_linfo))
     {
       mysql_mutex_lock(&linfo->lock);
       /*
@@ -1965,48 +1964,74 @@ static void adjust_linfo_offsets(my_off_t purge_offset)
 	we just started reading the index file. In that case
 	we have nothing to adjust
       */
-      if (linfo->index_file_offset < purge_offset)
+      if (linfo->index_file_offset < m_purge_offset)
 	linfo->fatal = (linfo->index_file_offset != 0);
       else
-	linfo->index_file_offset -= purge_offset;
+	linfo->index_file_offset -= m_purge_offset;
       mysql_mutex_unlock(&linfo->lock);
     }
   }
+
+private:
+  my_off_t m_purge_offset;
+};
+
+
+static void adjust_linfo_offsets(my_off_t purge_offset)
+{
+  /* LOCK_thread_count protects thd->current_linfo */
+  mysql_mutex_lock(&LOCK_thread_count);
+  Adjust_offset adjust_offset(purge_offset);
+  do_for_all_thd(&adjust_offset);
   mysql_mutex_unlock(&LOCK_thread_count);
 }
 
 
-static int log_in_use(const char* log_name)
+class Log_in_use : public Do_THD_Impl
 {
-  size_t log_name_len = strlen(log_name) + 1;
-  int thread_count=0;
-#ifndef DBUG_OFF
-  if (current_thd)
-    DEBUG_SYNC(current_thd,"purge_logs_after_lock_index_before_thread_count");
-#endif
-  mysql_mutex_lock(&LOCK_thread_count);
+public:
+  Log_in_use(const char* value)
+    : m_log_name(value), m_log_name_len(strlen(value) + 1), m_count(0)
+  {}
 
-  Thread_iterator it= global_thread_list_begin();
-  Thread_iterator end= global_thread_list_end();
-  for (; it != end; ++it)
+  virtual void operator()(THD *thd)
   {
     LOG_INFO* linfo;
-    if ((linfo = (*it)->current_linfo))
+    if ((linfo = thd->current_linfo))
     {
       mysql_mutex_lock(&linfo->lock);
-      if(!memcmp(log_name, linfo->log_file_name, log_name_len))
+      if(!memcmp(m_log_name, linfo->log_file_name, m_log_name_len))
       {
-        thread_count++;
+        m_count++;
         sql_print_warning("file %s was not purged because it was being read"
-                          "by thread number %llu", log_name,
-                          (ulonglong)(*it)->thread_id);
+                          "by thread number %llu", m_log_name,
+                          (ulonglong)thd->thread_id);
       }
       mysql_mutex_unlock(&linfo->lock);
     }
   }
 
+  int get_count() const { return m_count; }
+
+private:
+  const char *m_log_name;
+  size_t m_log_name_len;
+  int m_count;
+};
+
+
+static int log_in_use(const char* log_name)
+{
+#ifndef DBUG_OFF
+  if (current_thd)
+    DEBUG_SYNC(current_thd,"purge_logs_after_lock_index_before_thread_count");
+#endif
+  /* LOCK_thread_count protects thd->current_linfo */
+  mysql_mutex_lock(&LOCK_thread_count);
+  Log_in_use log_in_use(log_name);
+  do_for_all_thd(&log_in_use);
   mysql_mutex_unlock(&LOCK_thread_count);
-  return thread_count;
+  return log_in_use.get_count();
 }
 
 static bool purge_error_message(THD* thd, int res)
@@ -134,9 +134,7 @@ post_init_event_thread(THD *thd)
   }
 
   inc_thread_running();
-  mysql_mutex_lock(&LOCK_thread_count);
   add_global_thread(thd);
-  mysql_mutex_unlock(&LOCK_thread_count);
   return FALSE;
 }
 
@@ -192,9 +190,7 @@ pre_init_event_thread(THD* thd)
   thd->slave_thread= 0;
   thd->variables.option_bits|= OPTION_AUTO_IS_NULL;
   thd->client_capabilities|= CLIENT_MULTI_RESULTS;
-  mysql_mutex_lock(&LOCK_thread_count);
-  thd->thread_id= thd->variables.pseudo_thread_id= thread_id++;
-  mysql_mutex_unlock(&LOCK_thread_count);
+  thd->thread_id= thd->variables.pseudo_thread_id= next_thread_id();
 
   /*
     Guarantees that we will see the thread in SHOW PROCESSLIST though its
@@ -695,6 +691,24 @@ end:
 }
 
 
+class Event_worker_thread_count : public Do_THD_Impl
+{
+public:
+  Event_worker_thread_count() : m_count(0) {}
+
+  virtual void operator()(THD *thd)
+  {
+    if (thd->system_thread == SYSTEM_THREAD_EVENT_WORKER)
+      m_count++;
+  }
+
+  uint get_count() const { return m_count; }
+
+private:
+  uint m_count;
+};
+
+
 /*
   Returns the number of living event worker threads.
 
@@ -705,18 +719,11 @@ end:
 uint
 Event_scheduler::workers_count()
 {
-  uint count= 0;
-
   DBUG_ENTER("Event_scheduler::workers_count");
-  mysql_mutex_lock(&LOCK_thread_count);
-  Thread_iterator it= global_thread_list_begin();
-  Thread_iterator end= global_thread_list_end();
-  for (; it != end; ++it)
-    if ((*it)->system_thread == SYSTEM_THREAD_EVENT_WORKER)
-      ++count;
-  mysql_mutex_unlock(&LOCK_thread_count);
-  DBUG_PRINT("exit", ("%d", count));
-  DBUG_RETURN(count);
+  Event_worker_thread_count count_event_workers;
+  do_for_all_thd(&count_event_workers);
+  DBUG_PRINT("exit", ("%d", count_event_workers.get_count()));
+  DBUG_RETURN(count_event_workers.get_count());
 }
 
 
@@ -238,6 +238,7 @@ ha_rows filesort(THD *thd, TABLE *table, Filesort *filesort,
                           table,
                           thd->variables.max_length_for_sort_data,
                           max_rows, sort_positions);
+  param.sort_threads= thd->variables.max_parallel_degree;
 
   table_sort.addon_buf= 0;
   table_sort.addon_length= param.addon_length;
@@ -14,6 +14,7 @@
    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
 
 #include "filesort_utils.h"
+#include "mysqld.h"
 #include "sql_const.h"
 #include "sql_sort.h"
 #include "table.h"
@@ -183,24 +184,151 @@ size_t try_reserve(std::pair<type*, ptrdiff_t> *buf, ptrdiff_t size)
   return buf->second;
 }
 
-} // namespace
 
-void Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
+/**
+  A key pointer together with eight bytes of the key, stored so that
+  comparing the prefixes as integers orders the keys by those bytes.
+ */
+struct Key_prefix
 {
-  if (count <= 1)
-    return;
-  if (param->sort_length == 0)
+  ulonglong prefix;
+  uchar *key;
+};
+
+
+/// Loads bytes [offset, offset + 8) of a key, padded with zeros.
+inline ulonglong load_prefix(const uchar *key, size_t offset,
+                             size_t sort_length)
+{
+  const size_t end= std::min(offset + 8, sort_length);
+  ulonglong prefix= 0;
+  for (size_t ix= offset; ix < end; ++ix)
+    prefix= (prefix << 8) | key[ix];
+  return prefix << (8 * (offset + 8 - end));
+}
+
+
+/**
+  Compares keys whose prefixes hold bytes [offset, offset + 8), and whose
+  bytes before offset are equal.
+ */
+class Key_prefix_compare :
+  public std::binary_function<const Key_prefix&, const Key_prefix&, bool>
+{
+public:
+  Key_prefix_compare(size_t offset, size_t sort_length)
+    : m_rest_offset(offset + 8), m_sort_length(sort_length) {}
+  bool operator()(const Key_prefix &k1, const Key_prefix &k2) const
+  {
+    if (k1.prefix != k2.prefix)
+      return k1.prefix < k2.prefix;
+    if (m_rest_offset >= m_sort_length)
+      return false;
+    return memcmp(k1.key + m_rest_offset, k2.key + m_rest_offset,
+                  m_sort_length - m_rest_offset) < 0;
+  }
+private:
+  size_t m_rest_offset;
+  size_t m_sort_length;
+};
+
+
+/// Buckets smaller than this are sorted by comparison.
+const uint MSD_RADIX_CUTOFF= 64;
+/// Maximum recursion depth, each level costs 1K of stack.
+const uint MSD_RADIX_MAX_DEPTH= 16;
+/// Fewest keys for which the MSD radix sort is used.
+const uint MSD_RADIX_MIN_KEYS= 1000;
+
+
+/**
+  Stable MSD radix sort of keys that are equal in the bytes before
+  byte 'byte' of their prefixes, which hold bytes [offset, offset + 8)
+  of the keys. Distributes the keys by one byte per pass into 'buffer',
+  which has room for 'count' keys, and sorts each bucket recursively.
+ */
+void msd_radixsort(Key_prefix *keys, Key_prefix *buffer, uint count,
+                   size_t offset, uint byte, uint depth, size_t sort_length)
+{
+  for (;;)
+  {
+    const Key_prefix_compare compare(offset, sort_length);
+    if (count < MSD_RADIX_CUTOFF)
+    {
+      // Insertion sort.
+      for (uint ix= 1; ix < count; ++ix)
+      {
+        const Key_prefix key= keys[ix];
+        uint iy= ix;
+        for (; iy > 0 && compare(key, keys[iy - 1]); --iy)
+          keys[iy]= keys[iy - 1];
+        keys[iy]= key;
+      }
+      return;
+    }
+    if (depth == MSD_RADIX_MAX_DEPTH)
+    {
+      std::stable_sort(keys, keys + count, compare);
+      return;
+    }
+    if (byte == 8)
+    {
+      // The prefixes are exhausted, load the next eight bytes.
+      offset+= 8;
+      if (offset >= sort_length)
+        return;
+      for (uint ix= 0; ix < count; ++ix)
+        keys[ix].prefix= load_prefix(keys[ix].key, offset, sort_length);
+      byte= 0;
+    }
+
+    const uint shift= 56 - 8 * byte++;
+    uint32 bucket[256];
+    memset(bucket, 0, sizeof(bucket));
+    for (uint ix= 0; ix < count; ++ix)
+      ++bucket[(keys[ix].prefix >> shift) & 0xff];
+
+    // All the keys are equal in this byte: go on with the next one.
+    if (bucket[(keys[0].prefix >> shift) & 0xff] == count)
+      continue;
+
+    for (uint ix= 1; ix < 256; ++ix)
+      bucket[ix]+= bucket[ix - 1];
+    for (uint ix= count; ix-- > 0; )
+      buffer[--bucket[(keys[ix].prefix >> shift) & 0xff]]= keys[ix];
+    memcpy(keys, buffer, count * sizeof(Key_prefix));
+
+    // Now bucket[i] is where the keys with byte value i start.
+    for (uint ix= 0; ix < 256; ++ix)
+    {
+      const uint end= ix < 255 ? bucket[ix + 1] : count;
+      if (end - bucket[ix] > 1)
+        msd_radixsort(keys + bucket[ix], buffer + bucket[ix],
+                      end - bucket[ix], offset, byte, depth + 1,
+                      sort_length);
+    }
     return;
+  }
+}
 
-  uchar **keys= get_sort_keys();
+
+/**
+  Sorts an array of pointers to keys of sort_length bytes each.
+  All the algorithms used are stable for keys longer than 0 bytes.
+ */
+void sort_keys(uchar **keys, uint count, size_t sort_length)
+{
   std::pair<uchar**, ptrdiff_t> buffer;
-  if (radixsort_is_appliccable(count, param->sort_length) &&
+  if (radixsort_is_appliccable(count, sort_length) &&
       try_reserve(&buffer, count))
   {
-    radixsort_for_str_ptr(keys, count, param->sort_length, buffer.first);
+    radixsort_for_str_ptr(keys, count, sort_length, buffer.first);
     std::return_temporary_buffer(buffer.first);
     return;
   }
+  if (count >= MSD_RADIX_MIN_KEYS &&
+      msd_radixsort_for_str_ptr(keys, count, sort_length))
+    return;
   /*
     std::stable_sort has some extra overhead in allocating the temp buffer,
     which takes some time. The cutover point where it starts to get faster
@@ -209,9 +337,160 @@ void Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
   */
   if (count < 100)
   {
-    size_t size= param->sort_length;
+    size_t size= sort_length;
     my_qsort2(keys, count, sizeof(uchar*), get_ptr_compare(size), &size);
     return;
   }
-  std::stable_sort(keys, keys + count, Mem_compare(param->sort_length));
+  std::stable_sort(keys, keys + count, Mem_compare(sort_length));
+}
+
+
+/**
+  Fewest keys worth handing to a thread of their own: below this, creating
+  the thread costs about as much as sorting the keys.
+ */
+const uint MIN_KEYS_PER_SORT_THREAD= 8192;
+
+
+/**
+  One step of a parallel sort: sorts the keys in [first, last), or, if
+  'to' is set, merges the sorted ranges [first, middle) and [middle, last)
+  into the array starting at 'to'.
+ */
+struct Sort_job
+{
+  uchar **first;
+  uchar **middle;
+  uchar **last;
+  uchar **to;
+  size_t sort_length;
+
+  void run()
+  {
+    if (to == NULL)
+      sort_keys(first, (uint) (last - first), sort_length);
+    else
+      std::merge(first, middle, middle, last, to, Mem_compare(sort_length));
+  }
+};
+
+} // namespace
+
+
+bool msd_radixsort_for_str_ptr(uchar **keys, uint count, size_t sort_length)
+{
+  std::pair<Key_prefix*, ptrdiff_t> buffer;
+  if (!try_reserve(&buffer, 2 * (ptrdiff_t) count))
+    return false;
+
+  Key_prefix *prefixes= buffer.first;
+  for (uint ix= 0; ix < count; ++ix)
+  {
+    prefixes[ix].prefix= load_prefix(keys[ix], 0, sort_length);
+    prefixes[ix].key= keys[ix];
+  }
+  msd_radixsort(prefixes, prefixes + count, count, 0, 0, 0, sort_length);
+  for (uint ix= 0; ix < count; ++ix)
+    keys[ix]= prefixes[ix].key;
+
+  std::return_temporary_buffer(buffer.first);
+  return true;
+}
+
+
+pthread_handler_t filesort_sort_thread(void *arg)
+{
+  my_thread_init();
+  static_cast<Sort_job*>(arg)->run();
+  my_thread_end();
+  return NULL;
+}
+
+
+/**
+  Runs a set of independent jobs: the first one in the calling thread, and
+  each of the others in a thread of its own. If a thread cannot be created,
+  the calling thread runs its job after the first one.
+ */
+static void run_sort_jobs(std::vector<Sort_job> *jobs)
+{
+  std::vector<pthread_t> threads(jobs->size());
+  std::vector<bool> started(jobs->size(), false);
+
+  for (size_t ix= 1; ix < jobs->size(); ++ix)
+    started[ix]= !mysql_thread_create(key_thread_filesort, &threads[ix], NULL,
+                                      filesort_sort_thread, &(*jobs)[ix]);
+
+  (*jobs)[0].run();
+
+  for (size_t ix= 1; ix < jobs->size(); ++ix)
+  {
+    if (started[ix])
+      pthread_join(threads[ix], NULL);
+    else
+      (*jobs)[ix].run();
+  }
+}
+
+
+void Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
+{
+  if (count <= 1)
+    return;
+  if (param->sort_length == 0)
+    return;
+
+  uchar **keys= get_sort_keys();
+  const uint num_chunks=
+    std::min(param->sort_threads, count / MIN_KEYS_PER_SORT_THREAD);
+  std::pair<uchar**, ptrdiff_t> buffer;
+  if (num_chunks <= 1 || !try_reserve(&buffer, count))
+  {
+    sort_keys(keys, count, param->sort_length);
+    return;
+  }
+
+  /*
+    Sort num_chunks slices of the key array in parallel. Then merge pairs
+    of adjacent sorted slices, also in parallel, until one slice is left,
+    moving the keys back and forth between the key array and a temporary
+    array. Since the sorting and merging are stable, the result is the same
+    as if the whole array had been sorted by one thread.
+  */
+  std::vector<uint> bounds;
+  std::vector<Sort_job> jobs;
+  for (uint ix= 0; ix <= num_chunks; ++ix)
+    bounds.push_back((uint) ((ulonglong) count * ix / num_chunks));
+  for (uint ix= 0; ix < num_chunks; ++ix)
+  {
+    Sort_job job= { keys + bounds[ix], NULL, keys + bounds[ix + 1], NULL,
+                    param->sort_length };
+    jobs.push_back(job);
+  }
+  run_sort_jobs(&jobs);
+
+  uchar **from= keys;
+  uchar **to= buffer.first;
+  while (bounds.size() > 2)
+  {
+    const size_t num_slices= bounds.size() - 1;
+    std::vector<uint> merged_bounds;
+    jobs.clear();
+    for (size_t ix= 0; ix < num_slices; ix+= 2)
+    {
+      const uint last= bounds[std::min(ix + 2, num_slices)];
+      Sort_job job= { from + bounds[ix], from + bounds[ix + 1], from + last,
+                      to + bounds[ix], param->sort_length };
+      jobs.push_back(job);
+      merged_bounds.push_back(bounds[ix]);
+    }
+    merged_bounds.push_back(count);
+    run_sort_jobs(&jobs);
+    bounds.swap(merged_bounds);
+    std::swap(from, to);
+  }
+
+  if (from != keys)
+    memcpy(keys, from, count * sizeof(uchar*));
+  std::return_temporary_buffer(buffer.first);
 }
@@ -47,6 +47,26 @@ double get_merge_many_buffs_cost_fast(ha_rows num_rows,
                                       uint    elem_size);
 
 
+/**
+  Sorts an array of pointers to byte-comparable keys with a stable most
+  significant digit first radix sort. The sort works on an array of
+  (key prefix, key pointer) pairs, so that most passes touch only that
+  array and not the keys.
+
+    @param keys        Pointers to the keys to sort.
+    @param count       Number of keys.
+    @param sort_length Length of each key.
+
+  @retval
+    false if the working memory could not be allocated; keys is unchanged.
+
+  @note
+    Declared here in order to be able to unit test it.
+*/
+
+bool msd_radixsort_for_str_ptr(uchar **keys, uint count, size_t sort_length);
+
+
 /**
   A wrapper class around the buffer used by filesort().
   The buffer is a contiguous chunk of memory,
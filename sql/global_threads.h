@@ -23,45 +23,82 @@
 class THD;
 
 extern mysql_mutex_t LOCK_thread_count;
-extern mysql_mutex_t LOCK_thd_remove;
 extern mysql_cond_t COND_thread_count;
 
 /**
-  We maintain a set of all registered threads.
-  We provide accessors (global_thread_list_begin, global_thread_list_end)
-  to iterate over all threads. There is no guarantee on the order of THDs
-  when iterating. The caller of these two accessors is expected to
-  hold lock on LOCK_thread_count mutex before calling these accessors inorder
-  to make sure that there are no new threads are added to the system while
-  processing this thread list.
-
-  We also provide mutators for inserting, and removing an element:
-    > add_global_thread() inserts a THD into the set, and increments the counter.
-       The caller of this function is expected to hold lock on LOCK_thread_count
-       mutex before calling this function to avoid any parallel operations
-       happening on the set.
-    > remove_global_thread() removes a THD from the set, and decrements the counter.
-       This function acquires lock on LOCK_thd_remove followed by lock on
-       LOCK_thread_count. At the end of the function, it releases both the
-       locks. remove_global_thread() also broadcasts COND_thread_count.
-
-  We also provide a function (copy_global_thread_list) to copy global thread list
-  into a new set. The caller of this function is expected to hold lock on
-  LOCK_thd_remove to avoid any removal from the copied set. This function also
-  acquires lock on LOCK_thread_count before the copy operation to
-  avoid any parallel modification to the set and will release the lock at the
-  end of the function.
+  Functor applied to each THD by do_for_all_thd() and do_for_all_thd_copy().
+*/
+class Do_THD_Impl
+{
+public:
+  virtual ~Do_THD_Impl() {}
+  virtual void operator()(THD *thd)= 0;
+};
+
+/**
+  Functor used by find_thd() to tell whether a THD is the one searched for.
+*/
+class Find_THD_Impl
+{
+public:
+  virtual ~Find_THD_Impl() {}
+  virtual bool operator()(THD *thd)= 0;
+};
+
+/**
+  We maintain a set of all registered threads, split in partitions by
+  thread id. Each partition has its own locks, so threads connecting and
+  disconnecting in different partitions do not wait for each other, and
+  a scan of the threads blocks connect and disconnect in one partition at
+  a time only, or never blocks connect when working on a copy. There is
+  no guarantee on the order of THDs when iterating.
+
+  We provide mutators for inserting, and removing an element:
+    > add_global_thread() inserts a THD into the set of its partition, and
+       increments the counter. The thread id of the THD must be assigned
+       before, and must not change until the THD is removed.
+    > remove_global_thread() removes a THD from the set of its partition,
+       and decrements the counter. This function acquires the
+       LOCK_thd_remove and then the LOCK_thd_list lock of the partition,
+       and broadcasts the COND_thd_list condition of the partition.
+  None of them needs LOCK_thread_count.
+
+  The threads are visited with functors:
+    > do_for_all_thd() calls the functor for each THD while holding the
+       LOCK_thd_list lock of its partition. The functor must not add or
+       remove threads, and must not wait for other threads.
+    > do_for_all_thd_copy() copies the sets of all the partitions, and
+       calls the functor for each THD of the copy while holding only the
+       LOCK_thd_remove locks. Threads can be added meanwhile, but are not
+       visited, so the functor may take locks like LOCK_thd_data which are
+       held by threads when they add themselves to the set.
+    > find_thd() returns the first THD for which the functor returns true.
+       The functor is called while holding the LOCK_thd_remove lock of the
+       partition, and must lock LOCK_thd_data of the THD it returns true
+       for if the caller is to access the THD afterwards.
+    > find_thd_with_id() returns the THD with the given thread id with its
+       LOCK_thd_data locked, only the partition of the id is searched.
  */
-typedef std::set<THD*>::iterator Thread_iterator;
-Thread_iterator global_thread_list_begin();
-Thread_iterator global_thread_list_end();
-void copy_global_thread_list(std::set<THD*> *new_copy);
+void do_for_all_thd(Do_THD_Impl *func);
+void do_for_all_thd_copy(Do_THD_Impl *func);
+THD *find_thd(Find_THD_Impl *func);
+THD *find_thd_with_id(ulong thread_id);
 void add_global_thread(THD *);
 void remove_global_thread(THD *);
 
+/**
+  Wait until all the threads are removed from the set.
+*/
+void wait_till_no_thd();
+
+/**
+  Assign the next thread id, atomically.
+*/
+ulong next_thread_id();
+
 /*
   We maintain a separate counter for the number of threads,
-  which can be accessed without LOCK_thread_count.
+  which can be accessed without any lock.
   An un-locked read, means that the result is fuzzy of course.
   This accessor is used by DBUG printing, by signal handlers,
   and by the 'mysqladmin status' command.
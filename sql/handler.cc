@@ -2280,12 +2280,9 @@ static my_bool clone_snapshot_handlerton(THD *thd, plugin_ref plugin,
 
 static int ha_clone_consistent_snapshot(THD *thd)
 {
-  std::set<THD*> global_thread_list_copy;
   THD *from_thd;
   ulong id;
   Item *val;
-  Thread_iterator it;
-  Thread_iterator end;
 
   DBUG_ASSERT(!thd->lex->value_list.is_empty());
 
@@ -2306,25 +2303,12 @@ static int ha_clone_consistent_snapshot(THD *thd)
 
   id= val->val_int();
 
-  mysql_mutex_lock(&LOCK_thd_remove);
-  copy_global_thread_list(&global_thread_list_copy);
-
-  it= global_thread_list_copy.begin();
-  end= global_thread_list_copy.end();
-  from_thd= NULL;
-
-  for (; it != end; ++it)
+  if ((from_thd= find_thd_with_id(id)) && from_thd == thd)
   {
-    if ((*it)->thread_id == id && *it != thd)
-    {
-      from_thd= *it;
-      mysql_mutex_lock(&from_thd->LOCK_thd_data);
-      break;
-    }
+    mysql_mutex_unlock(&from_thd->LOCK_thd_data);
+    from_thd= NULL;
   }
 
-  mysql_mutex_unlock(&LOCK_thd_remove);
-
   if (!from_thd)
   {
     my_error(ER_NO_SUCH_THREAD, MYF(0), id);
@@ -716,6 +716,7 @@ enum enum_schema_tables
   SCH_TABLE_PRIVILEGES,
   SCH_TABLE_STATS,
   SCH_TEMPORARY_TABLES,
+  SCH_THREAD_POOL_QUEUE_TIMES,
   SCH_THREAD_STATS,
   SCH_TRIGGERS,
   SCH_USER_PRIVILEGES,
@@ -2882,6 +2882,8 @@ bool subselect_indexsubquery_engine::scan_table()
   for (;;)
   {
     error=table->file->ha_rnd_next(table->record[0]);
+    if (error == HA_ERR_RECORD_DELETED)
+      continue;
     if (error && error != HA_ERR_END_OF_FILE)
     {
       error= report_handler_error(table, error);
@@ -23,15 +23,13 @@
 #include <mysql/plugin.h>
 #include <mysql/service_thd_wait.h>
 #include <mysql/psi/mysql_stage.h>
-#include <my_murmur3.h>
+#include <my_rdtsc.h>
 
 #ifdef HAVE_PSI_INTERFACE
-static PSI_mutex_key key_MDL_map_mutex;
 static PSI_mutex_key key_MDL_wait_LOCK_wait_status;
 
 static PSI_mutex_info all_mdl_mutexes[]=
 {
-  { &key_MDL_map_mutex, "MDL_map::mutex", 0},
   { &key_MDL_wait_LOCK_wait_status, "MDL_wait::LOCK_wait_status", 0}
 };
 
@@ -112,70 +110,14 @@ void MDL_key::init_psi_keys()
 
 static bool mdl_initialized= 0;
 
-
-class MDL_object_lock;
-class MDL_object_lock_cache_adapter;
-
-
-/**
-  A partition in a collection of all MDL locks.
-  MDL_map is partitioned for scalability reasons.
-  Maps MDL_key to MDL_lock instances.
-*/
-
-class MDL_map_partition
-{
-public:
-  MDL_map_partition();
-  ~MDL_map_partition();
-  inline MDL_lock *find_or_insert(const MDL_key *mdl_key,
-                                  my_hash_value_type hash_value);
-  inline MDL_lock *find(const MDL_key *mdl_key,
-                        my_hash_value_type hash_value);
-  inline void remove(MDL_lock *lock);
-  my_hash_value_type get_key_hash(const MDL_key *mdl_key) const
-  {
-    return my_calc_hash(&m_locks, mdl_key->ptr(), mdl_key->length());
-  }
-  unsigned long get_lock_owner(my_hash_value_type hash_value,
-                               const MDL_key *mdl_key);
-private:
-  bool move_from_hash_to_lock_mutex(MDL_lock *lock);
-  /** A partition of all acquired locks in the server. */
-  HASH m_locks;
-  /* Protects access to m_locks hash. */
-  mysql_mutex_t m_mutex;
-  /**
-    Cache of (unused) MDL_lock objects available for re-use.
-
-    On some systems (e.g. Windows XP) constructing/destructing
-    MDL_lock objects can be fairly expensive. We use this cache
-    to avoid these costs in scenarios in which they can have
-    significant negative effect on performance. For example, when
-    there is only one thread constantly executing statements in
-    auto-commit mode and thus constantly causing creation/
-    destruction of MDL_lock objects for the tables it uses.
-
-    Note that this cache contains only MDL_object_lock objects.
-
-    Protected by m_mutex mutex.
-  */
-  typedef I_P_List<MDL_object_lock, MDL_object_lock_cache_adapter,
-                   I_P_List_counter>
-          Lock_cache;
-  Lock_cache m_unused_locks_cache;
-};
-
-
-/**
-  Start-up parameter for the number of partitions of the MDL_lock hash.
-*/
-ulong mdl_locks_hash_partitions;
-
 /**
   A collection of all MDL locks. A singleton,
   there is only one instance of the map in the server.
-  Contains instances of MDL_map_partition
+
+  MDL_lock objects are kept in a lock-free hash, so looking up
+  the object for a key does not serialize concurrent connections.
+  Objects for the GLOBAL, COMMIT, BACKUP and BINLOG namespaces
+  are pre-allocated and are not in the hash.
 */
 
 class MDL_map
@@ -183,12 +125,35 @@ class MDL_map
 public:
   void init();
   void destroy();
-  MDL_lock *find_or_insert(const MDL_key *key);
-  void remove(MDL_lock *lock);
-  unsigned long get_lock_owner(const MDL_key *key);
+  inline MDL_lock *find(LF_PINS *pins, const MDL_key *key, bool *pinned);
+  inline MDL_lock *find_or_insert(LF_PINS *pins, const MDL_key *key,
+                                  bool *pinned);
+  unsigned long get_lock_owner(LF_PINS *pins, const MDL_key *key);
+  void remove_random_unused(LF_PINS *pins);
+
+  /** Get pins of the calling thread for access to the hash. */
+  LF_PINS *get_pins() { return lf_hash_get_pins(&m_locks); }
+
+  /**
+    Check if the MDL_lock object for the key is pre-allocated,
+    i.e. is not stored in the hash and is never destroyed.
+  */
+  bool is_lock_object_singleton(const MDL_key *mdl_key) const
+  {
+    return (mdl_key->mdl_namespace() == MDL_key::GLOBAL ||
+            mdl_key->mdl_namespace() == MDL_key::COMMIT ||
+            mdl_key->mdl_namespace() == MDL_key::BACKUP ||
+            mdl_key->mdl_namespace() == MDL_key::BINLOG);
+  }
+
+  /** Update the number of unused MDL_lock objects in the hash. */
+  inline void add_unused_lock_objects(int32 count);
+
+  /** Check if there are more unused objects than we want to keep. */
+  inline bool has_too_many_unused_lock_objects();
 private:
-  /** Array of partitions where the locks are actually stored. */
-  Dynamic_array<MDL_map_partition *> m_partitions;
+  /** LF_HASH with all locks in the server. */
+  LF_HASH m_locks;
   /** Pre-allocated MDL_lock object for GLOBAL namespace. */
   MDL_lock *m_global_lock;
   /** Pre-allocated MDL_lock object for COMMIT namespace. */
@@ -197,9 +162,29 @@ private:
   MDL_lock *m_backup_lock;
   /** Pre-allocated MDL_lock object for BINLOG namespace */
   MDL_lock *m_binlog_lock;
+  /**
+    Number of MDL_lock objects in the hash which are not used, i.e.
+    have neither granted nor pending locks. Such objects are kept for
+    re-use up to mdl_locks_cache_size.
+  */
+  volatile int32 m_unused_lock_objects;
 };
 
 
+/**
+  Start-up parameter for the number of partitions of the MDL_lock hash.
+  Deprecated, has no effect.
+*/
+ulong mdl_locks_hash_partitions;
+
+
+/**
+  Protects the atomic counters of the MDL subsystem on platforms
+  without native atomic operations.
+*/
+static my_atomic_rwlock_t mdl_atomic_lock;
+
+
 /**
   A context of the recursive traversal through all contexts
   in all sessions in search for deadlock.
@@ -351,15 +336,30 @@ Deadlock_detection_visitor::opt_change_victim_to(MDL_context *new_victim)
   and it exists only when the lock has been granted.
   Can be seen as an MDL subsystem's version of TABLE_SHARE.
 
-  This is an abstract class which lacks information about
-  compatibility rules for lock types. They should be specified
-  in its descendants.
+  Compatibility rules for lock types are provided by the strategy
+  of the lock, which depends on the namespace of its key.
+
+  Lock types are either "unobtrusive" or "obtrusive". Unobtrusive
+  types (S, SH, SR and SW for per-object locks, IX for scoped locks)
+  are compatible with each other and are used by DML, so acquiring
+  them is the common case. Unless there are granted or pending
+  obtrusive locks, an unobtrusive lock is granted on the "fast path"
+  by incrementing its counter in m_fast_path_state, without taking
+  m_rwlock and without adding a ticket to m_granted. All other locks
+  take the "slow path": their tickets are added to m_granted or
+  m_waiting under protection of m_rwlock. Before an obtrusive lock is
+  requested the requesting context moves all its fast path locks to
+  the slow path (materializes them), so all locks on the fast path
+  which conflict with an obtrusive request belong to other contexts.
+  Contexts also materialize their fast path locks before they start
+  waiting, so that they are visible to the deadlock detector.
 */
 
 class MDL_lock
 {
 public:
   typedef unsigned short bitmap_t;
+  typedef int64 fast_path_state_t;
 
   class Ticket_list
   {
@@ -389,6 +389,56 @@ public:
 
   typedef Ticket_list::List::Iterator Ticket_iterator;
 
+  /**
+    Number of fast path counters packed in m_fast_path_state,
+    and the number of bits of each counter.
+  */
+  static const uint FAST_PATH_COUNTERS= 3;
+  static const uint FAST_PATH_COUNTER_BITS= 20;
+
+  /** Flag of m_fast_path_state: there are granted or pending obtrusive locks. */
+  static const fast_path_state_t HAS_OBTRUSIVE= 1LL << 60;
+  /** Flag of m_fast_path_state: m_granted or m_waiting are not empty. */
+  static const fast_path_state_t HAS_SLOW_PATH= 1LL << 61;
+  /** Flag of m_fast_path_state: the object is being removed from the hash. */
+  static const fast_path_state_t IS_DESTROYED= 1LL << 62;
+
+  /**
+    Rules for the lock types of an MDL_lock, which depend on the namespace.
+    There are two strategies: one for scoped locks (GLOBAL, SCHEMA, COMMIT,
+    BACKUP and BINLOG namespaces) and one for per-object locks.
+  */
+  struct MDL_lock_strategy
+  {
+    /**
+      Compatibility (or rather "incompatibility") matrices. Arrays of
+      bitmaps which elements specify which granted/waiting locks are
+      incompatible with type of lock being requested.
+    */
+    bitmap_t m_granted_incompatible[MDL_TYPE_END];
+    bitmap_t m_waiting_incompatible[MDL_TYPE_END];
+    /**
+      Increment of m_fast_path_state for each unobtrusive lock type,
+      0 for obtrusive lock types.
+    */
+    fast_path_state_t m_unobtrusive_lock_increment[MDL_TYPE_END];
+    /**
+      Lock types represented by each counter in m_fast_path_state.
+      Types sharing a counter are compatible with the same requests.
+    */
+    bitmap_t m_fast_path_counter_types[FAST_PATH_COUNTERS];
+    /** Types of requests which notify the owners of conflicting locks. */
+    bitmap_t m_notifying_types;
+    /** Types of granted locks which owners are notified. */
+    bitmap_t m_notified_types;
+    /**
+      To prevent starvation, these lock types are only granted
+      max_write_lock_count times in a row while other lock types
+      are waiting.
+    */
+    bitmap_t m_hog_lock_types;
+  };
+
 public:
   /** The key of the object (data) being protected. */
   MDL_key key;
@@ -432,225 +482,164 @@ public:
     return (m_granted.is_empty() && m_waiting.is_empty());
   }
 
-  virtual const bitmap_t *incompatible_granted_types_bitmap() const = 0;
-  virtual const bitmap_t *incompatible_waiting_types_bitmap() const = 0;
+  const bitmap_t *incompatible_granted_types_bitmap() const
+  {
+    return m_strategy->m_granted_incompatible;
+  }
+  const bitmap_t *incompatible_waiting_types_bitmap() const
+  {
+    return m_strategy->m_waiting_incompatible;
+  }
 
   bool has_pending_conflicting_lock(enum_mdl_type type);
 
   bool can_grant_lock(enum_mdl_type type, MDL_context *requstor_ctx,
                       bool ignore_lock_priority) const;
 
-  inline static MDL_lock *create(const MDL_key *key,
-                                 MDL_map_partition *map_part);
   inline unsigned long get_lock_owner() const;
 
   void reschedule_waiters();
 
   void remove_ticket(Ticket_list MDL_lock::*queue, MDL_ticket *ticket);
 
+  void release_fast_path_lock(enum_mdl_type type);
+
   bool visit_subgraph(MDL_ticket *waiting_ticket,
                       MDL_wait_for_graph_visitor *gvisitor);
 
-  virtual bool needs_notification(const MDL_ticket *ticket) const = 0;
-  virtual void notify_conflicting_locks(MDL_context *ctx) = 0;
-
-  virtual bitmap_t hog_lock_types_bitmap() const = 0;
-
-  /** List of granted tickets for this lock. */
-  Ticket_list m_granted;
-  /** Tickets for contexts waiting to acquire a lock. */
-  Ticket_list m_waiting;
-
-  /**
-    Number of times high priority lock requests have been granted while
-    low priority lock requests were waiting.
-  */
-  ulong m_hog_lock_count;
-
-public:
-
-  MDL_lock(const MDL_key *key_arg, MDL_map_partition *map_part)
-  : key(key_arg),
-    m_hog_lock_count(0),
-    m_ref_usage(0),
-    m_ref_release(0),
-    m_is_destroyed(FALSE),
-    m_version(0),
-    m_map_part(map_part)
+  bool needs_notification(const MDL_ticket *ticket) const
   {
-    mysql_prlock_init(key_MDL_lock_rwlock, &m_rwlock);
+    return (MDL_BIT(ticket->get_type()) & m_strategy->m_notifying_types);
   }
+  void notify_conflicting_locks(MDL_context *ctx);
 
-  virtual ~MDL_lock()
+  bitmap_t hog_lock_types_bitmap() const
   {
-    mysql_prlock_destroy(&m_rwlock);
+    return m_strategy->m_hog_lock_types;
   }
-  inline static void destroy(MDL_lock *lock);
-public:
-  /**
-    These three members are used to make it possible to separate
-    the MDL_map_partition::m_mutex mutex and MDL_lock::m_rwlock in
-    MDL_map::find_or_insert() for increased scalability.
-    The 'm_is_destroyed' member is only set by destroyers that
-    have both the MDL_map_partition::m_mutex and MDL_lock::m_rwlock, thus
-    holding any of the mutexes is sufficient to read it.
-    The 'm_ref_usage; is incremented under protection by
-    MDL_map_partition::m_mutex, but when 'm_is_destroyed' is set to TRUE, this
-    member is moved to be protected by the MDL_lock::m_rwlock.
-    This means that the MDL_map::find_or_insert() which only
-    holds the MDL_lock::m_rwlock can compare it to 'm_ref_release'
-    without acquiring MDL_map_partition::m_mutex again and if equal
-    it can also destroy the lock object safely.
-    The 'm_ref_release' is incremented under protection by
-    MDL_lock::m_rwlock.
-    Note since we are only interested in equality of these two
-    counters we don't have to worry about overflows as long as
-    their size is big enough to hold maximum number of concurrent
-    threads on the system.
-  */
-  uint m_ref_usage;
-  uint m_ref_release;
-  bool m_is_destroyed;
-  /**
-    We use the same idea and an additional version counter to support
-    caching of unused MDL_lock object for further re-use.
-    This counter is incremented while holding both MDL_map_partition::m_mutex
-    and MDL_lock::m_rwlock locks each time when a MDL_lock is moved from
-    the partitioned hash to the paritioned unused objects list (or destroyed).
-    A thread, which has found a MDL_lock object for the key in the hash
-    and then released the MDL_map_partition::m_mutex before acquiring the
-    MDL_lock::m_rwlock, can determine that this object was moved to the
-    unused objects list (or destroyed) while it held no locks by comparing
-    the version value which it read while holding the MDL_map_partition::m_mutex
-    with the value read after acquiring the MDL_lock::m_rwlock.
-    Note that since it takes several years to overflow this counter such
-    theoretically possible overflows should not have any practical effects.
-  */
-  ulonglong m_version;
-  /**
-    Partition of MDL_map where the lock is stored.
-  */
-  MDL_map_partition *m_map_part;
-};
-
-
-/**
-  An implementation of the scoped metadata lock. The only locking modes
-  which are supported at the moment are SHARED and INTENTION EXCLUSIVE
-  and EXCLUSIVE
-*/
-
-class MDL_scoped_lock : public MDL_lock
-{
-public:
-  MDL_scoped_lock(const MDL_key *key_arg, MDL_map_partition *map_part)
-    : MDL_lock(key_arg, map_part)
-  { }
 
-  virtual const bitmap_t *incompatible_granted_types_bitmap() const
+  static const MDL_lock_strategy *get_strategy(const MDL_key *mdl_key)
   {
-    return m_granted_incompatible;
+    switch (mdl_key->mdl_namespace())
+    {
+      case MDL_key::GLOBAL:
+      case MDL_key::SCHEMA:
+      case MDL_key::COMMIT:
+      case MDL_key::BACKUP:
+      case MDL_key::BINLOG:
+        return &m_scoped_lock_strategy;
+      default:
+        return &m_object_lock_strategy;
+    }
   }
-  virtual const bitmap_t *incompatible_waiting_types_bitmap() const
+
+  fast_path_state_t get_unobtrusive_lock_increment(enum_mdl_type type) const
   {
-    return m_waiting_incompatible;
+    return m_strategy->m_unobtrusive_lock_increment[type];
   }
-  virtual bool needs_notification(const MDL_ticket *ticket) const
+
+  bool is_obtrusive_lock(enum_mdl_type type) const
   {
-    return (ticket->get_type() == MDL_SHARED);
+    return get_unobtrusive_lock_increment(type) == 0;
   }
-  virtual void notify_conflicting_locks(MDL_context *ctx);
 
-  /*
-    In scoped locks, only IX lock request would starve because of X/S. But that
-    is practically very rare case. So just return 0 from this function.
-  */
-  virtual bitmap_t hog_lock_types_bitmap() const
+  bitmap_t fast_path_granted_bitmap() const;
+
+  fast_path_state_t get_fast_path_state() const
   {
-    return 0;
+    fast_path_state_t state;
+    my_atomic_rwlock_rdlock(&mdl_atomic_lock);
+    state= my_atomic_load64(const_cast<volatile fast_path_state_t *>
+                            (&m_fast_path_state));
+    my_atomic_rwlock_rdunlock(&mdl_atomic_lock);
+    return state;
   }
 
-private:
-  static const bitmap_t m_granted_incompatible[MDL_TYPE_END];
-  static const bitmap_t m_waiting_incompatible[MDL_TYPE_END];
-};
+  bool fast_path_state_cas(fast_path_state_t *old_state,
+                           fast_path_state_t new_state);
+  void fast_path_state_add(fast_path_state_t value);
+  void fast_path_state_update(fast_path_state_t set_flags,
+                              fast_path_state_t reset_flags);
 
+  void obtrusive_lock_added();
+  void obtrusive_lock_removed();
+  void slow_path_lists_changed();
 
-/**
-  An implementation of a per-object lock. Supports SHARED, SHARED_UPGRADABLE,
-  SHARED HIGH PRIORITY and EXCLUSIVE locks.
-*/
+  /** List of granted tickets for this lock. */
+  Ticket_list m_granted;
+  /** Tickets for contexts waiting to acquire a lock. */
+  Ticket_list m_waiting;
 
-class MDL_object_lock : public MDL_lock
-{
-public:
-  MDL_object_lock(const MDL_key *key_arg, MDL_map_partition *map_part)
-    : MDL_lock(key_arg, map_part)
-  { }
+  /**
+    Number of times high priority lock requests have been granted while
+    low priority lock requests were waiting.
+  */
+  ulong m_hog_lock_count;
+
+  /** Rules for the lock types of this lock. */
+  const MDL_lock_strategy *m_strategy;
 
   /**
-    Reset unused MDL_object_lock object to represent the lock context for a
-    different object.
+    Counters of the locks granted on the fast path, FAST_PATH_COUNTER_BITS
+    bits for each one of the counters of the strategy, and the HAS_OBTRUSIVE,
+    HAS_SLOW_PATH and IS_DESTROYED flags. Changed atomically. A value of 0
+    means that the object is unused and can be removed from the hash.
   */
-  void reset(const MDL_key *new_key)
-  {
-    /* We need to change only object's key. */
-    key.mdl_key_init(new_key);
-    /* m_granted and m_waiting should be already in the empty/initial state. */
-    DBUG_ASSERT(is_empty());
-    /* Object should not be marked as destroyed. */
-    DBUG_ASSERT(! m_is_destroyed);
-    /*
-      Values of the rest of the fields should be preserved between old and
-      new versions of the object. E.g., m_version and m_ref_usage/release
-      should be kept intact to properly handle possible remaining references
-      to the old version of the object.
-    */
-  }
+  volatile fast_path_state_t m_fast_path_state;
 
-  virtual const bitmap_t *incompatible_granted_types_bitmap() const
+  /**
+    Number of obtrusive locks granted or pending for this lock, including
+    the one being acquired. HAS_OBTRUSIVE is set while it is not 0.
+    Protected by m_rwlock.
+  */
+  uint m_obtrusive_locks_granted_waiting_count;
+
+public:
+
+  /** Construct an object for the lock-free hash, see reinit(). */
+  MDL_lock()
+  : m_hog_lock_count(0),
+    m_strategy(NULL),
+    m_fast_path_state(0),
+    m_obtrusive_locks_granted_waiting_count(0)
   {
-    return m_granted_incompatible;
+    mysql_prlock_init(key_MDL_lock_rwlock, &m_rwlock);
   }
-  virtual const bitmap_t *incompatible_waiting_types_bitmap() const
+
+  /** Construct a pre-allocated object. */
+  MDL_lock(const MDL_key *key_arg)
+  : key(key_arg),
+    m_hog_lock_count(0),
+    m_strategy(get_strategy(key_arg)),
+    m_fast_path_state(0),
+    m_obtrusive_locks_granted_waiting_count(0)
   {
-    return m_waiting_incompatible;
+    mysql_prlock_init(key_MDL_lock_rwlock, &m_rwlock);
   }
-  virtual bool needs_notification(const MDL_ticket *ticket) const
+
+  ~MDL_lock()
   {
-    return (ticket->get_type() >= MDL_SHARED_NO_WRITE);
+    mysql_prlock_destroy(&m_rwlock);
   }
-  virtual void notify_conflicting_locks(MDL_context *ctx);
 
-  /*
-    To prevent starvation, these lock types that are only granted
-    max_write_lock_count times in a row while other lock types are
-    waiting.
+  /**
+    Set up an object, new or removed from the hash earlier, to represent
+    the lock context for the key when it is inserted into the hash.
   */
-  virtual bitmap_t hog_lock_types_bitmap() const
-  {
-    return (MDL_BIT(MDL_SHARED_NO_WRITE) |
-            MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
-            MDL_BIT(MDL_EXCLUSIVE));
+  static void reinit(MDL_lock *lock, const MDL_key *mdl_key)
+  {
+    lock->key.mdl_key_init(mdl_key);
+    lock->m_strategy= get_strategy(mdl_key);
+    lock->m_hog_lock_count= 0;
+    lock->m_fast_path_state= 0;
+    /* Objects are removed from the hash only when they are unused. */
+    DBUG_ASSERT(lock->is_empty());
+    DBUG_ASSERT(lock->m_obtrusive_locks_granted_waiting_count == 0);
   }
 
 private:
-  static const bitmap_t m_granted_incompatible[MDL_TYPE_END];
-  static const bitmap_t m_waiting_incompatible[MDL_TYPE_END];
-
-public:
-  /** Members for linking the object into the list of unused objects. */
-  MDL_object_lock *next_in_cache, **prev_in_cache;
-};
-
-
-/**
-  Helper class for linking MDL_object_lock objects into the unused objects list.
-*/
-class MDL_object_lock_cache_adapter :
-      public I_P_List_adapter<MDL_object_lock, &MDL_object_lock::next_in_cache,
-                              &MDL_object_lock::prev_in_cache>
-{
+  static const MDL_lock_strategy m_scoped_lock_strategy;
+  static const MDL_lock_strategy m_object_lock_strategy;
 };
 
 
@@ -671,6 +660,37 @@ mdl_locks_key(const uchar *record, size_t *length,
   *length= lock->key.length();
   return (uchar*) lock->key.ptr();
 }
+
+
+/** Construct an MDL_lock in memory allocated for the lock-free hash. */
+
+static void mdl_lock_cons(uchar *arg)
+{
+  new (arg + LF_HASH_OVERHEAD) MDL_lock();
+}
+
+
+static void mdl_lock_dtor(uchar *arg)
+{
+  MDL_lock *lock= (MDL_lock *) (arg + LF_HASH_OVERHEAD);
+  lock->~MDL_lock();
+}
+
+
+/** Set up an MDL_lock inserted into the hash for the MDL_key. */
+
+static void mdl_lock_reinit(uchar *dst, const uchar *src)
+{
+  MDL_lock::reinit((MDL_lock *) dst, (const MDL_key *) src);
+}
+
+
+/** Match function for lf_hash_random_match() to find unused objects. */
+
+static int mdl_lock_match_unused(const uchar *arg)
+{
+  return ((const MDL_lock *) arg)->get_fast_path_state() == 0;
+}
 } /* extern "C" */
 
 
@@ -694,6 +714,7 @@ void mdl_init()
   init_mdl_psi_keys();
 #endif
 
+  my_atomic_rwlock_init(&mdl_atomic_lock);
   mdl_locks.init();
 }
 
@@ -711,6 +732,7 @@ void mdl_destroy()
   {
     mdl_initialized= FALSE;
     mdl_locks.destroy();
+    my_atomic_rwlock_destroy(&mdl_atomic_lock);
   }
 }
 
@@ -724,47 +746,24 @@ void MDL_map::init()
   MDL_key backup_lock_key(MDL_key::BACKUP, "", "");
   MDL_key binlog_lock_key(MDL_key::BINLOG, "", "");
 
-  m_global_lock= MDL_lock::create(&global_lock_key, NULL);
-  m_commit_lock= MDL_lock::create(&commit_lock_key, NULL);
-  m_backup_lock= MDL_lock::create(&backup_lock_key, NULL);
-  m_binlog_lock= MDL_lock::create(&binlog_lock_key, NULL);
-
-  for (uint i= 0; i < mdl_locks_hash_partitions; i++)
-  {
-    MDL_map_partition *part= new (std::nothrow) MDL_map_partition();
-    m_partitions.append(part);
-  }
-}
-
-
-/**
-  Adapter function which allows to use murmur3 with our HASH implementation.
-*/
-
-extern "C" my_hash_value_type murmur3_adapter(const HASH*, const uchar *key,
-                                              size_t length)
-{
-  return murmur3_32(key, length, 0);
-}
-
+  m_global_lock= new (std::nothrow) MDL_lock(&global_lock_key);
+  m_commit_lock= new (std::nothrow) MDL_lock(&commit_lock_key);
+  m_backup_lock= new (std::nothrow) MDL_lock(&backup_lock_key);
+  m_binlog_lock= new (std::nothrow) MDL_lock(&binlog_lock_key);
 
-/** Initialize the partition in the container with all MDL locks. */
+  m_unused_lock_objects= 0;
 
-MDL_map_partition::MDL_map_partition()
-{
-  mysql_mutex_init(key_MDL_map_mutex, &m_mutex, NULL);
+  lf_hash_init(&m_locks, sizeof(MDL_lock), LF_HASH_UNIQUE, 0, 0,
+               mdl_locks_key, &my_charset_bin);
   /*
-    Lower bits of values produced by hash function which is used in 'm_locks'
-    HASH container are also to select specific MDL_map_partition instance.
-    This means that this hash function needs to hash key value in such
-    a way that lower bits in result are sufficiently random. Since standard
-    hash function from 'my_charset_bin' doesn't satisfy this criteria we use
-    MurmurHash3 instead.
+    MDL_lock objects are constructed once by the allocator, as they contain
+    a read-write lock, and are only set up for a new key on insert, from the
+    MDL_key passed to lf_hash_insert().
   */
-  my_hash_init3(&m_locks, 0, &my_charset_bin, murmur3_adapter,
-                16 /* FIXME */, 0, 0, mdl_locks_key,
-                0, 0);
-};
+  m_locks.alloc.constructor= mdl_lock_cons;
+  m_locks.alloc.destructor= mdl_lock_dtor;
+  m_locks.initializer= mdl_lock_reinit;
+}
 
 
 /**
@@ -774,408 +773,240 @@ MDL_map_partition::MDL_map_partition()
 
 void MDL_map::destroy()
 {
-  MDL_lock::destroy(m_backup_lock);
-  MDL_lock::destroy(m_binlog_lock);
-  MDL_lock::destroy(m_global_lock);
-  MDL_lock::destroy(m_commit_lock);
+  delete m_backup_lock;
+  delete m_binlog_lock;
+  delete m_global_lock;
+  delete m_commit_lock;
 
-  while (m_partitions.elements() > 0)
-  {
-    MDL_map_partition *part= m_partitions.pop();
-    delete part;
-  }
+  lf_hash_destroy(&m_locks);
 }
 
 
 /**
-  Destroy the partition in container for all MDL locks.
-  @pre It must be empty.
-*/
-
-MDL_map_partition::~MDL_map_partition()
-{
-  DBUG_ASSERT(!m_locks.records);
-  mysql_mutex_destroy(&m_mutex);
-  my_hash_free(&m_locks);
-
-  MDL_object_lock *lock;
-  while ((lock= m_unused_locks_cache.pop_front()))
-    MDL_lock::destroy(lock);
-}
+  Find MDL_lock object corresponding to the key.
 
+  @param[in,out]  pins     LF_PINS to be used for pinning pointers during
+                           look-up and returned MDL_lock object.
+  @param[in]      mdl_key  Key for which MDL_lock object needs to be found.
+  @param[out]     pinned   TRUE  - if MDL_lock object is pinned,
+                           FALSE - if MDL_lock object doesn't require pinning
+                                   (i.e. it is an object for GLOBAL, COMMIT,
+                                   BACKUP or BINLOG namespaces).
 
-/**
-  Find MDL_lock object corresponding to the key, create it
-  if it does not exist.
-
-  @retval non-NULL - Success. MDL_lock instance for the key with
-                     locked MDL_lock::m_rwlock.
-  @retval NULL     - Failure (OOM).
+  @retval MY_ERRPTR      - Failure (OOM)
+  @retval other-non-NULL - MDL_lock object found.
+  @retval NULL           - Object not found.
 */
 
-MDL_lock* MDL_map::find_or_insert(const MDL_key *mdl_key)
+MDL_lock* MDL_map::find(LF_PINS *pins, const MDL_key *mdl_key, bool *pinned)
 {
   MDL_lock *lock;
 
   /*
-    Avoid locking any m_mutex when a lock in GLOBAL, COMMIT, BACKUP or BINLOG
-    namespace is requested. Return pointer to pre-allocated MDL_lock instance
-    instead.  Such an optimization allows to save one mutex lock/unlock for any
-    statement changing data.
+    Avoid the look-up when a lock in GLOBAL, COMMIT, BACKUP or BINLOG
+    namespace is requested. Return pointer to pre-allocated MDL_lock
+    instance instead. Such an optimization allows to save one hash
+    look-up for any statement changing data.
 
     It works since these namespaces contain only one element so keys
     for them look like '<namespace-id>\0\0'.
   */
-  switch (mdl_key->mdl_namespace())
-  {
-  case MDL_key::GLOBAL:
-    lock= m_global_lock;
-    break;
-  case MDL_key::COMMIT:
-    lock= m_commit_lock;
-    break;
-  case MDL_key::BACKUP:
-    lock= m_backup_lock;
-    break;
-  case MDL_key::BINLOG:
-    lock= m_binlog_lock;
-    break;
-  default:
-    goto dofind;
-  }
-
-  DBUG_ASSERT(mdl_key->length() == 3);
+  if (is_lock_object_singleton(mdl_key))
+  {
+    DBUG_ASSERT(mdl_key->length() == 3);
 
-  mysql_prlock_wrlock(&lock->m_rwlock);
+    switch (mdl_key->mdl_namespace())
+    {
+    case MDL_key::GLOBAL:
+      lock= m_global_lock;
+      break;
+    case MDL_key::COMMIT:
+      lock= m_commit_lock;
+      break;
+    case MDL_key::BACKUP:
+      lock= m_backup_lock;
+      break;
+    default:
+      lock= m_binlog_lock;
+      break;
+    }
+    *pinned= false;
+    return lock;
+  }
 
-  return lock;
+  lock= (MDL_lock*) lf_hash_search(&m_locks, pins, mdl_key->ptr(),
+                                   mdl_key->length());
 
-dofind:
+  if (lock == NULL || lock == MY_ERRPTR)
+  {
+    lf_hash_search_unpin(pins);
+    *pinned= false;
+    return lock;
+  }
 
-  my_hash_value_type hash_value= m_partitions.at(0)->get_key_hash(mdl_key);
-  uint part_id= hash_value % mdl_locks_hash_partitions;
-  MDL_map_partition *part= m_partitions.at(part_id);
+  *pinned= true;
 
-  return part->find_or_insert(mdl_key, hash_value);
+  return lock;
 }
 
 
 /**
-  Find MDL_lock object corresponding to the key and hash value in
-  MDL_map partition, create it if it does not exist.
+  Find MDL_lock object corresponding to the key, create it
+  if it does not exist.
+
+  @param[in,out]  pins     LF_PINS to be used for pinning pointers during
+                           look-up and returned MDL_lock object.
+  @param[in]      mdl_key  Key for which MDL_lock object needs to be found.
+  @param[out]     pinned   TRUE  - if MDL_lock object is pinned,
+                           FALSE - if MDL_lock object doesn't require pinning
+                                   (i.e. it is an object for GLOBAL, COMMIT,
+                                   BACKUP or BINLOG namespaces).
 
-  @retval non-NULL - Success. MDL_lock instance for the key with
-                     locked MDL_lock::m_rwlock.
+  @note The object returned may have been marked as destroyed by a
+        concurrent thread (see MDL_map::remove_random_unused()),
+        in which case the caller should unpin it and retry.
+
+  @retval non-NULL - Success. MDL_lock instance for the key.
   @retval NULL     - Failure (OOM).
 */
 
-MDL_lock* MDL_map_partition::find_or_insert(const MDL_key *mdl_key,
-                                            my_hash_value_type hash_value)
+MDL_lock* MDL_map::find_or_insert(LF_PINS *pins, const MDL_key *mdl_key,
+                                  bool *pinned)
 {
   MDL_lock *lock;
 
-retry:
-  mysql_mutex_lock(&m_mutex);
-  if (!(lock= (MDL_lock*) my_hash_search_using_hash_value(&m_locks,
-                                                          hash_value,
-                                                          mdl_key->ptr(),
-                                                          mdl_key->length())))
+  while ((lock= find(pins, mdl_key, pinned)) == NULL)
   {
-    MDL_object_lock *unused_lock= NULL;
-
     /*
-      No lock object found so we need to create a new one
-      or reuse an existing unused object.
+      MDL_lock for key isn't present in hash, try to insert new object.
+      This can fail due to concurrent inserts.
     */
-    if (mdl_key->mdl_namespace() != MDL_key::SCHEMA &&
-        m_unused_locks_cache.elements())
+    int rc= lf_hash_insert(&m_locks, pins, mdl_key);
+    if (rc == -1) /* If OOM. */
+      return NULL;
+    else if (rc == 0)
     {
       /*
-        We need a MDL_object_lock type of object and the unused objects
-        cache has some. Get the first object from the cache and set a new
-        key for it.
+        The new object is counted as unused until someone acquires a
+        lock on it, like any other object with no locks.
       */
-      DBUG_ASSERT(mdl_key->mdl_namespace() != MDL_key::GLOBAL &&
-                  mdl_key->mdl_namespace() != MDL_key::COMMIT &&
-                  mdl_key->mdl_namespace() != MDL_key::BACKUP &&
-                  mdl_key->mdl_namespace() != MDL_key::BINLOG);
-
-      unused_lock= m_unused_locks_cache.pop_front();
-      unused_lock->reset(mdl_key);
-
-      lock= unused_lock;
-    }
-    else
-    {
-      lock= MDL_lock::create(mdl_key, this);
-    }
-
-    if (!lock || my_hash_insert(&m_locks, (uchar*)lock))
-    {
-      if (unused_lock)
-      {
-        /*
-          Note that we can't easily destroy an object from cache here as it
-          still might be referenced by other threads. So we simply put it
-          back into the cache.
-        */
-        m_unused_locks_cache.push_front(unused_lock);
-      }
-      else
-      {
-        MDL_lock::destroy(lock);
-      }
-      mysql_mutex_unlock(&m_mutex);
-      return NULL;
+      add_unused_lock_objects(1);
     }
+    /*
+      The inserted object is not pinned, look it up again. This also
+      handles the case when another thread has inserted it first.
+    */
   }
-
-  if (move_from_hash_to_lock_mutex(lock))
-    goto retry;
+  if (lock == MY_ERRPTR)
+    return NULL;
 
   return lock;
 }
 
 
 /**
-  Find MDL_lock object corresponding to the key and hash value in
-  MDL_map partition.
-
-  @retval non-NULL - Success. MDL_lock instance for the key with
-                     *read*-locked MDL_lock::m_rwlock.
-  @retval NULL     - Failure (OOM).
+  Return thread id of the owner of the lock, if it is owned.
 */
 
 unsigned long
-MDL_map_partition::get_lock_owner(my_hash_value_type hash_value,
-                                  const MDL_key *mdl_key)
+MDL_map::get_lock_owner(LF_PINS *pins, const MDL_key *mdl_key)
 {
-  unsigned long res = 0;
   MDL_lock *lock;
+  unsigned long res= 0;
+  bool pinned;
 
-retry:
-  mysql_mutex_lock(&m_mutex);
+  lock= find(pins, mdl_key, &pinned);
 
-  DEBUG_SYNC(current_thd, "mdl_map_partition_get_lock_owner_m_mutex_locked");
+  if (lock == NULL || lock == MY_ERRPTR)
+    return 0;
 
-  lock= (MDL_lock*) my_hash_search_using_hash_value(&m_locks,
-                                                    hash_value,
-                                                    mdl_key->ptr(),
-                                                    mdl_key->length());
-  if (lock)
-  {
-    if (move_from_hash_to_lock_mutex(lock))
-      goto retry;
+  DEBUG_SYNC(current_thd, "mdl_map_get_lock_owner_lock_found");
 
-    res= lock->get_lock_owner();
-    mysql_prlock_unlock(&lock->m_rwlock);
-  }
-  else
-  {
-    mysql_mutex_unlock(&m_mutex);
-  }
+  /*
+    A pinned object can't be re-used for another key, so even if it
+    was removed from the hash meanwhile it has no granted locks then.
+  */
+  mysql_prlock_rdlock(&lock->m_rwlock);
+  res= lock->get_lock_owner();
+  mysql_prlock_unlock(&lock->m_rwlock);
+
+  if (pinned)
+    lf_hash_search_unpin(pins);
 
   return res;
 }
 
-/**
-  Release MDL_map_partition::m_mutex mutex and lock MDL_lock::m_rwlock for lock
-  object from the hash. Handle situation when object was released
-  while we held no locks.
 
-  @retval FALSE - Success.
-  @retval TRUE  - Object was released while we held no mutex, caller
-                  should re-try looking up MDL_lock object in the hash.
+/**
+  Update the number of unused MDL_lock objects in the hash.
 */
 
-bool MDL_map_partition::move_from_hash_to_lock_mutex(MDL_lock *lock)
+void MDL_map::add_unused_lock_objects(int32 count)
 {
-  ulonglong version;
-
-  DBUG_ASSERT(! lock->m_is_destroyed);
-  mysql_mutex_assert_owner(&m_mutex);
-
-  /*
-    We increment m_ref_usage which is a reference counter protected by
-    MDL_map_partition::m_mutex under the condition it is present in the hash
-    and m_is_destroyed is FALSE.
-  */
-  lock->m_ref_usage++;
-  /* Read value of the version counter under protection of m_mutex lock. */
-  version= lock->m_version;
-  mysql_mutex_unlock(&m_mutex);
-
-  mysql_prlock_wrlock(&lock->m_rwlock);
-  lock->m_ref_release++;
-
-  if (unlikely(lock->m_version != version))
-  {
-    /*
-      If the current value of version differs from one that was read while
-      we held m_mutex mutex, this MDL_lock object was moved to the unused
-      objects list or destroyed while we held no locks.
-      We should retry our search. But first we should destroy the MDL_lock
-      object if necessary.
-    */
-    if (unlikely(lock->m_is_destroyed))
-    {
-      /*
-        Object was released while we held no locks, we need to
-        release it if no others hold references to it, while our own
-        reference count ensured that the object as such haven't got
-        its memory released yet. We can also safely compare
-        m_ref_usage and m_ref_release since the object is no longer
-        present in the hash (or unused objects list) so no one will
-        be able to find it and increment m_ref_usage anymore.
-      */
-      uint ref_usage= lock->m_ref_usage;
-      uint ref_release= lock->m_ref_release;
-      mysql_prlock_unlock(&lock->m_rwlock);
-      if (ref_usage == ref_release)
-        MDL_lock::destroy(lock);
-    }
-    else
-    {
-      /*
-        Object was not destroyed but its version has changed.
-        This means that it was moved to the unused objects list
-        (and even might be already re-used). So now it might
-        correspond to a different key, therefore we should simply
-        retry our search.
-      */
-      mysql_prlock_unlock(&lock->m_rwlock);
-    }
-    return TRUE;
-  }
-  return FALSE;
+  my_atomic_rwlock_wrlock(&mdl_atomic_lock);
+  my_atomic_add32(&m_unused_lock_objects, count);
+  my_atomic_rwlock_wrunlock(&mdl_atomic_lock);
 }
 
 
 /**
- * Return thread id of the owner of the lock, if it is owned.
- */
+  Check if the number of unused MDL_lock objects in the hash
+  exceeds metadata_locks_cache_size.
+*/
 
-unsigned long
-MDL_map::get_lock_owner(const MDL_key *mdl_key)
+bool MDL_map::has_too_many_unused_lock_objects()
 {
-  MDL_lock *lock;
-  unsigned long res= 0;
-
-  if (mdl_key->mdl_namespace() == MDL_key::GLOBAL ||
-      mdl_key->mdl_namespace() == MDL_key::COMMIT)
-  {
-    lock= (mdl_key->mdl_namespace() == MDL_key::GLOBAL) ? m_global_lock :
-                                                          m_commit_lock;
-    mysql_prlock_rdlock(&lock->m_rwlock);
-    res= lock->get_lock_owner();
-    mysql_prlock_unlock(&lock->m_rwlock);
-  }
-  else
-  {
-    my_hash_value_type hash_value= m_partitions.at(0)->get_key_hash(mdl_key);
-    uint part_id= hash_value % mdl_locks_hash_partitions;
-    MDL_map_partition *part= m_partitions.at(part_id);
-    res= part->get_lock_owner(hash_value, mdl_key);
-  }
-  return res;
+  int32 unused;
+  my_atomic_rwlock_rdlock(&mdl_atomic_lock);
+  unused= my_atomic_load32(&m_unused_lock_objects);
+  my_atomic_rwlock_rdunlock(&mdl_atomic_lock);
+  return unused > (int32) mdl_locks_cache_size;
 }
 
 
 /**
-  Destroy MDL_lock object or delegate this responsibility to
-  whatever thread that holds the last outstanding reference to
-  it.
+  Try to find a random unused MDL_lock object in the hash and remove it.
+
+  @note Failing to find or to remove such an object is OK, as we
+        try again on the next release of a lock.
 */
 
-void MDL_map::remove(MDL_lock *lock)
+void MDL_map::remove_random_unused(LF_PINS *pins)
 {
-  if (lock->key.mdl_namespace() == MDL_key::GLOBAL ||
-      lock->key.mdl_namespace() == MDL_key::COMMIT ||
-      lock->key.mdl_namespace() == MDL_key::BACKUP ||
-      lock->key.mdl_namespace() == MDL_key::BINLOG)
+  MDL_lock *lock= (MDL_lock*) lf_hash_random_match(&m_locks, pins,
+                                                   &mdl_lock_match_unused,
+                                                   (uint) my_timer_cycles());
+  if (lock == NULL || lock == MY_ERRPTR)
   {
-    /*
-      Never destroy pre-allocated MDL_lock objects for GLOBAL and
-      COMMIT namespaces.
-    */
-    mysql_prlock_unlock(&lock->m_rwlock);
+    /* lf_hash_random_match() requires unpinning even if nothing is found. */
+    lf_hash_search_unpin(pins);
     return;
   }
 
-  lock->m_map_part->remove(lock);
-}
-
-
-/**
-  Destroy MDL_lock object belonging to specific MDL_map
-  partition or delegate this responsibility to whatever
-  thread that holds the last outstanding reference to it.
-*/
-
-void MDL_map_partition::remove(MDL_lock *lock)
-{
-  mysql_mutex_lock(&m_mutex);
-  my_hash_delete(&m_locks, (uchar*) lock);
   /*
-    To let threads holding references to the MDL_lock object know that it was
-    moved to the list of unused objects or destroyed, we increment the version
-    counter under protection of both MDL_map_partition::m_mutex and
-    MDL_lock::m_rwlock locks. This allows us to read the version value while
-    having either one of those locks.
+    The object might have been used after it was found. Mark it as
+    destroyed only if it is still unused. This is done under protection
+    of m_rwlock, so that threads acquiring a lock on the slow path, which
+    check IS_DESTROYED after taking m_rwlock, don't use a destroyed object.
+    Threads acquiring a lock on the fast path notice IS_DESTROYED when
+    they try to increment the counter and retry the look-up.
   */
-  lock->m_version++;
-
-  if ((lock->key.mdl_namespace() != MDL_key::SCHEMA) &&
-      (m_unused_locks_cache.elements() <
-       mdl_locks_cache_size/mdl_locks_hash_partitions))
+  mysql_prlock_wrlock(&lock->m_rwlock);
+  MDL_lock::fast_path_state_t old_state= 0;
+  if (! lock->fast_path_state_cas(&old_state, MDL_lock::IS_DESTROYED))
   {
-    /*
-      This is an object of MDL_object_lock type and the cache of unused
-      objects has not reached its maximum size yet. So instead of destroying
-      object we move it to the list of unused objects to allow its later
-      re-use with possibly different key. Any threads holding references to
-      this object (owning MDL_map_partition::m_mutex or MDL_lock::m_rwlock)
-      will notice this thanks to the fact that we have changed the
-      MDL_lock::m_version counter.
-    */
-    DBUG_ASSERT(lock->key.mdl_namespace() != MDL_key::GLOBAL &&
-                lock->key.mdl_namespace() != MDL_key::COMMIT &&
-                lock->key.mdl_namespace() != MDL_key::BACKUP &&
-                lock->key.mdl_namespace() != MDL_key::BINLOG);
-
-    m_unused_locks_cache.push_front((MDL_object_lock*)lock);
-    mysql_mutex_unlock(&m_mutex);
     mysql_prlock_unlock(&lock->m_rwlock);
+    lf_hash_search_unpin(pins);
+    return;
   }
-  else
-  {
-    /*
-      Destroy the MDL_lock object, but ensure that anyone that is
-      holding a reference to the object is not remaining, if so he
-      has the responsibility to release it.
-
-      Setting of m_is_destroyed to TRUE while holding _both_
-      MDL_map_partition::m_mutex and MDL_lock::m_rwlock mutexes transfers
-      the protection of m_ref_usage from MDL_map_partition::m_mutex to
-      MDL_lock::m_rwlock while removal of the object from the hash
-      (and cache of unused objects) makes it read-only. Therefore
-      whoever acquires MDL_lock::m_rwlock next will see the most up
-      to date version of m_ref_usage.
-
-      This means that when m_is_destroyed is TRUE and we hold the
-      MDL_lock::m_rwlock we can safely read the m_ref_usage
-      member.
-    */
-    uint ref_usage, ref_release;
+  mysql_prlock_unlock(&lock->m_rwlock);
 
-    lock->m_is_destroyed= TRUE;
-    ref_usage= lock->m_ref_usage;
-    ref_release= lock->m_ref_release;
-    mysql_mutex_unlock(&m_mutex);
-    mysql_prlock_unlock(&lock->m_rwlock);
-    if (ref_usage == ref_release)
-      MDL_lock::destroy(lock);
-  }
+  /*
+    Nobody else can remove the object from the hash now and it stays
+    in memory until we do so, so the key can be read after unpinning it.
+  */
+  lf_hash_search_unpin(pins);
+  lf_hash_delete(&m_locks, pins, lock->key.ptr(), lock->key.length());
 }
 
 
@@ -1189,7 +1020,8 @@ MDL_context::MDL_context()
   :
   m_owner(NULL),
   m_needs_thr_lock_abort(FALSE),
-  m_waiting_for(NULL)
+  m_waiting_for(NULL),
+  m_pins(NULL)
 {
   mysql_prlock_init(key_MDL_context_LOCK_waiting_for, &m_LOCK_waiting_for);
 }
@@ -1214,6 +1046,58 @@ void MDL_context::destroy()
   DBUG_ASSERT(m_tickets[MDL_EXPLICIT].is_empty());
 
   mysql_prlock_destroy(&m_LOCK_waiting_for);
+  if (m_pins)
+    lf_hash_put_pins(m_pins);
+}
+
+
+/**
+  Allocate pins which are necessary to work with MDL_map container
+  if they are not allocated already.
+
+  @return TRUE on failure (OOM), FALSE otherwise.
+*/
+
+bool MDL_context::fix_pins()
+{
+  if (! m_pins)
+    m_pins= mdl_locks.get_pins();
+  return m_pins == NULL;
+}
+
+
+/**
+  Move the locks of this context granted on the fast path to the slow
+  path, i.e. add their tickets to MDL_lock::m_granted and decrement
+  the fast path counters.
+
+  This is done before the context requests an obtrusive lock, so that
+  its own locks don't look like conflicting ones, and before it starts
+  waiting, so that its locks are visible to the deadlock detector.
+*/
+
+void MDL_context::materialize_fast_path_locks()
+{
+  for (int i= 0; i < MDL_DURATION_END; i++)
+  {
+    Ticket_iterator it(m_tickets[i]);
+    MDL_ticket *ticket;
+
+    while ((ticket= it++))
+    {
+      if (! ticket->m_is_fast_path)
+        continue;
+
+      MDL_lock *lock= ticket->m_lock;
+      mysql_prlock_wrlock(&lock->m_rwlock);
+      lock->m_granted.add_ticket(ticket);
+      lock->slow_path_lists_changed();
+      lock->fast_path_state_add(
+              -lock->get_unobtrusive_lock_increment(ticket->get_type()));
+      mysql_prlock_unlock(&lock->m_rwlock);
+      ticket->m_is_fast_path= false;
+    }
+  }
 }
 
 
@@ -1270,35 +1154,6 @@ void MDL_request::init(const MDL_key *key_arg,
 }
 
 
-/**
-  Auxiliary functions needed for creation/destruction of MDL_lock objects.
-
-  @note Also chooses an MDL_lock descendant appropriate for object namespace.
-*/
-
-inline MDL_lock *MDL_lock::create(const MDL_key *mdl_key,
-                                  MDL_map_partition *map_part)
-{
-  switch (mdl_key->mdl_namespace())
-  {
-    case MDL_key::GLOBAL:
-    case MDL_key::SCHEMA:
-    case MDL_key::COMMIT:
-    case MDL_key::BACKUP:
-    case MDL_key::BINLOG:
-      return new (std::nothrow) MDL_scoped_lock(mdl_key, map_part);
-    default:
-      return new (std::nothrow) MDL_object_lock(mdl_key, map_part);
-  }
-}
-
-
-void MDL_lock::destroy(MDL_lock *lock)
-{
-  delete lock;
-}
-
-
 /**
   Auxiliary functions needed for creation/destruction of MDL_ticket
   objects.
@@ -1714,17 +1569,38 @@ void MDL_lock::reschedule_waiters()
   on schema objects) and aren't acquired for DML.
 */
 
-const MDL_lock::bitmap_t MDL_scoped_lock::m_granted_incompatible[MDL_TYPE_END] =
+const MDL_lock::MDL_lock_strategy MDL_lock::m_scoped_lock_strategy =
 {
-  MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED),
-  MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_INTENTION_EXCLUSIVE), 0, 0, 0, 0, 0, 0,
-  MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED) | MDL_BIT(MDL_INTENTION_EXCLUSIVE)
-};
-
-const MDL_lock::bitmap_t MDL_scoped_lock::m_waiting_incompatible[MDL_TYPE_END] =
-{
-  MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED),
-  MDL_BIT(MDL_EXCLUSIVE), 0, 0, 0, 0, 0, 0, 0
+  /**
+    Compatibility (or rather "incompatibility") matrices for scoped
+    metadata lock, see above.
+  */
+  {
+    MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED),
+    MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_INTENTION_EXCLUSIVE), 0, 0, 0, 0, 0, 0,
+    MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED) | MDL_BIT(MDL_INTENTION_EXCLUSIVE)
+  },
+  {
+    MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED),
+    MDL_BIT(MDL_EXCLUSIVE), 0, 0, 0, 0, 0, 0, 0
+  },
+  /**
+    IX locks, acquired by each statement changing data, are unobtrusive.
+    S and X locks are obtrusive.
+  */
+  {
+    1, 0, 0, 0, 0, 0, 0, 0, 0
+  },
+  { MDL_BIT(MDL_INTENTION_EXCLUSIVE), 0, 0 },
+  /**
+    In scoped locks, only IX lock request would starve because of X/S.
+    But that is practically a very rare case. So we don't notify the
+    owners of IX locks, which is done by the SQL-layer instead.
+  */
+  MDL_BIT(MDL_SHARED),
+  MDL_BIT(MDL_INTENTION_EXCLUSIVE),
+  /* There is no starvation issues for scoped locks. */
+  0
 };
 
 
@@ -1782,43 +1658,69 @@ const MDL_lock::bitmap_t MDL_scoped_lock::m_waiting_incompatible[MDL_TYPE_END] =
         metadata locks.
 */
 
-const MDL_lock::bitmap_t
-MDL_object_lock::m_granted_incompatible[MDL_TYPE_END] =
-{
-  0,
-  MDL_BIT(MDL_EXCLUSIVE),
-  MDL_BIT(MDL_EXCLUSIVE),
-  MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE),
-  MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
-    MDL_BIT(MDL_SHARED_NO_WRITE),
-  MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
-    MDL_BIT(MDL_SHARED_NO_WRITE) | MDL_BIT(MDL_SHARED_UPGRADABLE),
-  MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
-    MDL_BIT(MDL_SHARED_NO_WRITE) | MDL_BIT(MDL_SHARED_UPGRADABLE) |
+const MDL_lock::MDL_lock_strategy MDL_lock::m_object_lock_strategy =
+{
+  {
+    0,
+    MDL_BIT(MDL_EXCLUSIVE),
+    MDL_BIT(MDL_EXCLUSIVE),
+    MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE),
+    MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
+      MDL_BIT(MDL_SHARED_NO_WRITE),
+    MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
+      MDL_BIT(MDL_SHARED_NO_WRITE) | MDL_BIT(MDL_SHARED_UPGRADABLE),
+    MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
+      MDL_BIT(MDL_SHARED_NO_WRITE) | MDL_BIT(MDL_SHARED_UPGRADABLE) |
+      MDL_BIT(MDL_SHARED_WRITE),
+    MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
+      MDL_BIT(MDL_SHARED_NO_WRITE) | MDL_BIT(MDL_SHARED_UPGRADABLE) |
+      MDL_BIT(MDL_SHARED_WRITE) | MDL_BIT(MDL_SHARED_READ),
+    MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
+      MDL_BIT(MDL_SHARED_NO_WRITE) | MDL_BIT(MDL_SHARED_UPGRADABLE) |
+      MDL_BIT(MDL_SHARED_WRITE) | MDL_BIT(MDL_SHARED_READ) |
+      MDL_BIT(MDL_SHARED_HIGH_PRIO) | MDL_BIT(MDL_SHARED)
+  },
+  {
+    0,
+    MDL_BIT(MDL_EXCLUSIVE),
+    0,
+    MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE),
+    MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
+      MDL_BIT(MDL_SHARED_NO_WRITE),
+    MDL_BIT(MDL_EXCLUSIVE),
+    MDL_BIT(MDL_EXCLUSIVE),
+    MDL_BIT(MDL_EXCLUSIVE),
+    0
+  },
+  /**
+    S, SH and SR locks, acquired by SELECT, and SW locks, acquired by
+    INSERT, UPDATE and DELETE, are unobtrusive. They are counted by
+    three counters: S and SH locks conflict with the same requests.
+  */
+  {
+    0, 1, 1, 1LL << 20, 1LL << 40, 0, 0, 0, 0
+  },
+  {
+    MDL_BIT(MDL_SHARED) | MDL_BIT(MDL_SHARED_HIGH_PRIO),
+    MDL_BIT(MDL_SHARED_READ),
+    MDL_BIT(MDL_SHARED_WRITE)
+  },
+  /**
+    To avoid starvation and deadlocks with thr_lock.c, requests for SNW,
+    SNRW and X locks abort the table-level locks of the owners of
+    conflicting shared locks.
+  */
+  MDL_BIT(MDL_SHARED_NO_WRITE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
+    MDL_BIT(MDL_EXCLUSIVE),
+  MDL_BIT(MDL_INTENTION_EXCLUSIVE) | MDL_BIT(MDL_SHARED) |
+    MDL_BIT(MDL_SHARED_HIGH_PRIO) | MDL_BIT(MDL_SHARED_READ) |
     MDL_BIT(MDL_SHARED_WRITE),
-  MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
-    MDL_BIT(MDL_SHARED_NO_WRITE) | MDL_BIT(MDL_SHARED_UPGRADABLE) |
-    MDL_BIT(MDL_SHARED_WRITE) | MDL_BIT(MDL_SHARED_READ),
-  MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
-    MDL_BIT(MDL_SHARED_NO_WRITE) | MDL_BIT(MDL_SHARED_UPGRADABLE) |
-    MDL_BIT(MDL_SHARED_WRITE) | MDL_BIT(MDL_SHARED_READ) |
-    MDL_BIT(MDL_SHARED_HIGH_PRIO) | MDL_BIT(MDL_SHARED)
-};
-
-
-const MDL_lock::bitmap_t
-MDL_object_lock::m_waiting_incompatible[MDL_TYPE_END] =
-{
-  0,
-  MDL_BIT(MDL_EXCLUSIVE),
-  0,
-  MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE),
-  MDL_BIT(MDL_EXCLUSIVE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
-    MDL_BIT(MDL_SHARED_NO_WRITE),
-  MDL_BIT(MDL_EXCLUSIVE),
-  MDL_BIT(MDL_EXCLUSIVE),
-  MDL_BIT(MDL_EXCLUSIVE),
-  0
+  /**
+    SNW, SNRW and X locks are only granted max_write_lock_count
+    times in a row while weaker locks are waiting.
+  */
+  MDL_BIT(MDL_SHARED_NO_WRITE) | MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
+    MDL_BIT(MDL_EXCLUSIVE)
 };
 
 
@@ -1856,7 +1758,14 @@ MDL_lock::can_grant_lock(enum_mdl_type type_arg,
   */
   if (ignore_lock_priority || !(m_waiting.bitmap() & waiting_incompat_map))
   {
-    if (! (m_granted.bitmap() & granted_incompat_map))
+    /*
+      Locks granted on the fast path can't belong to the requestor,
+      since contexts move their fast path locks to the slow path
+      before they request an obtrusive lock.
+    */
+    if (fast_path_granted_bitmap() & granted_incompat_map)
+      can_grant= FALSE;
+    else if (! (m_granted.bitmap() & granted_incompat_map))
       can_grant= TRUE;
     else
     {
@@ -1904,9 +1813,10 @@ void MDL_lock::remove_ticket(Ticket_list MDL_lock::*list, MDL_ticket *ticket)
   DEBUG_SYNC(current_thd, "mdl_lock_remove_ticket_m_rwlock_locked");
 
   (this->*list).remove_ticket(ticket);
-  if (is_empty())
-    mdl_locks.remove(this);
-  else
+  if (is_obtrusive_lock(ticket->get_type()))
+    obtrusive_lock_removed();
+  slow_path_lists_changed();
+  if (! is_empty())
   {
     /*
       There can be some contexts waiting to acquire a lock
@@ -1923,8 +1833,160 @@ void MDL_lock::remove_ticket(Ticket_list MDL_lock::*list, MDL_ticket *ticket)
       pending request).
     */
     reschedule_waiters();
-    mysql_prlock_unlock(&m_rwlock);
   }
+  mysql_prlock_unlock(&m_rwlock);
+}
+
+
+/**
+  Release a lock granted on the fast path by decrementing its counter.
+
+  @note If there are obtrusive locks pending, some of them might be
+        waiting for this lock to go away, so the counter is decremented
+        under protection of m_rwlock and the waiters are rescheduled.
+*/
+
+void MDL_lock::release_fast_path_lock(enum_mdl_type type)
+{
+  fast_path_state_t increment= get_unobtrusive_lock_increment(type);
+  fast_path_state_t old_state= get_fast_path_state();
+
+  do
+  {
+    if (old_state & HAS_OBTRUSIVE)
+    {
+      mysql_prlock_wrlock(&m_rwlock);
+      fast_path_state_add(-increment);
+      reschedule_waiters();
+      mysql_prlock_unlock(&m_rwlock);
+      return;
+    }
+  }
+  while (! fast_path_state_cas(&old_state, old_state - increment));
+}
+
+
+/**
+  Get the bitmap of types of locks granted on the fast path.
+*/
+
+MDL_lock::bitmap_t MDL_lock::fast_path_granted_bitmap() const
+{
+  fast_path_state_t state= get_fast_path_state();
+  bitmap_t result= 0;
+
+  for (uint i= 0; i < FAST_PATH_COUNTERS; i++)
+  {
+    if ((state >> (i * FAST_PATH_COUNTER_BITS)) &
+        ((1LL << FAST_PATH_COUNTER_BITS) - 1))
+      result|= m_strategy->m_fast_path_counter_types[i];
+  }
+  return result;
+}
+
+
+/**
+  Atomically change m_fast_path_state if it still has the expected value.
+
+  @param[in,out] old_state  Expected value. Updated to the current value
+                            on failure.
+  @param         new_state  The new value.
+
+  @note The number of unused objects in the hash is updated when an
+        object becomes used or unused. Pre-allocated singleton objects
+        are never removed, so they are not counted.
+
+  @retval TRUE   Success.
+  @retval FALSE  The value has been changed concurrently.
+*/
+
+bool MDL_lock::fast_path_state_cas(fast_path_state_t *old_state,
+                                   fast_path_state_t new_state)
+{
+  bool success;
+  fast_path_state_t expected= *old_state;
+
+  my_atomic_rwlock_wrlock(&mdl_atomic_lock);
+  success= my_atomic_cas64(&m_fast_path_state, old_state, new_state);
+  my_atomic_rwlock_wrunlock(&mdl_atomic_lock);
+
+  if (success && ! mdl_locks.is_lock_object_singleton(&key))
+  {
+    if (expected == 0 && new_state != 0)
+      mdl_locks.add_unused_lock_objects(-1);
+    else if (expected != 0 && new_state == 0)
+      mdl_locks.add_unused_lock_objects(1);
+  }
+  return success;
+}
+
+
+/** Atomically add a value to m_fast_path_state. */
+
+void MDL_lock::fast_path_state_add(fast_path_state_t value)
+{
+  fast_path_state_t old_state= get_fast_path_state();
+  while (! fast_path_state_cas(&old_state, old_state + value))
+  { }
+}
+
+
+/** Atomically set and reset flags of m_fast_path_state. */
+
+void MDL_lock::fast_path_state_update(fast_path_state_t set_flags,
+                                      fast_path_state_t reset_flags)
+{
+  fast_path_state_t old_state= get_fast_path_state();
+  while (! fast_path_state_cas(&old_state,
+                               (old_state | set_flags) & ~reset_flags))
+  { }
+}
+
+
+/**
+  Account for an obtrusive lock granted or pending, which prevents
+  new unobtrusive locks from being granted on the fast path.
+
+  @pre m_rwlock is write-locked.
+*/
+
+void MDL_lock::obtrusive_lock_added()
+{
+  mysql_prlock_assert_write_owner(&m_rwlock);
+  if (m_obtrusive_locks_granted_waiting_count++ == 0)
+    fast_path_state_update(HAS_OBTRUSIVE, 0);
+}
+
+
+/**
+  Account for an obtrusive lock released or no longer pending.
+
+  @pre m_rwlock is write-locked.
+*/
+
+void MDL_lock::obtrusive_lock_removed()
+{
+  mysql_prlock_assert_write_owner(&m_rwlock);
+  DBUG_ASSERT(m_obtrusive_locks_granted_waiting_count > 0);
+  if (--m_obtrusive_locks_granted_waiting_count == 0)
+    fast_path_state_update(0, HAS_OBTRUSIVE);
+}
+
+
+/**
+  Update HAS_SLOW_PATH flag after m_granted or m_waiting were changed,
+  so that the object is not considered unused while they are not empty.
+
+  @pre m_rwlock is write-locked.
+*/
+
+void MDL_lock::slow_path_lists_changed()
+{
+  mysql_prlock_assert_write_owner(&m_rwlock);
+  if (is_empty())
+    fast_path_state_update(0, HAS_SLOW_PATH);
+  else
+    fast_path_state_update(HAS_SLOW_PATH, 0);
 }
 
 
@@ -2075,8 +2137,10 @@ MDL_context::try_acquire_lock(MDL_request *mdl_request)
       We can't get here if we allocated a new lock object so there
       is no need to release it.
     */
-    DBUG_ASSERT(! ticket->m_lock->is_empty());
-    mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
+    MDL_lock *lock= ticket->m_lock;
+    if (lock->is_obtrusive_lock(ticket->get_type()))
+      lock->obtrusive_lock_removed();
+    mysql_prlock_unlock(&lock->m_rwlock);
     MDL_ticket::destroy(ticket);
   }
 
@@ -2154,6 +2218,13 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
     return FALSE;
   }
 
+  /*
+    Pins are required to work with the lock-free hash of MDL_lock objects.
+    They are allocated once for a context and kept until it is destroyed.
+  */
+  if (fix_pins())
+    return TRUE;
+
   if (!(ticket= MDL_ticket::create(this, mdl_request->type
 #ifndef DBUG_OFF
                                    , mdl_request->duration
@@ -2161,18 +2232,102 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
                                    )))
     return TRUE;
 
-  /* The below call implicitly locks MDL_lock::m_rwlock on success. */
-  if (!(lock= mdl_locks.find_or_insert(key)))
+  MDL_lock::fast_path_state_t unobtrusive_lock_increment=
+    MDL_lock::get_strategy(key)->
+      m_unobtrusive_lock_increment[mdl_request->type];
+
+  /*
+    Conflicting locks granted on the fast path to other contexts must be
+    seen before an obtrusive lock is granted, and so must our own locks,
+    which are not conflicting. Move the fast path locks of this context
+    to the slow path before requesting an obtrusive lock.
+  */
+  if (! unobtrusive_lock_increment)
+    materialize_fast_path_locks();
+
+  bool pinned;
+
+retry:
+  if (!(lock= mdl_locks.find_or_insert(m_pins, key, &pinned)))
   {
     MDL_ticket::destroy(ticket);
     return TRUE;
   }
 
+  /*
+    Contexts which need their table-level locks to be aborted when
+    an obtrusive lock is requested must be notified, so they only
+    acquire locks on the slow path.
+  */
+  if (unobtrusive_lock_increment && ! m_needs_thr_lock_abort)
+  {
+    /*
+      Try to grant the unobtrusive lock by incrementing its counter,
+      unless there are obtrusive locks granted or pending.
+    */
+    MDL_lock::fast_path_state_t old_state= lock->get_fast_path_state();
+    do
+    {
+      if (old_state & MDL_lock::IS_DESTROYED)
+      {
+        /* The object is being removed from the hash, look it up again. */
+        if (pinned)
+          lf_hash_search_unpin(m_pins);
+        goto retry;
+      }
+      if (old_state & MDL_lock::HAS_OBTRUSIVE)
+        goto slow_path;
+    }
+    while (! lock->fast_path_state_cas(&old_state,
+                                       old_state + unobtrusive_lock_increment));
+
+    /*
+      The object can't be removed from the hash while it has locks
+      granted, so it is safe to unpin it.
+    */
+    if (pinned)
+      lf_hash_search_unpin(m_pins);
+
+    ticket->m_lock= lock;
+    ticket->m_is_fast_path= true;
+    m_tickets[mdl_request->duration].push_front(ticket);
+    mdl_request->ticket= ticket;
+    return FALSE;
+  }
+
+slow_path:
+
+  mysql_prlock_wrlock(&lock->m_rwlock);
+
+  if (lock->get_fast_path_state() & MDL_lock::IS_DESTROYED)
+  {
+    mysql_prlock_unlock(&lock->m_rwlock);
+    if (pinned)
+      lf_hash_search_unpin(m_pins);
+    goto retry;
+  }
+
+  /*
+    Holding m_rwlock prevents the object from being removed from the hash
+    until a ticket is added to one of its lists, so it can be unpinned.
+  */
+  if (pinned)
+    lf_hash_search_unpin(m_pins);
+
   ticket->m_lock= lock;
 
+  /*
+    An obtrusive lock stops new unobtrusive locks from being granted on
+    the fast path while it is granted or pending, so that counters of
+    the existing ones can only go down.
+  */
+  if (! unobtrusive_lock_increment)
+    lock->obtrusive_lock_added();
+
   if (lock->can_grant_lock(mdl_request->type, this, false))
   {
     lock->m_granted.add_ticket(ticket);
+    lock->slow_path_lists_changed();
 
     mysql_prlock_unlock(&lock->m_rwlock);
 
@@ -2224,9 +2379,17 @@ MDL_context::clone_ticket(MDL_request *mdl_request)
   ticket->m_lock= mdl_request->ticket->m_lock;
   mdl_request->ticket= ticket;
 
-  mysql_prlock_wrlock(&ticket->m_lock->m_rwlock);
-  ticket->m_lock->m_granted.add_ticket(ticket);
-  mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
+  /*
+    Clones are always granted on the slow path, so that owners of cloned
+    locks, like handler threads for insert delayed, can be notified.
+  */
+  MDL_lock *lock= ticket->m_lock;
+  mysql_prlock_wrlock(&lock->m_rwlock);
+  lock->m_granted.add_ticket(ticket);
+  if (lock->is_obtrusive_lock(ticket->m_type))
+    lock->obtrusive_lock_added();
+  lock->slow_path_lists_changed();
+  mysql_prlock_unlock(&lock->m_rwlock);
 
   m_tickets[mdl_request->duration].push_front(ticket);
 
@@ -2235,13 +2398,21 @@ MDL_context::clone_ticket(MDL_request *mdl_request)
 
 
 /**
-  Notify threads holding a shared metadata locks on object which
-  conflict with a pending X, SNW or SNRW lock.
+  Notify threads holding shared metadata locks which conflict with
+  a pending X, SNW or SNRW lock on an object or with a pending scoped
+  S lock.
 
   @param  ctx  MDL_context for current thread.
+
+  @note Locks granted on the fast path are not in m_granted, so their
+        owners are not notified. This is OK, since the only owners which
+        need notification are the handler threads for insert delayed,
+        which get their locks with clone_ticket(), and contexts which
+        need their table-level locks aborted, which don't use the fast
+        path (see MDL_context::set_needs_thr_lock_abort()).
 */
 
-void MDL_object_lock::notify_conflicting_locks(MDL_context *ctx)
+void MDL_lock::notify_conflicting_locks(MDL_context *ctx)
 {
   Ticket_iterator it(m_granted);
   MDL_ticket *conflicting_ticket;
@@ -2250,47 +2421,17 @@ void MDL_object_lock::notify_conflicting_locks(MDL_context *ctx)
   {
     /* Only try to abort locks on which we back off. */
     if (conflicting_ticket->get_ctx() != ctx &&
-        conflicting_ticket->get_type() < MDL_SHARED_UPGRADABLE)
-
+        (MDL_BIT(conflicting_ticket->get_type()) &
+         m_strategy->m_notified_types))
     {
       MDL_context *conflicting_ctx= conflicting_ticket->get_ctx();
 
       /*
         If thread which holds conflicting lock is waiting on table-level
         lock or some other non-MDL resource we might need to wake it up
-        by calling code outside of MDL.
-      */
-      ctx->get_owner()->
-        notify_shared_lock(conflicting_ctx->get_owner(),
-                           conflicting_ctx->get_needs_thr_lock_abort());
-    }
-  }
-}
-
-
-/**
-  Notify threads holding scoped IX locks which conflict with a pending S lock.
-
-  @param  ctx  MDL_context for current thread.
-*/
-
-void MDL_scoped_lock::notify_conflicting_locks(MDL_context *ctx)
-{
-  Ticket_iterator it(m_granted);
-  MDL_ticket *conflicting_ticket;
-
-  while ((conflicting_ticket= it++))
-  {
-    if (conflicting_ticket->get_ctx() != ctx &&
-        conflicting_ticket->get_type() == MDL_INTENTION_EXCLUSIVE)
-
-    {
-      MDL_context *conflicting_ctx= conflicting_ticket->get_ctx();
-
-      /*
-        Thread which holds global IX lock can be a handler thread for
-        insert delayed. We need to kill such threads in order to get
-        global shared lock. We do this my calling code outside of MDL.
+        by calling code outside of MDL. Thread which holds global IX lock
+        can be a handler thread for insert delayed. We need to kill such
+        threads in order to get global shared lock.
       */
       ctx->get_owner()->
         notify_shared_lock(conflicting_ctx->get_owner(),
@@ -2344,6 +2485,7 @@ MDL_context::acquire_lock(MDL_request *mdl_request, ulong lock_wait_timeout)
   lock= ticket->m_lock;
 
   lock->m_waiting.add_ticket(ticket);
+  lock->slow_path_lists_changed();
 
   /*
     Once we added a pending ticket to the waiting queue,
@@ -2573,20 +2715,36 @@ MDL_context::upgrade_shared_lock(MDL_ticket *mdl_ticket,
 
   is_new_ticket= ! has_lock(mdl_svp, mdl_xlock_request.ticket);
 
+  MDL_lock *lock= mdl_ticket->m_lock;
+
+  /*
+    Locks are only upgraded to obtrusive types, so acquiring the new lock
+    has moved all locks of the context to the slow path.
+  */
+  DBUG_ASSERT(lock->is_obtrusive_lock(new_type));
+  DBUG_ASSERT(! mdl_ticket->m_is_fast_path);
+
   /* Merge the acquired and the original lock. @todo: move to a method. */
-  mysql_prlock_wrlock(&mdl_ticket->m_lock->m_rwlock);
+  mysql_prlock_wrlock(&lock->m_rwlock);
+  /* Account for the new type first, so that HAS_OBTRUSIVE stays set. */
+  lock->obtrusive_lock_added();
   if (is_new_ticket)
-    mdl_ticket->m_lock->m_granted.remove_ticket(mdl_xlock_request.ticket);
+  {
+    lock->m_granted.remove_ticket(mdl_xlock_request.ticket);
+    lock->obtrusive_lock_removed();
+  }
   /*
     Set the new type of lock in the ticket. To update state of
     MDL_lock object correctly we need to temporarily exclude
     ticket from the granted queue and then include it back.
   */
-  mdl_ticket->m_lock->m_granted.remove_ticket(mdl_ticket);
+  lock->m_granted.remove_ticket(mdl_ticket);
+  if (lock->is_obtrusive_lock(mdl_ticket->m_type))
+    lock->obtrusive_lock_removed();
   mdl_ticket->m_type= new_type;
-  mdl_ticket->m_lock->m_granted.add_ticket(mdl_ticket);
+  lock->m_granted.add_ticket(mdl_ticket);
 
-  mysql_prlock_unlock(&mdl_ticket->m_lock->m_rwlock);
+  mysql_prlock_unlock(&lock->m_rwlock);
 
   if (is_new_ticket)
   {
@@ -2866,11 +3024,22 @@ void MDL_context::release_lock(enum_mdl_duration duration, MDL_ticket *ticket)
   DBUG_ASSERT(this == ticket->get_ctx());
   mysql_mutex_assert_not_owner(&LOCK_open);
 
-  lock->remove_ticket(&MDL_lock::m_granted, ticket);
+  if (ticket->m_is_fast_path)
+    lock->release_fast_path_lock(ticket->get_type());
+  else
+    lock->remove_ticket(&MDL_lock::m_granted, ticket);
 
   m_tickets[duration].remove(ticket);
   MDL_ticket::destroy(ticket);
 
+  /*
+    Remove an unused MDL_lock object from the hash if there are too many
+    of them. This is done after the lock is released, so that we don't
+    hold m_rwlock of one object while we acquire it for another one.
+  */
+  if (mdl_locks.has_too_many_unused_lock_objects() && ! fix_pins())
+    mdl_locks.remove_random_unused(m_pins);
+
   DBUG_VOID_RETURN;
 }
 
@@ -2973,12 +3142,19 @@ void MDL_ticket::downgrade_lock(enum_mdl_type type)
   DBUG_ASSERT(m_type == MDL_EXCLUSIVE ||
               m_type == MDL_SHARED_NO_WRITE);
 
+  /* Locks of these types are never granted on the fast path. */
+  DBUG_ASSERT(! m_is_fast_path);
+
   mysql_prlock_wrlock(&m_lock->m_rwlock);
   /*
     To update state of MDL_lock object correctly we need to temporarily
     exclude ticket from the granted queue and then include it back.
+    The ticket stays on the slow path even if the new type is unobtrusive.
   */
   m_lock->m_granted.remove_ticket(this);
+  if (m_lock->is_obtrusive_lock(type))
+    m_lock->obtrusive_lock_added();
+  m_lock->obtrusive_lock_removed();
   m_type= type;
   m_lock->m_granted.add_ticket(this);
   m_lock->reschedule_waiters();
@@ -3029,7 +3205,10 @@ MDL_context::is_lock_owner(MDL_key::enum_mdl_namespace mdl_namespace,
 unsigned long
 MDL_context::get_lock_owner(MDL_key *key)
 {
-  return mdl_locks.get_lock_owner(key);
+  if (fix_pins())
+    return 0;
+
+  return mdl_locks.get_lock_owner(m_pins, key);
 }
 
 
@@ -28,6 +28,7 @@
 #include <my_sys.h>
 #include <m_string.h>
 #include <mysql_com.h>
+#include <lf.h>
 
 #include <algorithm>
 
@@ -126,8 +127,8 @@ public:
 /**
   Type of metadata lock request.
 
-  @sa Comments for MDL_object_lock::can_grant_lock() and
-      MDL_scoped_lock::can_grant_lock() for details.
+  @sa Comments for MDL_lock::can_grant_lock() and the compatibility
+      matrices of MDL_lock strategies for details.
 */
 
 enum enum_mdl_type {
@@ -600,6 +601,7 @@ public:
   enum_mdl_type get_type() const { return m_type; }
   MDL_lock *get_lock() const { return m_lock; }
   MDL_key *get_key() const;
+  bool is_fast_path() const { return m_is_fast_path; }
   void downgrade_lock(enum_mdl_type type);
 
   bool has_stronger_or_equal_type(enum_mdl_type type) const;
@@ -623,7 +625,8 @@ private:
      m_duration(duration_arg),
 #endif
      m_ctx(ctx_arg),
-     m_lock(NULL)
+     m_lock(NULL),
+     m_is_fast_path(false)
   {}
 
   static MDL_ticket *create(MDL_context *ctx_arg, enum_mdl_type type_arg
@@ -652,6 +655,13 @@ private:
   */
   MDL_lock *m_lock;
 
+  /**
+    TRUE if the lock is granted on the "fast path", i.e. it is only
+    counted in MDL_lock::m_fast_path_state and the ticket is not in
+    the MDL_lock::m_granted list. Context private.
+  */
+  bool m_is_fast_path;
+
 private:
   MDL_ticket(const MDL_ticket &);               /* not implemented */
   MDL_ticket &operator=(const MDL_ticket &);    /* not implemented */
@@ -815,6 +825,14 @@ public:
             will see the new value eventually.
     */
     m_needs_thr_lock_abort= needs_thr_lock_abort;
+
+    /*
+      The owners of fast path locks are not known to the MDL_lock, so
+      they could not be notified. Contexts which need thr_lock aborts
+      keep all their locks on the slow path.
+    */
+    if (m_needs_thr_lock_abort)
+      materialize_fast_path_locks();
   }
   bool get_needs_thr_lock_abort() const
   {
@@ -910,8 +928,15 @@ private:
     readily available to the wait-for graph iterator.
    */
   MDL_wait_for_subgraph *m_waiting_for;
+  /**
+    Pins of the thread owning this context for access to the lock-free
+    hash of MDL_lock objects. Obtained on first use, see fix_pins().
+  */
+  LF_PINS *m_pins;
 private:
   THD *get_thd() const { return m_owner->get_thd(); }
+  bool fix_pins();
+  void materialize_fast_path_locks();
   MDL_ticket *find_ticket(MDL_request *mdl_req,
                           enum_mdl_duration *duration);
   void release_locks_stored_before(enum_mdl_duration duration, MDL_ticket *sentinel);
@@ -927,6 +952,12 @@ public:
   /** Inform the deadlock detector there is an edge in the wait-for graph. */
   void will_wait_for(MDL_wait_for_subgraph *waiting_for_arg)
   {
+    /*
+      Make our fast path locks visible to the deadlock detector
+      before we become a node of the wait-for graph.
+    */
+    materialize_fast_path_locks();
+
     mysql_prlock_wrlock(&m_LOCK_waiting_for);
     m_waiting_for=  waiting_for_arg;
     mysql_prlock_unlock(&m_LOCK_waiting_for);
@@ -973,7 +1004,8 @@ static const ulong MDL_LOCKS_CACHE_SIZE_DEFAULT = 1024;
 /*
   Start-up parameter for the number of partitions of the hash
   containing all the MDL_lock objects and a constant for
-  its default value.
+  its default value. Deprecated, MDL_lock objects are now kept
+  in a lock-free hash.
 */
 extern ulong mdl_locks_hash_partitions;
 static const ulong MDL_LOCKS_HASH_PARTITIONS_DEFAULT = 8;
@@ -27,6 +27,7 @@
 #include <signal.h>
 #include "sql_parse.h"    // test_if_data_home_dir
 #include "sql_cache.h"    // query_cache, query_cache_*
+#include "sql_plan_cache.h" // plan_cache
 #include "sql_locale.h"   // MY_LOCALES, my_locales, my_locale_by_name
 #include "sql_show.h"     // free_status_vars, add_status_vars,
                           // reset_status_vars
@@ -89,6 +90,7 @@
 #include "mysql_com_server.h"
 
 #include "keycaches.h"
+#include "sql_tmp_table.h"                      // update_internal_tmp_disk_key_cache
 #include "../storage/myisam/ha_myisam.h"
 #include "set_var.h"
 
@@ -380,6 +382,8 @@ static bool binlog_format_used= false;
 
 LEX_STRING opt_init_connect, opt_init_slave;
 
+/* Protects the thread cache, waiting_thd_list and the counters of it */
+static mysql_mutex_t LOCK_thread_cache;
 static mysql_cond_t COND_thread_cache, COND_flush_thread_cache;
 
 /* Global variables */
@@ -671,6 +675,7 @@ char *mysql_data_home= const_cast<char*>(".");
 const char *mysql_real_data_home_ptr= mysql_real_data_home;
 char server_version[SERVER_VERSION_LENGTH];
 char *mysqld_unix_port, *opt_mysql_tmpdir;
+char *opt_internal_tmp_disk_key_cache;
 ulong thread_handling;
 
 /** name of reference on left expression in rewritten IN subquery */
@@ -749,7 +754,7 @@ SHOW_COMP_OPTION have_statement_timeout= SHOW_OPTION_DISABLED;
 pthread_key(MEM_ROOT**,THR_MALLOC);
 pthread_key(THD*, THR_THD);
 mysql_mutex_t LOCK_thread_created;
-mysql_mutex_t LOCK_thread_count, LOCK_thd_remove;
+mysql_mutex_t LOCK_thread_count;
 mysql_mutex_t
   LOCK_status, LOCK_error_log, LOCK_uuid_generator,
   LOCK_delayed_insert, LOCK_delayed_status, LOCK_delayed_create,
@@ -841,8 +846,35 @@ void deinit_rsa_keys(void);
 int show_rsa_public_key(THD *thd, SHOW_VAR *var, char *buff);
 #endif
 
-static volatile sig_atomic_t global_thread_count= 0;
-static std::set<THD*> *global_thread_list= NULL;
+static volatile int32 global_thread_count= 0;
+static my_atomic_rwlock_t global_thread_count_lock, thread_id_lock;
+
+/**
+  Number of partitions of the global thread list. Threads are put in a
+  partition by thread id, so that KILL looks in one partition only.
+*/
+static const uint THD_LIST_PARTITIONS= 8;
+
+/**
+  A partition of the global thread list and its locks.
+*/
+struct Thd_list_partition
+{
+  /* Protects the set, held while scanning it */
+  mysql_mutex_t LOCK_thd_list;
+  /* Held to prevent removal while a copy of the set is used */
+  mysql_mutex_t LOCK_thd_remove;
+  /* Broadcast when a THD is removed from the set */
+  mysql_cond_t COND_thd_list;
+  std::set<THD*> *threads;
+};
+
+static Thd_list_partition thd_list_partitions[THD_LIST_PARTITIONS];
+
+static inline Thd_list_partition *thd_list_partition(ulong id)
+{
+  return thd_list_partitions + id % THD_LIST_PARTITIONS;
+}
 
 ulong max_blocked_pthreads= 0;
 static ulong blocked_pthread_count= 0;
@@ -852,47 +884,156 @@ Sid_map *global_sid_map= NULL;
 Gtid_state *gtid_state= NULL;
 
 /*
-  global_thread_list and waiting_thd_list are both pointers to objects
-  on the heap, to avoid potential problems with running destructors atexit().
+  The sets of the global thread list and waiting_thd_list are pointers to
+  objects on the heap, to avoid potential problems with running destructors
+  atexit().
  */
+static void create_global_thread_list()
+{
+  for (uint i= 0; i < THD_LIST_PARTITIONS; i++)
+    thd_list_partitions[i].threads= new std::set<THD*>;
+  waiting_thd_list= new std::list<THD*>;
+}
+
 static void delete_global_thread_list()
 {
-  delete global_thread_list;
+  for (uint i= 0; i < THD_LIST_PARTITIONS; i++)
+  {
+    delete thd_list_partitions[i].threads;
+    thd_list_partitions[i].threads= NULL;
+  }
   delete waiting_thd_list;
-  global_thread_list= NULL;
   waiting_thd_list= NULL;
 }
 
-Thread_iterator global_thread_list_begin()
+static void init_global_thread_list_locks()
 {
-  mysql_mutex_assert_owner(&LOCK_thread_count);
-  return global_thread_list->begin();
+  for (uint i= 0; i < THD_LIST_PARTITIONS; i++)
+  {
+    Thd_list_partition *part= thd_list_partitions + i;
+    mysql_mutex_init(key_LOCK_thd_list, &part->LOCK_thd_list,
+                     MY_MUTEX_INIT_FAST);
+    mysql_mutex_init(key_LOCK_thd_remove, &part->LOCK_thd_remove,
+                     MY_MUTEX_INIT_FAST);
+    mysql_cond_init(key_COND_thd_list, &part->COND_thd_list, NULL);
+  }
+  my_atomic_rwlock_init(&global_thread_count_lock);
+  my_atomic_rwlock_init(&thread_id_lock);
 }
 
-Thread_iterator global_thread_list_end()
+static void destroy_global_thread_list_locks()
 {
-  mysql_mutex_assert_owner(&LOCK_thread_count);
-  return global_thread_list->end();
+  for (uint i= 0; i < THD_LIST_PARTITIONS; i++)
+  {
+    Thd_list_partition *part= thd_list_partitions + i;
+    mysql_mutex_destroy(&part->LOCK_thd_list);
+    mysql_mutex_destroy(&part->LOCK_thd_remove);
+    mysql_cond_destroy(&part->COND_thd_list);
+  }
+  my_atomic_rwlock_destroy(&global_thread_count_lock);
+  my_atomic_rwlock_destroy(&thread_id_lock);
 }
 
-void copy_global_thread_list(std::set<THD*> *new_copy)
+void do_for_all_thd(Do_THD_Impl *func)
 {
-  mysql_mutex_assert_owner(&LOCK_thd_remove);
-  mysql_mutex_lock(&LOCK_thread_count);
-  *new_copy= *global_thread_list;
-  mysql_mutex_unlock(&LOCK_thread_count);
+  for (uint i= 0; i < THD_LIST_PARTITIONS; i++)
+  {
+    Thd_list_partition *part= thd_list_partitions + i;
+    mysql_mutex_lock(&part->LOCK_thd_list);
+    std::set<THD*>::iterator it= part->threads->begin();
+    for (; it != part->threads->end(); ++it)
+      (*func)(*it);
+    mysql_mutex_unlock(&part->LOCK_thd_list);
+  }
+}
+
+void do_for_all_thd_copy(Do_THD_Impl *func)
+{
+  std::vector<THD*> copy;
+  copy.reserve(get_thread_count());
+  /* The partitions are always locked in the same order */
+  for (uint i= 0; i < THD_LIST_PARTITIONS; i++)
+  {
+    Thd_list_partition *part= thd_list_partitions + i;
+    mysql_mutex_lock(&part->LOCK_thd_remove);
+    mysql_mutex_lock(&part->LOCK_thd_list);
+    copy.insert(copy.end(), part->threads->begin(), part->threads->end());
+    mysql_mutex_unlock(&part->LOCK_thd_list);
+  }
+
+  DEBUG_SYNC(current_thd, "after_copying_threads");
+  std::vector<THD*>::iterator it= copy.begin();
+  for (; it != copy.end(); ++it)
+    (*func)(*it);
+
+  for (uint i= 0; i < THD_LIST_PARTITIONS; i++)
+    mysql_mutex_unlock(&thd_list_partitions[i].LOCK_thd_remove);
+}
+
+/*
+  The THDs searched for are locked by LOCK_thd_data, which must not be
+  acquired while holding LOCK_thd_list, so the partitions are searched
+  while holding their LOCK_thd_remove lock only.
+*/
+
+THD *find_thd(Find_THD_Impl *func)
+{
+  std::vector<THD*> copy;
+  for (uint i= 0; i < THD_LIST_PARTITIONS; i++)
+  {
+    Thd_list_partition *part= thd_list_partitions + i;
+    mysql_mutex_lock(&part->LOCK_thd_remove);
+    mysql_mutex_lock(&part->LOCK_thd_list);
+    copy.assign(part->threads->begin(), part->threads->end());
+    mysql_mutex_unlock(&part->LOCK_thd_list);
+    std::vector<THD*>::iterator it= copy.begin();
+    for (; it != copy.end(); ++it)
+    {
+      if ((*func)(*it))
+      {
+        mysql_mutex_unlock(&part->LOCK_thd_remove);
+        return *it;
+      }
+    }
+    mysql_mutex_unlock(&part->LOCK_thd_remove);
+  }
+  return NULL;
+}
+
+THD *find_thd_with_id(ulong thread_id)
+{
+  Thd_list_partition *part= thd_list_partition(thread_id);
+  THD *thd= NULL;
+  mysql_mutex_lock(&part->LOCK_thd_remove);
+  mysql_mutex_lock(&part->LOCK_thd_list);
+  std::set<THD*>::iterator it= part->threads->begin();
+  for (; it != part->threads->end(); ++it)
+  {
+    if ((*it)->thread_id == thread_id)
+    {
+      thd= *it;
+      break;
+    }
+  }
+  mysql_mutex_unlock(&part->LOCK_thd_list);
+  if (thd)
+    mysql_mutex_lock(&thd->LOCK_thd_data);      // Lock from delete
+  mysql_mutex_unlock(&part->LOCK_thd_remove);
+  return thd;
 }
 
 void add_global_thread(THD *thd)
 {
   DBUG_PRINT("info", ("add_global_thread %p", thd));
-  mysql_mutex_assert_owner(&LOCK_thread_count);
-  const bool have_thread=
-    global_thread_list->find(thd) != global_thread_list->end();
+  Thd_list_partition *part= thd_list_partition(thd->thread_id);
+  mysql_mutex_lock(&part->LOCK_thd_list);
+  const bool have_thread= !part->threads->insert(thd).second;
+  mysql_mutex_unlock(&part->LOCK_thd_list);
   if (!have_thread)
   {
-    ++global_thread_count;
-    global_thread_list->insert(thd);
+    my_atomic_rwlock_wrlock(&global_thread_count_lock);
+    my_atomic_add32(&global_thread_count, 1);
+    my_atomic_rwlock_wrunlock(&global_thread_count_lock);
   }
   // Adding the same THD twice is an error.
   DBUG_ASSERT(!have_thread);
@@ -902,8 +1043,9 @@ void remove_global_thread(THD *thd)
 {
   DBUG_PRINT("info", ("remove_global_thread %p current_linfo %p",
                       thd, thd->current_linfo));
-  mysql_mutex_lock(&LOCK_thd_remove);
-  mysql_mutex_lock(&LOCK_thread_count);
+  Thd_list_partition *part= thd_list_partition(thd->thread_id);
+  mysql_mutex_lock(&part->LOCK_thd_remove);
+  mysql_mutex_lock(&part->LOCK_thd_list);
   DBUG_ASSERT(thd->release_resources_done());
   /*
     Used by binlog_reset_master.  It would be cleaner to use
@@ -913,15 +1055,47 @@ void remove_global_thread(THD *thd)
   DBUG_EXECUTE_IF("sleep_after_lock_thread_count_before_delete_thd",
                   sleep(5););
 
-  const size_t num_erased= global_thread_list->erase(thd);
+  const size_t num_erased= part->threads->erase(thd);
   if (num_erased == 1)
-    --global_thread_count;
+  {
+    my_atomic_rwlock_wrlock(&global_thread_count_lock);
+    my_atomic_add32(&global_thread_count, -1);
+    my_atomic_rwlock_wrunlock(&global_thread_count_lock);
+  }
   // Removing a THD that was never added is an error.
   DBUG_ASSERT(1 == num_erased);
 
-  mysql_mutex_unlock(&LOCK_thd_remove);
-  mysql_cond_broadcast(&COND_thread_count);
-  mysql_mutex_unlock(&LOCK_thread_count);
+  mysql_mutex_unlock(&part->LOCK_thd_remove);
+  mysql_cond_broadcast(&part->COND_thd_list);
+  mysql_mutex_unlock(&part->LOCK_thd_list);
+}
+
+void wait_till_no_thd()
+{
+  for (uint i= 0; i < THD_LIST_PARTITIONS; i++)
+  {
+    Thd_list_partition *part= thd_list_partitions + i;
+    mysql_mutex_lock(&part->LOCK_thd_list);
+    while (!part->threads->empty())
+    {
+      mysql_cond_wait(&part->COND_thd_list, &part->LOCK_thd_list);
+      DBUG_PRINT("quit", ("One thread died (count=%u)", get_thread_count()));
+    }
+    mysql_mutex_unlock(&part->LOCK_thd_list);
+  }
+}
+
+ulong next_thread_id()
+{
+  ulong id;
+  my_atomic_rwlock_wrlock(&thread_id_lock);
+#if SIZEOF_LONG == 8
+  id= (ulong) my_atomic_add64((volatile int64 *) &thread_id, 1);
+#else
+  id= (ulong) my_atomic_add32((volatile int32 *) &thread_id, 1);
+#endif
+  my_atomic_rwlock_wrunlock(&thread_id_lock);
+  return id;
 }
 
 uint get_thread_count()
@@ -1267,6 +1441,8 @@ int deny_severity = LOG_WARNING;
 #endif /* HAVE_LIBWRAP */
 #ifdef HAVE_QUERY_CACHE
 ulong query_cache_min_res_unit= QUERY_CACHE_MIN_RESULT_DATA_SIZE;
+uint query_cache_partitions= 1;
+ulong plan_cache_size= 0;
 my_bool opt_query_cache_strip_comments= FALSE;
 Query_cache query_cache;
 #endif
@@ -1355,6 +1531,112 @@ static void end_ssl();
 ** Code to end mysqld
 ****************************************************************************/
 
+/**
+  Wake up a thread that is told to die, see close_connections().
+*/
+
+static void wake_killed_thread(THD *tmp)
+{
+  mysql_mutex_lock(&tmp->LOCK_thd_data);
+  MYSQL_CALLBACK(thread_scheduler, post_kill_notification, (tmp));
+  if (tmp->mysys_var)
+  {
+    tmp->mysys_var->abort=1;
+    mysql_mutex_lock(&tmp->mysys_var->mutex);
+    if (tmp->mysys_var->current_cond)
+    {
+      mysql_mutex_lock(tmp->mysys_var->current_mutex);
+      mysql_cond_broadcast(tmp->mysys_var->current_cond);
+      mysql_mutex_unlock(tmp->mysys_var->current_mutex);
+    }
+    mysql_mutex_unlock(&tmp->mysys_var->mutex);
+  }
+  mysql_mutex_unlock(&tmp->LOCK_thd_data);
+}
+
+
+/**
+  Tell the client threads that it's time to die, except the slave and the
+  binlog dump threads, which are counted.
+*/
+
+class Call_kill_connection : public Do_THD_Impl
+{
+public:
+  Call_kill_connection() : m_dump_thread_count(0) {}
+
+  virtual void operator()(THD *tmp)
+  {
+    DBUG_PRINT("quit",("Informing thread %ld that it's time to die",
+                       tmp->thread_id));
+    /* We skip slave threads & scheduler on this first loop through. */
+    if (tmp->slave_thread)
+      return;
+    if (tmp->get_command() == COM_BINLOG_DUMP ||
+        tmp->get_command() == COM_BINLOG_DUMP_GTID)
+    {
+      ++m_dump_thread_count;
+      return;
+    }
+    tmp->killed= THD::KILL_CONNECTION;
+    DBUG_EXECUTE_IF("Check_dump_thread_is_alive",
+                    {
+                      DBUG_ASSERT(tmp->get_command() != COM_BINLOG_DUMP &&
+                                  tmp->get_command() != COM_BINLOG_DUMP_GTID);
+                    };);
+    wake_killed_thread(tmp);
+  }
+
+  uint get_dump_thread_count() const { return m_dump_thread_count; }
+
+private:
+  uint m_dump_thread_count;
+};
+
+
+/**
+  Tell the binlog dump threads that it's time to die.
+*/
+
+class Call_kill_dump_thread : public Do_THD_Impl
+{
+public:
+  virtual void operator()(THD *tmp)
+  {
+    DBUG_PRINT("quit",("Informing dump thread %ld that it's time to die",
+                       tmp->thread_id));
+    if (tmp->get_command() == COM_BINLOG_DUMP ||
+        tmp->get_command() == COM_BINLOG_DUMP_GTID)
+    {
+      tmp->killed= THD::KILL_CONNECTION;
+      wake_killed_thread(tmp);
+    }
+  }
+};
+
+
+/**
+  Close the connection of the client threads that are still alive.
+*/
+
+class Call_close_conn : public Do_THD_Impl
+{
+public:
+  virtual void operator()(THD *tmp)
+  {
+    if (tmp->vio_ok())
+    {
+      if (log_warnings)
+        sql_print_warning(ER_DEFAULT(ER_FORCING_CLOSE),my_progname,
+                          tmp->thread_id,
+                          (tmp->main_security_ctx.user ?
+                           tmp->main_security_ctx.user : ""));
+      close_connection(tmp);
+    }
+  }
+};
+
+
 static void close_connections(void)
 {
 #ifdef EXTRA_DEBUG
@@ -1463,46 +1745,9 @@ static void close_connections(void)
   sql_print_information("Giving %d client threads a chance to die gracefully",
                         static_cast<int>(get_thread_count()));
 
-  mysql_mutex_lock(&LOCK_thread_count);
-
-  Thread_iterator it= global_thread_list->begin();
-  for (; it != global_thread_list->end(); ++it)
-  {
-    THD *tmp= *it;
-    DBUG_PRINT("quit",("Informing thread %ld that it's time to die",
-                       tmp->thread_id));
-    /* We skip slave threads & scheduler on this first loop through. */
-    if (tmp->slave_thread)
-      continue;
-    if (tmp->get_command() == COM_BINLOG_DUMP ||
-        tmp->get_command() == COM_BINLOG_DUMP_GTID)
-    {
-      ++dump_thread_count;
-      continue;
-    }
-    tmp->killed= THD::KILL_CONNECTION;
-    DBUG_EXECUTE_IF("Check_dump_thread_is_alive",
-                    {
-                      DBUG_ASSERT(tmp->get_command() != COM_BINLOG_DUMP &&
-                                  tmp->get_command() != COM_BINLOG_DUMP_GTID);
-                    };);
-    mysql_mutex_lock(&tmp->LOCK_thd_data);
-    MYSQL_CALLBACK(thread_scheduler, post_kill_notification, (tmp));
-    if (tmp->mysys_var)
-    {
-      tmp->mysys_var->abort=1;
-      mysql_mutex_lock(&tmp->mysys_var->mutex);
-      if (tmp->mysys_var->current_cond)
-      {
-        mysql_mutex_lock(tmp->mysys_var->current_mutex);
-        mysql_cond_broadcast(tmp->mysys_var->current_cond);
-        mysql_mutex_unlock(tmp->mysys_var->current_mutex);
-      }
-      mysql_mutex_unlock(&tmp->mysys_var->mutex);
-    }
-    mysql_mutex_unlock(&tmp->LOCK_thd_data);
-  }
-  mysql_mutex_unlock(&LOCK_thread_count);
+  Call_kill_connection kill_connections;
+  do_for_all_thd(&kill_connections);
+  dump_thread_count= kill_connections.get_dump_thread_count();
 
   Events::deinit();
 
@@ -1520,34 +1765,8 @@ static void close_connections(void)
       sleep(1);
       dump_thread_kill_retries--;
     }
-    mysql_mutex_lock(&LOCK_thread_count);
-    for (it= global_thread_list->begin(); it != global_thread_list->end(); ++it)
-    {
-      THD *tmp= *it;
-      DBUG_PRINT("quit",("Informing dump thread %ld that it's time to die",
-                         tmp->thread_id));
-      if (tmp->get_command() == COM_BINLOG_DUMP ||
-          tmp->get_command() == COM_BINLOG_DUMP_GTID)
-      {
-        tmp->killed= THD::KILL_CONNECTION;
-        mysql_mutex_lock(&tmp->LOCK_thd_data);
-        MYSQL_CALLBACK(thread_scheduler, post_kill_notification, (tmp));
-        if (tmp->mysys_var)
-        {
-          tmp->mysys_var->abort= 1;
-          mysql_mutex_lock(&tmp->mysys_var->mutex);
-          if (tmp->mysys_var->current_cond)
-          {
-            mysql_mutex_lock(tmp->mysys_var->current_mutex);
-            mysql_cond_broadcast(tmp->mysys_var->current_cond);
-            mysql_mutex_unlock(tmp->mysys_var->current_mutex);
-          }
-          mysql_mutex_unlock(&tmp->mysys_var->mutex);
-        }
-        mysql_mutex_unlock(&tmp->LOCK_thd_data);
-      }
-    }
-    mysql_mutex_unlock(&LOCK_thread_count);
+    Call_kill_dump_thread kill_dump_threads;
+    do_for_all_thd(&kill_dump_threads);
   }
   if (get_thread_count() > 0)
     sleep(2);         // Give threads time to die
@@ -1562,35 +1781,14 @@ static void close_connections(void)
                         static_cast<int>(get_thread_count()));
 
 #ifndef __bsdi__ // Bug in BSDI kernel
-  DBUG_PRINT("quit", ("Locking LOCK_thread_count"));
-  mysql_mutex_lock(&LOCK_thread_count);
-  for (it= global_thread_list->begin(); it != global_thread_list->end(); ++it)
-  {
-    THD *tmp= *it;
-    if (tmp->vio_ok())
-    {
-      if (log_warnings)
-        sql_print_warning(ER_DEFAULT(ER_FORCING_CLOSE),my_progname,
-                          tmp->thread_id,
-                          (tmp->main_security_ctx.user ?
-                           tmp->main_security_ctx.user : ""));
-      close_connection(tmp);
-    }
-  }
-  DBUG_PRINT("quit",("Unlocking LOCK_thread_count"));
-  mysql_mutex_unlock(&LOCK_thread_count);
+  Call_close_conn close_conn;
+  do_for_all_thd(&close_conn);
 #endif // Bug in BSDI kernel
 
   /* All threads has now been aborted */
   DBUG_PRINT("quit",("Waiting for threads to die (count=%u)",
                      get_thread_count()));
-  mysql_mutex_lock(&LOCK_thread_count);
-  while (get_thread_count() > 0)
-  {
-    mysql_cond_wait(&COND_thread_count, &LOCK_thread_count);
-    DBUG_PRINT("quit", ("One thread died (count=%u)", get_thread_count()));
-  }
-  mysql_mutex_unlock(&LOCK_thread_count);
+  wait_till_no_thd();
 
   close_active_mi();
   DBUG_PRINT("quit",("close_connections thread"));
@@ -1930,6 +2128,7 @@ void clean_up(bool print_message)
   grant_free();
 #endif
   query_cache_destroy();
+  plan_cache.destroy();
   hostname_cache_free();
   item_func_sleep_free();
   lex_free();       /* Free some memory */
@@ -2085,7 +2284,8 @@ static void clean_up_mutexes()
   mysql_mutex_destroy(&LOCK_slave_net_timeout);
   mysql_mutex_destroy(&LOCK_error_messages);
   mysql_cond_destroy(&COND_thread_count);
-  mysql_mutex_destroy(&LOCK_thd_remove);
+  destroy_global_thread_list_locks();
+  mysql_mutex_destroy(&LOCK_thread_cache);
   mysql_cond_destroy(&COND_thread_cache);
   mysql_cond_destroy(&COND_flush_thread_cache);
   mysql_cond_destroy(&COND_manager);
@@ -2948,7 +3148,7 @@ void destroy_thd(THD *thd)
 
 static bool block_until_new_connection()
 {
-  mysql_mutex_lock(&LOCK_thread_count);
+  mysql_mutex_lock(&LOCK_thread_cache);
   if (blocked_pthread_count < max_blocked_pthreads &&
       !abort_loop && !kill_blocked_pthreads_flag)
   {
@@ -2966,7 +3166,7 @@ static bool block_until_new_connection()
 
     // Block pthread
     while (!abort_loop && !wake_pthread && !kill_blocked_pthreads_flag)
-      mysql_cond_wait(&COND_thread_cache, &LOCK_thread_count);
+      mysql_cond_wait(&COND_thread_cache, &LOCK_thread_cache);
 
     blocked_pthread_count--;
     if (kill_blocked_pthreads_flag)
@@ -3000,12 +3200,12 @@ static bool block_until_new_connection()
       */
       thd->mysys_var->abort= 0;
       thd->thr_create_utime= thd->start_utime= my_micro_time();
+      mysql_mutex_unlock(&LOCK_thread_cache);
       add_global_thread(thd);
-      mysql_mutex_unlock(&LOCK_thread_count);
       return true;
     }
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
+  mysql_mutex_unlock(&LOCK_thread_cache);
   return false;
 }
 
@@ -3073,15 +3273,15 @@ bool one_thread_per_connection_end(THD *thd, bool block_pthread)
 
 void kill_blocked_pthreads()
 {
-  mysql_mutex_lock(&LOCK_thread_count);
+  mysql_mutex_lock(&LOCK_thread_cache);
   kill_blocked_pthreads_flag++;
   while (blocked_pthread_count)
   {
     mysql_cond_broadcast(&COND_thread_cache);
-    mysql_cond_wait(&COND_flush_thread_cache, &LOCK_thread_count);
+    mysql_cond_wait(&COND_flush_thread_cache, &LOCK_thread_cache);
   }
   kill_blocked_pthreads_flag--;
-  mysql_mutex_unlock(&LOCK_thread_count);
+  mysql_mutex_unlock(&LOCK_thread_cache);
 }
 
 
@@ -4482,8 +4682,9 @@ static int init_thread_environment()
                    &LOCK_thread_created, MY_MUTEX_INIT_FAST);
   mysql_mutex_init(key_LOCK_thread_count, &LOCK_thread_count, MY_MUTEX_INIT_FAST);
   mysql_mutex_init(key_LOCK_status, &LOCK_status, MY_MUTEX_INIT_FAST);
-  mysql_mutex_init(key_LOCK_thd_remove,
-                   &LOCK_thd_remove, MY_MUTEX_INIT_FAST);
+  init_global_thread_list_locks();
+  mysql_mutex_init(key_LOCK_thread_cache,
+                   &LOCK_thread_cache, MY_MUTEX_INIT_FAST);
   mysql_mutex_init(key_LOCK_delayed_insert,
                    &LOCK_delayed_insert, MY_MUTEX_INIT_FAST);
   mysql_mutex_init(key_LOCK_delayed_status,
@@ -4916,7 +5117,8 @@ static int init_server_components()
     all things are initialized so that unireg_abort() doesn't fail
   */
   mdl_init();
-  if (table_def_init() | hostname_cache_init(host_cache_size))
+  if (table_def_init() | hostname_cache_init(host_cache_size) |
+      plan_cache.init())
     unireg_abort(1);
 
 #ifdef HAVE_MY_TIMER
@@ -5149,6 +5351,15 @@ a file name for --log-bin-index option", opt_binlog_index_name);
 
   /* call ha_init_key_cache() on all key caches to init them */
   process_key_caches(&ha_init_key_cache);
+  mysql_mutex_lock(&LOCK_global_system_variables);
+  bool key_cache_error= update_internal_tmp_disk_key_cache();
+  mysql_mutex_unlock(&LOCK_global_system_variables);
+  if (key_cache_error)
+  {
+    sql_print_error("Could not create the key cache for internal "
+                    "temporary tables");
+    unireg_abort(1);
+  }
 
   /* Allow storage engine to give real error messages */
   if (ha_init_errors())
@@ -6333,7 +6544,7 @@ static void bootstrap(MYSQL_FILE *file)
   my_net_init(&thd->net,(st_vio*) 0);
   thd->max_client_packet_length= thd->net.max_packet;
   thd->security_ctx->master_access= ~(ulong)0;
-  thd->thread_id= thd->variables.pseudo_thread_id= thread_id++;
+  thd->thread_id= thd->variables.pseudo_thread_id= next_thread_id();
 
   in_bootstrap= TRUE;
 
@@ -6405,16 +6616,12 @@ void inc_thread_created(void)
    NOTES
      This is only used for debugging, when starting mysqld with
      --thread-handling=no-threads or --one-thread
-
-     When we enter this function, LOCK_thread_count is held!
 */
 
 void handle_connection_in_main_thread(THD *thd)
 {
-  mysql_mutex_assert_owner(&LOCK_thread_count);
   max_blocked_pthreads= 0;      // Safety
   add_global_thread(thd);
-  mysql_mutex_unlock(&LOCK_thread_count);
   thd->start_utime= my_micro_time();
   do_handle_one_connection(thd);
 }
@@ -6426,7 +6633,7 @@ void handle_connection_in_main_thread(THD *thd)
 
 void create_thread_to_handle_connection(THD *thd)
 {
-  mysql_mutex_assert_owner(&LOCK_thread_count);
+  mysql_mutex_lock(&LOCK_thread_cache);
   if (blocked_pthread_count >  wake_pthread)
   {
     /* Wake up blocked pthread */
@@ -6434,15 +6641,19 @@ void create_thread_to_handle_connection(THD *thd)
     waiting_thd_list->push_back(thd);
     wake_pthread++;
     mysql_cond_signal(&COND_thread_cache);
+    mysql_mutex_unlock(&LOCK_thread_cache);
   }
   else
   {
+    mysql_mutex_unlock(&LOCK_thread_cache);
     char error_message_buff[MYSQL_ERRMSG_SIZE];
     /* Create new thread to handle connection */
     int error;
     inc_thread_created();
     DBUG_PRINT("info",(("creating thread %lu"), thd->thread_id));
     thd->prior_thr_create_utime= thd->start_utime= my_micro_time();
+    /* The new thread removes the THD when the connection ends */
+    add_global_thread(thd);
     if ((error= mysql_thread_create(key_thread_one_connection,
                                     &thd->real_id, &connection_attrib,
                                     handle_one_connection,
@@ -6456,7 +6667,6 @@ void create_thread_to_handle_connection(THD *thd)
         sql_print_error("Can't create thread to handle request (errno= %d)",
                         error);
       thd->killed= THD::KILL_CONNECTION;      // Safety
-      mysql_mutex_unlock(&LOCK_thread_count);
 
       mysql_mutex_lock(&LOCK_connection_count);
       --connection_count;
@@ -6469,13 +6679,13 @@ void create_thread_to_handle_connection(THD *thd)
                   ER_THD(thd, ER_CANT_CREATE_THREAD), error);
       net_send_error(thd, ER_CANT_CREATE_THREAD, error_message_buff, NULL);
       close_connection(thd);
+      thd->release_resources();
+      remove_global_thread(thd);
       delete thd;
       return;
       /* purecov: end */
     }
-    add_global_thread(thd);
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
   DBUG_PRINT("info",("Thread created"));
 }
 
@@ -6541,14 +6751,12 @@ static void create_new_thread(THD *thd)
 
   /* Start a new thread to handle connection. */
 
-  mysql_mutex_lock(&LOCK_thread_count);
-
   /*
     The initialization of thread_id is done in create_embedded_thd() for
     the embedded library.
     TODO: refactor this to avoid code duplication there
   */
-  thd->thread_id= thd->variables.pseudo_thread_id= thread_id++;
+  thd->thread_id= thd->variables.pseudo_thread_id= next_thread_id();
 
   MYSQL_CALLBACK(thd->scheduler, add_connection, (thd));
 
@@ -7933,6 +8141,41 @@ static int show_open_tables(THD *thd, SHOW_VAR *var, char *buff)
   return 0;
 }
 
+#ifdef HAVE_QUERY_CACHE
+/*
+  The gauges of the query cache are summed over its partitions, the
+  flushable counters are kept in the query_cache object itself.
+*/
+static int show_qcache_statistic(SHOW_VAR *var, char *buff,
+                                 ulong Query_cache::*statistic)
+{
+  var->type= SHOW_LONG;
+  var->value= buff;
+  *((long *)buff)= (long) query_cache.get_statistic(statistic);
+  return 0;
+}
+
+static int show_qcache_free_blocks(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_statistic(var, buff, &Query_cache::free_memory_blocks);
+}
+
+static int show_qcache_free_memory(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_statistic(var, buff, &Query_cache::free_memory);
+}
+
+static int show_qcache_queries_in_cache(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_statistic(var, buff, &Query_cache::queries_in_cache);
+}
+
+static int show_qcache_total_blocks(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_qcache_statistic(var, buff, &Query_cache::total_blocks);
+}
+#endif /* HAVE_QUERY_CACHE */
+
 static int show_prepared_stmt_count(THD *thd, SHOW_VAR *var, char *buff)
 {
   var->type= SHOW_LONG;
@@ -8391,16 +8634,19 @@ SHOW_VAR status_vars[]= {
   {"Opened_files",             (char*) &my_file_total_opened, SHOW_LONG_NOFLUSH},
   {"Opened_tables",            (char*) offsetof(STATUS_VAR, opened_tables), SHOW_LONGLONG_STATUS},
   {"Opened_table_definitions", (char*) offsetof(STATUS_VAR, opened_shares), SHOW_LONGLONG_STATUS},
+  {"Plan_cache_entries",       (char*) &plan_cache.entries,     SHOW_LONG_NOFLUSH},
+  {"Plan_cache_hits",          (char*) &plan_cache.hits,        SHOW_LONG},
+  {"Plan_cache_misses",        (char*) &plan_cache.misses,      SHOW_LONG},
   {"Prepared_stmt_count",      (char*) &show_prepared_stmt_count, SHOW_FUNC},
 #ifdef HAVE_QUERY_CACHE
-  {"Qcache_free_blocks",       (char*) &query_cache.free_memory_blocks, SHOW_LONG_NOFLUSH},
-  {"Qcache_free_memory",       (char*) &query_cache.free_memory, SHOW_LONG_NOFLUSH},
+  {"Qcache_free_blocks",       (char*) &show_qcache_free_blocks, SHOW_FUNC},
+  {"Qcache_free_memory",       (char*) &show_qcache_free_memory, SHOW_FUNC},
   {"Qcache_hits",              (char*) &query_cache.hits,       SHOW_LONG},
   {"Qcache_inserts",           (char*) &query_cache.inserts,    SHOW_LONG},
   {"Qcache_lowmem_prunes",     (char*) &query_cache.lowmem_prunes, SHOW_LONG},
   {"Qcache_not_cached",        (char*) &query_cache.refused,    SHOW_LONG},
-  {"Qcache_queries_in_cache",  (char*) &query_cache.queries_in_cache, SHOW_LONG_NOFLUSH},
-  {"Qcache_total_blocks",      (char*) &query_cache.total_blocks, SHOW_LONG_NOFLUSH},
+  {"Qcache_queries_in_cache",  (char*) &show_qcache_queries_in_cache, SHOW_FUNC},
+  {"Qcache_total_blocks",      (char*) &show_qcache_total_blocks, SHOW_FUNC},
 #endif /*HAVE_QUERY_CACHE*/
   {"Queries",                  (char*) &show_queries,            SHOW_FUNC},
   {"Questions",                (char*) offsetof(STATUS_VAR, questions), SHOW_LONGLONG_STATUS},
@@ -8685,8 +8931,7 @@ static int mysql_init_variables(void)
   my_atomic_rwlock_init(&global_query_id_lock);
   my_atomic_rwlock_init(&thread_running_lock);
   strmov(server_version, MYSQL_SERVER_VERSION);
-  global_thread_list= new std::set<THD*>;
-  waiting_thd_list= new std::list<THD*>;
+  create_global_thread_list();
   key_caches.empty();
   if (!(dflt_key_cache= get_or_create_key_cache(default_key_cache_base.str,
                                                 default_key_cache_base.length)))
@@ -9892,7 +10137,7 @@ PSI_mutex_key
   key_structure_guard_mutex, key_TABLE_SHARE_LOCK_ha_data,
   key_LOCK_error_messages, key_LOG_INFO_lock, key_LOCK_thread_count,
   key_LOCK_log_throttle_qni;
-PSI_mutex_key key_LOCK_thd_remove;
+PSI_mutex_key key_LOCK_thd_remove, key_LOCK_thd_list, key_LOCK_thread_cache;
 PSI_mutex_key key_RELAYLOG_LOCK_commit;
 PSI_mutex_key key_RELAYLOG_LOCK_commit_queue;
 PSI_mutex_key key_RELAYLOG_LOCK_done;
@@ -9986,7 +10231,9 @@ static PSI_mutex_info all_server_mutexes[]=
   { &key_LOCK_error_messages, "LOCK_error_messages", PSI_FLAG_GLOBAL},
   { &key_LOG_INFO_lock, "LOG_INFO::lock", 0},
   { &key_LOCK_thread_count, "LOCK_thread_count", PSI_FLAG_GLOBAL},
-  { &key_LOCK_thd_remove, "LOCK_thd_remove", PSI_FLAG_GLOBAL},
+  { &key_LOCK_thd_remove, "LOCK_thd_remove", 0},
+  { &key_LOCK_thd_list, "LOCK_thd_list", 0},
+  { &key_LOCK_thread_cache, "LOCK_thread_cache", PSI_FLAG_GLOBAL},
   { &key_LOCK_log_throttle_qni, "LOCK_log_throttle_qni", PSI_FLAG_GLOBAL},
   { &key_gtid_ensure_index_mutex, "Gtid_state", PSI_FLAG_GLOBAL},
   { &key_LOCK_thread_created, "LOCK_thread_created", PSI_FLAG_GLOBAL }
@@ -10042,6 +10289,7 @@ PSI_cond_key key_BINLOG_update_cond,
   key_cond_slave_parallel_worker,
   key_TABLE_SHARE_cond, key_user_level_lock_cond,
   key_COND_thread_count, key_COND_thread_cache, key_COND_flush_thread_cache;
+PSI_cond_key key_COND_thd_list;
 PSI_cond_key key_RELAYLOG_update_cond;
 PSI_cond_key key_BINLOG_COND_done;
 PSI_cond_key key_RELAYLOG_COND_done;
@@ -10086,12 +10334,13 @@ static PSI_cond_info all_server_conds[]=
   { &key_user_level_lock_cond, "User_level_lock::cond", 0},
   { &key_COND_thread_count, "COND_thread_count", PSI_FLAG_GLOBAL},
   { &key_COND_thread_cache, "COND_thread_cache", PSI_FLAG_GLOBAL},
+  { &key_COND_thd_list, "COND_thd_list", 0},
   { &key_COND_flush_thread_cache, "COND_flush_thread_cache", PSI_FLAG_GLOBAL},
   { &key_gtid_ensure_index_cond, "Gtid_state", PSI_FLAG_GLOBAL}
 };
 
 PSI_thread_key key_thread_bootstrap, key_thread_delayed_insert,
-  key_thread_handle_manager, key_thread_main,
+  key_thread_filesort, key_thread_handle_manager, key_thread_main,
   key_thread_one_connection, key_thread_signal_hand;
 
 static PSI_thread_info all_server_threads[]=
@@ -10114,6 +10363,7 @@ static PSI_thread_info all_server_threads[]=
 
   { &key_thread_bootstrap, "bootstrap", PSI_FLAG_GLOBAL},
   { &key_thread_delayed_insert, "delayed_insert", 0},
+  { &key_thread_filesort, "filesort", 0},
   { &key_thread_handle_manager, "manager", PSI_FLAG_GLOBAL},
   { &key_thread_main, "main", PSI_FLAG_GLOBAL},
   { &key_thread_one_connection, "one_connection", 0},
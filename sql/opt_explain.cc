@@ -1586,7 +1586,9 @@ bool Explain_join::explain_extra()
     if (tabnum > 0 && tab->use_join_cache != JOIN_CACHE::ALG_NONE)
     {
       StringBuffer<64> buff(cs);
-      if ((tab->use_join_cache & JOIN_CACHE::ALG_BNL))
+      if ((tab->use_join_cache & JOIN_CACHE::ALG_BNLH))
+        buff.append("Hash Join");
+      else if ((tab->use_join_cache & JOIN_CACHE::ALG_BNL))
         buff.append("Block Nested Loop");
       else if ((tab->use_join_cache & JOIN_CACHE::ALG_BKA))
         buff.append("Batched Key Access");
@@ -2100,32 +2100,40 @@ String *get_slave_uuid(THD *thd, String *value)
 */
 
 
-void kill_zombie_dump_threads(String *slave_uuid)
+class Find_zombie_dump_thread : public Find_THD_Impl
 {
-  if (slave_uuid->length() == 0)
-    return;
-  DBUG_ASSERT(slave_uuid->length() == UUID_LENGTH);
+public:
+  Find_zombie_dump_thread(String *value) : m_slave_uuid(value) {}
 
-  mysql_mutex_lock(&LOCK_thread_count);
-  THD *tmp= NULL;
-  Thread_iterator it= global_thread_list_begin();
-  Thread_iterator end= global_thread_list_end();
-  for (; it != end; ++it)
+  virtual bool operator()(THD *thd)
   {
-    if ((*it) != current_thd && ((*it)->get_command() == COM_BINLOG_DUMP ||
-                                 (*it)->get_command() == COM_BINLOG_DUMP_GTID))
+    if (thd != current_thd && (thd->get_command() == COM_BINLOG_DUMP ||
+                               thd->get_command() == COM_BINLOG_DUMP_GTID))
     {
       String tmp_uuid;
-      if (get_slave_uuid((*it), &tmp_uuid) != NULL &&
-          !strncmp(slave_uuid->c_ptr(), tmp_uuid.c_ptr(), UUID_LENGTH))
+      if (get_slave_uuid(thd, &tmp_uuid) != NULL &&
+          !strncmp(m_slave_uuid->c_ptr(), tmp_uuid.c_ptr(), UUID_LENGTH))
       {
-        tmp= *it;
-        mysql_mutex_lock(&tmp->LOCK_thd_data);	// Lock from delete
-        break;
+        mysql_mutex_lock(&thd->LOCK_thd_data);	// Lock from delete
+        return true;
       }
     }
+    return false;
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
+
+private:
+  String *m_slave_uuid;
+};
+
+
+void kill_zombie_dump_threads(String *slave_uuid)
+{
+  if (slave_uuid->length() == 0)
+    return;
+  DBUG_ASSERT(slave_uuid->length() == UUID_LENGTH);
+
+  Find_zombie_dump_thread find_zombie_dump_thread(slave_uuid);
+  THD *tmp= find_thd(&find_zombie_dump_thread);
   if (tmp)
   {
     /*
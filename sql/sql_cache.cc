@@ -1064,6 +1064,24 @@ uchar *query_cache_query_get_key(const uchar *record, size_t *length,
 */
 
 
+/**
+  Add to one of the statistics that can be reset with FLUSH STATUS.
+
+  The partitions of the query cache count them together in the global
+  query_cache object without sharing a lock, so they are updated
+  atomically.
+*/
+
+static inline void add_statistic(ulong *var, long delta)
+{
+#if SIZEOF_LONG == 8
+  my_atomic_add64((volatile int64 *) var, (int64) delta);
+#else
+  my_atomic_add32((volatile int32 *) var, (int32) delta);
+#endif
+}
+
+
 /**
   libmysql convenience wrapper to insert data into query cache.
 */
@@ -1103,6 +1121,13 @@ Query_cache::insert(Query_cache_tls *query_cache_tls,
   if (is_disabled() || query_cache_tls->first_query_block == NULL)
     DBUG_VOID_RETURN;
 
+  if (m_partitions)
+  {
+    query_cache_tls->partition->insert(query_cache_tls, packet, length,
+                                       pkt_nr);
+    DBUG_VOID_RETURN;
+  }
+
   QC_DEBUG_SYNC("wait_in_query_cache_insert");
 
   if (try_lock())
@@ -1137,8 +1162,8 @@ Query_cache::insert(Query_cache_tls *query_cache_tls,
     header->result(result);
     DBUG_PRINT("qcache", ("free query 0x%lx", (ulong) query_block));
     // The following call will remove the lock on query_block
-    query_cache.free_query(query_block);
-    query_cache.refused++;
+    free_query(query_block);
+    add_statistic(&m_global->refused, 1);
     // append_result_data no success => we need unlock
     unlock();
     DBUG_VOID_RETURN;
@@ -1163,6 +1188,12 @@ Query_cache::abort(Query_cache_tls *query_cache_tls)
   if (is_disabled() || query_cache_tls->first_query_block == NULL)
     DBUG_VOID_RETURN;
 
+  if (m_partitions)
+  {
+    query_cache_tls->partition->abort(query_cache_tls);
+    DBUG_VOID_RETURN;
+  }
+
   if (try_lock())
     DBUG_VOID_RETURN;
 
@@ -1199,6 +1230,12 @@ void Query_cache::end_of_result(THD *thd)
   if (query_cache_tls->first_query_block == NULL)
     DBUG_VOID_RETURN;
 
+  if (m_partitions)
+  {
+    query_cache_tls->partition->end_of_result(thd);
+    DBUG_VOID_RETURN;
+  }
+
   if (thd->killed || thd->is_error())
   {
     query_cache_abort(&thd->query_cache_tls);
@@ -1248,9 +1285,9 @@ void Query_cache::end_of_result(THD *thd)
     }
     last_result_block= header->result()->prev;
     allign_size= ALIGN_SIZE(last_result_block->used);
-    len= max(query_cache.min_allocation_unit, allign_size);
-    if (last_result_block->length >= query_cache.min_allocation_unit + len)
-      query_cache.split_block(last_result_block,len);
+    len= max(min_allocation_unit, allign_size);
+    if (last_result_block->length >= min_allocation_unit + len)
+      split_block(last_result_block,len);
 
     header->found_rows(limit_found_rows);
     header->result()->type= Query_cache_block::RESULT;
@@ -1298,6 +1335,7 @@ Query_cache::Query_cache(ulong query_cache_limit_arg,
    query_cache_limit(query_cache_limit_arg),
    queries_in_cache(0), hits(0), inserts(0), refused(0),
    total_blocks(0), lowmem_prunes(0), m_query_cache_is_disabled(FALSE),
+   m_partitions(NULL), m_partition_count(0), m_global(this),
    min_allocation_unit(ALIGN_SIZE(min_allocation_unit_arg)),
    min_result_data_size(ALIGN_SIZE(min_result_data_size_arg)),
    def_query_hash_size(ALIGN_SIZE(def_query_hash_size_arg)),
@@ -1310,6 +1348,97 @@ Query_cache::Query_cache(ulong query_cache_limit_arg,
   set_if_bigger(min_allocation_unit,min_needed);
   this->min_allocation_unit= ALIGN_SIZE(min_allocation_unit);
   set_if_bigger(this->min_result_data_size,min_allocation_unit);
+  memset(m_table_filter, 0, sizeof(m_table_filter));
+}
+
+
+/**
+  Choose the partition that caches a query
+
+  @param thd     thread handle
+  @param query   text of the query
+  @param length  length of the query
+
+  @note The partition is chosen by the text of the query as it was
+        received, not by the query cache key, so that no lock is needed.
+        Queries that only differ in comments stripped by
+        query_cache_strip_comments may therefore be cached separately.
+*/
+
+Query_cache *Query_cache::get_partition(THD *thd, const char *query,
+                                        size_t length)
+{
+  ulong nr1= 1, nr2= 4;
+  my_charset_bin.coll->hash_sort(&my_charset_bin, (const uchar *) query,
+                                 length, &nr1, &nr2);
+  if (thd->db_length)
+    my_charset_bin.coll->hash_sort(&my_charset_bin, (const uchar *) thd->db,
+                                   thd->db_length, &nr1, &nr2);
+  return m_partitions + nr1 % m_partition_count;
+}
+
+
+static inline uint table_filter_bit(const uchar *key, uint32 key_length)
+{
+  ulong nr1= 1, nr2= 4;
+  my_charset_bin.coll->hash_sort(&my_charset_bin, key, key_length,
+                                 &nr1, &nr2);
+  return (uint) (nr1 % QUERY_CACHE_TABLE_FILTER_BITS);
+}
+
+
+/**
+  Note that a query using the table is registered in this partition.
+
+  @pre structure_guard_mutex is locked, so there are no concurrent
+       writers of the filter.
+*/
+
+void Query_cache::add_to_table_filter(const char *key, uint32 key_length)
+{
+  uint bit= table_filter_bit((const uchar *) key, key_length);
+  int32 *word= m_table_filter + bit / 32;
+  int32 mask= (int32) (1U << (bit % 32));
+  int32 value= my_atomic_load32(word);
+  if (!(value & mask))
+    my_atomic_store32(word, value | mask);
+}
+
+
+/**
+  Check without locking whether the partition may have queries using a
+  table. A false answer is reliable, since the bit of the table is set
+  before the query is registered.
+*/
+
+bool Query_cache::may_have_table(const uchar *key, uint32 key_length)
+{
+  uint bit= table_filter_bit(key, key_length);
+  return my_atomic_load32(m_table_filter + bit / 32) & (1U << (bit % 32));
+}
+
+
+void Query_cache::clear_table_filter()
+{
+  for (uint i= 0; i < array_elements(m_table_filter); i++)
+    my_atomic_store32(m_table_filter + i, 0);
+}
+
+
+/**
+  Sum of a statistics variable of the partitions, or the variable of the
+  cache itself if it is not partitioned. Like the variables themselves,
+  the sum is read without locking.
+*/
+
+ulong Query_cache::get_statistic(ulong Query_cache::*var)
+{
+  if (!m_partitions)
+    return this->*var;
+  ulong sum= 0;
+  for (uint i= 0; i < m_partition_count; i++)
+    sum+= m_partitions[i].*var;
+  return sum;
 }
 
 
@@ -1321,6 +1450,17 @@ ulong Query_cache::resize(ulong query_cache_size_arg)
 			query_cache_size_arg));
   DBUG_ASSERT(initialized);
 
+  if (m_partitions)
+  {
+    /* Every partition gets an equal share of the memory */
+    new_query_cache_size= 0;
+    for (uint i= 0; i < m_partition_count; i++)
+      new_query_cache_size+=
+        m_partitions[i].resize(query_cache_size_arg / m_partition_count);
+    query_cache_size= new_query_cache_size;
+    DBUG_RETURN(new_query_cache_size);
+  }
+
   lock_and_suspend();
 
   /*
@@ -1342,7 +1482,7 @@ ulong Query_cache::resize(ulong query_cache_size_arg)
          */
         query->writer()->first_query_block= NULL;
         query->writer(0);
-        refused++;
+        add_statistic(&m_global->refused, 1);
       }
       query->unlock_n_destroy();
       block= block->next;
@@ -1365,6 +1505,8 @@ ulong Query_cache::set_min_res_unit(ulong size)
 {
   if (size < min_allocation_unit)
     size= min_allocation_unit;
+  for (uint i= 0; i < m_partition_count; i++)
+    m_partitions[i].set_min_res_unit(size);
   return (min_result_data_size= ALIGN_SIZE(size));
 }
 
@@ -1396,6 +1538,13 @@ void Query_cache::store_query(THD *thd, TABLE_LIST *tables_used)
     DBUG_VOID_RETURN;
 #endif
 
+  if (m_partitions)
+  {
+    get_partition(thd, thd->query(), thd->query_length())->
+      store_query(thd, tables_used);
+    DBUG_VOID_RETURN;
+  }
+
   uint8 tables_type= 0;
 
   if ((local_tables= is_cacheable(thd, thd->query_length(),
@@ -1489,7 +1638,7 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
 
     if (ask_handler_allowance(thd, tables_used))
     {
-      refused++;
+      add_statistic(&m_global->refused, 1);
       unlock();
       DBUG_VOID_RETURN;
     }
@@ -1537,7 +1686,7 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
 	header->init_n_lock();
 	if (my_hash_insert(&queries, (uchar*) query_block))
 	{
-	  refused++;
+	  add_statistic(&m_global->refused, 1);
 	  DBUG_PRINT("qcache", ("insertion in query hash"));
 	  header->unlock_n_destroy();
 	  free_memory_block(query_block);
@@ -1546,7 +1695,7 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
 	}
 	if (!register_all_tables(query_block, tables_used, local_tables))
 	{
-	  refused++;
+	  add_statistic(&m_global->refused, 1);
 	  DBUG_PRINT("warning", ("tables list including failed"));
 	  my_hash_delete(&queries, (uchar *) query_block);
 	  header->unlock_n_destroy();
@@ -1555,9 +1704,10 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
 	  goto end;
 	}
 	double_linked_list_simple_include(query_block, &queries_blocks);
-	inserts++;
+	add_statistic(&m_global->inserts, 1);
 	queries_in_cache++;
 	thd->query_cache_tls.first_query_block= query_block;
+	thd->query_cache_tls.partition= this;
 	header->writer(&thd->query_cache_tls);
 	header->tables_type(tables_type);
 
@@ -1569,7 +1719,7 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
       else
       {
 	// We have not enough memory to store query => do nothing
-	refused++;
+	add_statistic(&m_global->refused, 1);
         unlock();
 	DBUG_PRINT("warning", ("Can't allocate query"));
       }
@@ -1577,13 +1727,13 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
     else
     {
       // Another thread is processing the same query => do nothing
-      refused++;
+      add_statistic(&m_global->refused, 1);
       unlock();
       DBUG_PRINT("qcache", ("Another thread process same query"));
     }
   }
   else if (thd->lex->sql_command == SQLCOM_SELECT)
-    statistic_increment(refused, &structure_guard_mutex);
+    add_statistic(&m_global->refused, 1);
 
 end:
   DBUG_VOID_RETURN;
@@ -1678,6 +1828,10 @@ Query_cache::send_result_to_client(THD *thd, char *sql, uint query_length)
   enum xa_states xa_state= thd->transaction.xid_state.xa_state;
   DBUG_ENTER("Query_cache::send_result_to_client");
 
+  if (m_partitions)
+    DBUG_RETURN(get_partition(thd, sql, query_length)->
+                send_result_to_client(thd, sql, query_length));
+
   /*
     Testing 'query_cache_size' without a lock here is safe: the thing
     we may loose is that the query won't be served from cache, but we
@@ -2080,7 +2234,7 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
 			    table_list.db, table_list.alias));
   }
   move_to_query_list_end(query_block);
-  hits++;
+  add_statistic(&m_global->hits, 1);
   unlock();
 
   /*
@@ -2281,6 +2435,13 @@ void Query_cache::invalidate(char *db)
   if (is_disabled())
     DBUG_VOID_RETURN;
 
+  if (m_partitions)
+  {
+    for (uint i= 0; i < m_partition_count; i++)
+      m_partitions[i].invalidate(db);
+    DBUG_VOID_RETURN;
+  }
+
   bool restart= FALSE;
   /*
     Lock the query cache and queue all invalidation attempts to avoid
@@ -2369,6 +2530,13 @@ void Query_cache::flush()
   if (is_disabled())
     DBUG_VOID_RETURN;
 
+  if (m_partitions)
+  {
+    for (uint i= 0; i < m_partition_count; i++)
+      m_partitions[i].flush();
+    DBUG_VOID_RETURN;
+  }
+
   QC_DEBUG_SYNC("wait_in_query_cache_flush1");
 
   lock_and_suspend();
@@ -2379,7 +2547,7 @@ void Query_cache::flush()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   unlock();
   DBUG_VOID_RETURN;
 }
@@ -2402,6 +2570,13 @@ void Query_cache::pack(ulong join_limit, uint iteration_limit)
   if (is_disabled())
     DBUG_VOID_RETURN;
 
+  if (m_partitions)
+  {
+    for (uint i= 0; i < m_partition_count; i++)
+      m_partitions[i].pack(join_limit, iteration_limit);
+    DBUG_VOID_RETURN;
+  }
+
   /*
     If the entire qc is being invalidated we can bail out early
     instead of waiting for the lock.
@@ -2429,6 +2604,14 @@ void Query_cache::pack(ulong join_limit, uint iteration_limit)
 void Query_cache::destroy()
 {
   DBUG_ENTER("Query_cache::destroy");
+  if (m_partitions)
+  {
+    for (uint i= 0; i < m_partition_count; i++)
+      m_partitions[i].destroy();
+    delete [] m_partitions;
+    m_partitions= NULL;
+    m_partition_count= 0;
+  }
   if (!initialized)
   {
     DBUG_PRINT("qcache", ("Query Cache not initialized"));
@@ -2468,7 +2651,21 @@ void Query_cache::init()
     be used.
   */
   if (global_system_variables.query_cache_type == 0)
-    query_cache.disable_query_cache();
+    disable_query_cache();
+
+  if (this == &query_cache && query_cache_partitions > 1 &&
+      (m_partitions= new (std::nothrow) Query_cache[query_cache_partitions]))
+  {
+    m_partition_count= query_cache_partitions;
+    for (uint i= 0; i < m_partition_count; i++)
+    {
+      Query_cache *partition= m_partitions + i;
+      partition->m_global= this;
+      partition->m_query_cache_is_disabled= m_query_cache_is_disabled;
+      partition->min_result_data_size= min_result_data_size;
+      partition->init();
+    }
+  }
 
   DBUG_VOID_RETURN;
 }
@@ -2665,6 +2862,7 @@ void Query_cache::make_disabled()
   first_block= 0;
   total_blocks= 0;
   tables_blocks= 0;
+  clear_table_filter();
   DBUG_VOID_RETURN;
 }
 
@@ -2717,6 +2915,7 @@ void Query_cache::flush_cache()
     BLOCK_LOCK_WR(queries_blocks);
     free_query_internal(queries_blocks);
   }
+  clear_table_filter();
 }
 
 /*
@@ -2755,7 +2954,7 @@ my_bool Query_cache::free_old_query()
     if (query_block != 0)
     {
       free_query(query_block);
-      lowmem_prunes++;
+      add_statistic(&m_global->lowmem_prunes, 1);
       DBUG_RETURN(0);
     }
   }
@@ -2814,8 +3013,8 @@ void Query_cache::free_query_internal(Query_cache_block *query_block)
     if (result_block->type != Query_cache_block::RESULT)
     {
       // removing unfinished query
-      refused++;
-      inserts--;
+      add_statistic(&m_global->refused, 1);
+      add_statistic(&m_global->inserts, -1);
     }
     Query_cache_block *block= result_block;
     do
@@ -2828,8 +3027,8 @@ void Query_cache::free_query_internal(Query_cache_block *query_block)
   else
   {
     // removing unfinished query
-    refused++;
-    inserts--;
+    add_statistic(&m_global->refused, 1);
+    add_statistic(&m_global->inserts, -1);
   }
 
   query->unlock_n_destroy();
@@ -2905,11 +3104,11 @@ Query_cache::append_result_data(Query_cache_block **current_block,
   DBUG_PRINT("qcache", ("append %lu bytes to 0x%lx query",
 		      data_len, (long) query_block));
 
-  if (query_block->query()->add(data_len) > query_cache_limit)
+  if (query_block->query()->add(data_len) > m_global->query_cache_limit)
   {
     DBUG_PRINT("qcache", ("size limit reached %lu > %lu",
 			query_block->query()->length(),
-			query_cache_limit));
+			m_global->query_cache_limit));
     DBUG_RETURN(0);
   }
   if (*current_block == 0)
@@ -3053,7 +3252,7 @@ inline ulong Query_cache::get_min_first_result_data_size()
   if (queries_in_cache < QUERY_CACHE_MIN_ESTIMATED_QUERIES_NUMBER)
     return min_result_data_size;
   ulong avg_result = (query_cache_size - free_memory) / queries_in_cache;
-  avg_result = min(avg_result, query_cache_limit);
+  avg_result = min(avg_result, m_global->query_cache_limit);
   return max(min_result_data_size, avg_result);
 }
 
@@ -3153,6 +3352,17 @@ void Query_cache::invalidate_table(THD *thd, TABLE *table)
 
 void Query_cache::invalidate_table(THD *thd, uchar * key, uint32  key_length)
 {
+  if (m_partitions)
+  {
+    /* Only lock the partitions that may have queries using the table */
+    for (uint i= 0; i < m_partition_count; i++)
+    {
+      if (m_partitions[i].may_have_table(key, key_length))
+        m_partitions[i].invalidate_table(thd, key, key_length);
+    }
+    return;
+  }
+
   DEBUG_SYNC(thd, "wait_in_query_cache_invalidate1");
 
   /*
@@ -3377,6 +3587,8 @@ Query_cache::insert_table(uint key_len, const char *key,
 
   THD *thd= current_thd;
 
+  add_to_table_filter(key, key_len);
+
   Query_cache_block *table_block= 
     (Query_cache_block *) my_hash_search(&tables, (uchar*) key, key_len);
 
@@ -3511,10 +3723,10 @@ Query_cache::allocate_block(ulong len, my_bool not_less, ulong minimum)
   DBUG_PRINT("qcache", ("len %lu, not less %d, min %lu",
              len, not_less, minimum));
 
-  if (len >= min(query_cache_size, query_cache_limit))
+  if (len >= min(query_cache_size, m_global->query_cache_limit))
   {
     DBUG_PRINT("qcache", ("Query cache hase only %lu memory and limit %lu",
-			query_cache_size, query_cache_limit));
+			query_cache_size, m_global->query_cache_limit));
     DBUG_RETURN(0); // in any case we don't have such piece of memory
   }
 
@@ -4123,7 +4335,7 @@ void Query_cache::pack_cache()
 {
   DBUG_ENTER("Query_cache::pack_cache");
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
 
   uchar *border = 0;
   Query_cache_block *before = 0;
@@ -4155,7 +4367,7 @@ void Query_cache::pack_cache()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   DBUG_VOID_RETURN;
 }
 
@@ -4344,13 +4556,13 @@ my_bool Query_cache::move_by_type(uchar **border,
   case Query_cache_block::RES_CONT:
   case Query_cache_block::RESULT:
   {
-    DBUG_PRINT("qcache", ("block 0x%lx RES* (%d)", (ulong) block,
-               (int) block->type));
-    if (*border == 0)
-      break;
-    Query_cache_block *query_block= block->result()->parent();
-    BLOCK_LOCK_WR(query_block);
-    Query_cache_block *next= block->next, *prev= block->prev;
+    DBUG_PRINT("qcache", ("block 0x%lx RES* (%d)", (ulong) block,
+               (int) block->type));
+    if (*border == 0)
+      break;
+    Query_cache_block *query_block= block->result()->parent();
+    BLOCK_LOCK_WR(query_block);
+    Query_cache_block *next= block->next, *prev= block->prev;
     Query_cache_block::block_type type= block->type;
     ulong len = block->length, used = block->used;
     Query_cache_block *pprev = block->pprev,
@@ -4743,6 +4955,13 @@ my_bool Query_cache::check_integrity(bool locked)
   uint i;
   DBUG_ENTER("check_integrity");
 
+  if (m_partitions)
+  {
+    for (i= 0; i < m_partition_count; i++)
+      result|= m_partitions[i].check_integrity(locked);
+    DBUG_RETURN(result);
+  }
+
   if (!locked)
     lock_and_suspend();
 
@@ -69,6 +69,12 @@ typedef ulonglong sql_mode_t;
 
 #define TABLE_COUNTER_TYPE uint
 
+/*
+  Number of bits in the filter of the tables used by the queries of a
+  query cache partition (see Query_cache::m_table_filter)
+*/
+#define QUERY_CACHE_TABLE_FILTER_BITS		4096
+
 struct Query_cache_block;
 struct Query_cache_block_table;
 struct Query_cache_table;
@@ -299,6 +305,32 @@ private:
 
   bool m_query_cache_is_disabled;
 
+  /*
+    If query_cache_partitions > 1, the global query_cache object owns that
+    many partitions, each of them a complete query cache with its own
+    memory and structure_guard_mutex. The global object then only routes
+    the calls: queries to the partition chosen by a hash of their text,
+    invalidations to the partitions that may have queries using the table.
+  */
+  Query_cache *m_partitions;
+  uint m_partition_count;
+  /*
+    The global query_cache object. It keeps query_cache_limit and the
+    statistics that can be reset with FLUSH STATUS for all partitions.
+  */
+  Query_cache *m_global;
+  /*
+    Filter of the tables used by the queries in this partition: the bit of
+    a table is set when a query using it is registered, and is only
+    cleared when the partition is emptied. It is read without locking.
+  */
+  int32 m_table_filter[QUERY_CACHE_TABLE_FILTER_BITS / 32];
+
+  Query_cache *get_partition(THD *thd, const char *query, size_t length);
+  void add_to_table_filter(const char *key, uint32 key_length);
+  bool may_have_table(const uchar *key, uint32 key_length);
+  void clear_table_filter();
+
   void free_query_internal(Query_cache_block *point);
   void invalidate_table_internal(THD *thd, uchar *key, uint32 key_length);
   void disable_query_cache(void) { m_query_cache_is_disabled= TRUE; }
@@ -447,6 +479,9 @@ protected:
 
   bool is_disabled(void) { return m_query_cache_is_disabled; }
 
+  /* Sum of a statistics variable over all partitions, read without lock */
+  ulong get_statistic(ulong Query_cache::*var);
+
   /* initialize cache (mutex) */
   void init();
   /* resize query cache (return real query size, 0 if disabled) */
@@ -344,25 +344,6 @@ THD *thd_get_current_thd()
   return current_thd;
 }
 
-/**
-  Get iterator begin of global thread list
-
-  @retval Iterator begin of global thread list
-*/
-Thread_iterator thd_get_global_thread_list_begin()
-{
-  return global_thread_list_begin();
-}
-/**
-  Get iterator end of global thread list
-
-  @retval Iterator end of global thread list
-*/
-Thread_iterator thd_get_global_thread_list_end()
-{
-  return global_thread_list_end();
-}
-
 extern "C"
 void thd_binlog_pos(const THD *thd,
                     const char **file_var,
@@ -376,15 +357,12 @@ void thd_binlog_pos(const THD *thd,
 
   thd_new_connection_setup
 
-  @note Must be called with LOCK_thread_count locked.
-
   @param              thd            THD object
   @param              stack_start    Start of stack for connection
 */
 void thd_new_connection_setup(THD *thd, char *stack_start)
 {
   DBUG_ENTER("thd_new_connection_setup");
-  mysql_mutex_assert_owner(&LOCK_thread_count);
 #ifdef HAVE_PSI_INTERFACE
   thd_set_psi(thd,
               PSI_THREAD_CALL(new_thread)
@@ -395,7 +373,6 @@ void thd_new_connection_setup(THD *thd, char *stack_start)
     my_micro_time();
 
   add_global_thread(thd);
-  mysql_mutex_unlock(&LOCK_thread_count);
 
   DBUG_PRINT("info", ("init new connection. thd: 0x%lx fd: %d",
           (ulong)thd, mysql_socket_getfd(thd->net.vio->mysql_socket)));
@@ -753,6 +730,12 @@ int thd_opt_slow_log()
   return (int) opt_slow_log;
 }
 
+extern "C"
+unsigned long thd_parallel_degree(const THD *thd)
+{
+  return thd->variables.max_parallel_degree;
+}
+
 /**
   Dumps a text description of a thread, its security context
   (user, host) and the current query.
@@ -885,29 +868,12 @@ long long thd_start_time(const THD* thd)
 extern "C"
 void thd_kill(ulong id)
 {
-  THD *tmp= NULL;
-  mysql_mutex_lock(&LOCK_thread_count);
-  Thread_iterator it= global_thread_list_begin();
-  Thread_iterator it_end= global_thread_list_end();
-  while (it != it_end)
-  {
-    tmp= *it;
-    if (tmp->get_command() == COM_DAEMON)
-      continue;
-    if (tmp->thread_id == id)
-    {
-      mysql_mutex_lock(&tmp->LOCK_thd_data);
-      mysql_mutex_unlock(&LOCK_thread_count);
-      tmp->awake(THD::KILL_CONNECTION);
-      mysql_mutex_unlock(&tmp->LOCK_thd_data);
-      break;
-    }
-    it++;
-  }
-  if (it == it_end)
-  {
-    mysql_mutex_unlock(&LOCK_thread_count);
-  }
+  THD *tmp= find_thd_with_id(id);
+  if (!tmp)
+    return;
+  if (tmp->get_command() != COM_DAEMON)
+    tmp->awake(THD::KILL_CONNECTION);
+  mysql_mutex_unlock(&tmp->LOCK_thd_data);
 }
 
 /**
@@ -390,6 +390,7 @@ class MY_LOCALE;
 */
 
 struct Query_cache_block;
+class Query_cache;
 
 struct Query_cache_tls
 {
@@ -398,12 +399,14 @@ struct Query_cache_tls
     functions and methods to maintain proper locking.
   */
   Query_cache_block *first_query_block;
+  /* Partition of the query cache that first_query_block belongs to */
+  Query_cache *partition;
   void set_first_query_block(Query_cache_block *first_query_block_arg)
   {
     first_query_block= first_query_block_arg;
   }
 
-  Query_cache_tls() :first_query_block(NULL) {}
+  Query_cache_tls() :first_query_block(NULL), partition(NULL) {}
 };
 
 /* SIGNAL / RESIGNAL / GET DIAGNOSTICS */
@@ -495,6 +498,7 @@ typedef struct system_variables
   ulong max_allowed_packet;
   ulong max_error_count;
   ulong max_length_for_sort_data;
+  ulong max_parallel_degree;
   ulong max_sort_length;
   ulong max_tmp_tables;
   ulong max_insert_delayed_threads;
@@ -330,7 +330,15 @@ void Materialized_cursor::fetch(ulong num_rows)
   for (fetch_limit+= num_rows; fetch_count < fetch_limit; fetch_count++)
   {
     if ((res= table->file->ha_rnd_next(table->record[0])))
+    {
+      /* Skip deleted rows and continuations of dynamic MEMORY rows */
+      if (res == HA_ERR_RECORD_DELETED)
+      {
+        fetch_count--;
+        continue;
+      }
       break;
+    }
     /* Send data only if the read was successful. */
     /*
       If network write failed (i.e. due to a closed socked),
@@ -36,6 +36,8 @@
 #include "sql_show.h"
 #include "filesort.h"
 #include "sql_tmp_table.h"
+#include "sql_hash_group.h"
+#include "sql_scan_filter.h"
 #include "records.h"          // rr_sequential
 #include "opt_explain_format.h" // Explain_format_flags
 
@@ -60,6 +62,8 @@ static enum_nested_loop_state
 end_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 static enum_nested_loop_state
 end_unique_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
+static enum_nested_loop_state
+end_hash_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 static void copy_sum_funcs(Item_sum **func_ptr, Item_sum **end_ptr);
 
 static int join_read_system(JOIN_TAB *tab);
@@ -779,8 +783,29 @@ void setup_tmptable_write_func(JOIN_TAB *tab)
     */
     if (table->s->keys && !table->s->uniques)
     {
-      DBUG_PRINT("info",("Using end_update"));
-      op->set_write_func(end_update);
+      if (!op->get_hash_group() &&
+          Group_hash_table::is_applicable(join, table, tmp_tbl))
+      {
+        THD *thd= join->thd;
+        Group_hash_table *hash= new Group_hash_table(table, tmp_tbl);
+        if (hash && hash->init(min(thd->variables.tmp_table_size,
+                                   thd->variables.max_heap_table_size)))
+        {
+          delete hash;
+          hash= NULL;
+        }
+        op->set_hash_group(hash);
+      }
+      if (op->get_hash_group())
+      {
+        DBUG_PRINT("info",("Using end_hash_update"));
+        op->set_write_func(end_hash_update);
+      }
+      else
+      {
+        DBUG_PRINT("info",("Using end_update"));
+        op->set_write_func(end_update);
+      }
     }
     else
     {
@@ -1458,7 +1483,12 @@ evaluate_join_record(JOIN *join, JOIN_TAB *join_tab)
 
   if (condition)
   {
-    found= MY_TEST(condition->val_int());
+    Scan_filter *filter= join_tab->scan_filter;
+    if (filter && join_tab->scan_filter_cond == condition)
+      found= filter->eval() &&
+             (filter->is_complete() || condition->val_int());
+    else
+      found= MY_TEST(condition->val_int());
 
     if (join->thd->killed)
     {
@@ -2395,6 +2425,20 @@ int join_init_read_record(JOIN_TAB *tab)
                        tab->select, 1, 1, FALSE))
     return 1;
 
+  /*
+    Compile the simple comparisons of the condition once per execution,
+    they are checked for every row of the scan by evaluate_join_record().
+  */
+  Item *condition= tab->condition();
+  if (condition != tab->scan_filter_cond ||
+      tab->join->thd->query_id != tab->scan_filter_query_id)
+  {
+    tab->scan_filter= condition ?
+      Scan_filter::compile(tab->table, condition) : NULL;
+    tab->scan_filter_cond= condition;
+    tab->scan_filter_query_id= tab->join->thd->query_id;
+  }
+
   return (*tab->read_record.read_record)(&tab->read_record);
 }
 
@@ -3160,6 +3204,130 @@ end_unique_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records)
 }
 
 
+/**
+  Write the groups aggregated by end_hash_update() to the temporary table
+
+  @details
+  If the temporary table had to be converted to MyISAM, its index is
+  initialized for end_unique_update(), like end_update() does it.
+
+  @return TRUE on error
+*/
+
+static bool flush_hash_groups(JOIN *join, JOIN_TAB *join_tab,
+                              Group_hash_table *hash)
+{
+  TABLE *const table= join_tab->table;
+  bool converted;
+  int error;
+
+  if (hash->flush(join->thd, &converted))
+    return true;
+  if (converted)
+  {
+    if ((error= table->file->ha_index_init(0, 0)))
+    {
+      table->file->print_error(error, MYF(0));
+      return true;
+    }
+    ((QEP_tmp_table*)join_tab->op)->set_write_func(end_unique_update);
+  }
+  return false;
+}
+
+
+/**
+  Group by looking the group up in a hash table in memory
+
+  @details
+  Like end_update(), but the groups and the values of their aggregate
+  functions are kept in a Group_hash_table, and are written to the
+  temporary table only at the end. If the groups take more memory than
+  the temporary table may take in memory, they are written to the table
+  at that point, and the remaining records are grouped by end_update(),
+  or by end_unique_update() if the table has been converted to MyISAM.
+*/
+
+static enum_nested_loop_state
+end_hash_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records)
+{
+  TABLE *const table= join_tab->table;
+  QEP_tmp_table *const op= (QEP_tmp_table*)join_tab->op;
+  Group_hash_table *const hash= op->get_hash_group();
+  ORDER   *group;
+  uchar   *rec;
+  DBUG_ENTER("end_hash_update");
+
+  if (end_of_records)
+  {
+    if (flush_hash_groups(join, join_tab, hash))
+      DBUG_RETURN(NESTED_LOOP_ERROR);
+    DBUG_RETURN(NESTED_LOOP_OK);
+  }
+  if (join->thd->killed)			// Aborted by user
+  {
+    join->thd->send_kill_message();
+    DBUG_RETURN(NESTED_LOOP_KILLED);             /* purecov: inspected */
+  }
+
+  copy_fields(join_tab->tmp_table_param);	// Groups are copied twice.
+  /* Make a key of group index */
+  for (group=table->group ; group ; group=group->next)
+  {
+    Item *item= *group->item;
+    item->save_org_in_field(group->field);
+    /* Store in the used key if the field was 0 */
+    if (item->maybe_null)
+      group->buff[-1]= (char) group->field->is_null();
+  }
+  ulong hash_value= hash->hash_key();
+  if ((rec= hash->find(hash_value)))
+  {						/* Update old group */
+    join->found_records++;
+    memcpy(table->record[0], rec, table->s->reclength);
+    update_tmptable_sum_func(join->sum_funcs,table);
+    memcpy(rec, table->record[0], table->s->reclength);
+    DBUG_RETURN(NESTED_LOOP_OK);
+  }
+
+  if (hash->is_full())
+  {
+    /*
+      Write the groups to the table and group the remaining records
+      there. end_update() makes the key of the current record again.
+    */
+    op->set_write_func(end_update);
+    if (flush_hash_groups(join, join_tab, hash))
+      DBUG_RETURN(NESTED_LOOP_ERROR);
+    op->set_hash_group(NULL);
+    delete hash;
+    DBUG_RETURN(op->put_record());
+  }
+
+  join->found_records++;
+  /*
+    Copy null bits from group key to table
+    We can't copy all data as the key may have different format
+    as the row data (for example as with VARCHAR keys)
+  */
+  KEY_PART_INFO *key_part;
+  for (group=table->group,key_part=table->key_info[0].key_part;
+       group ;
+       group=group->next,key_part++)
+  {
+    if (key_part->null_bit)
+      memcpy(table->record[0]+key_part->offset, group->buff, 1);
+  }
+  init_tmptable_sum_functions(join->sum_funcs);
+  if (copy_funcs(join_tab->tmp_table_param->items_to_copy, join->thd))
+    DBUG_RETURN(NESTED_LOOP_ERROR);           /* purecov: inspected */
+  if (!hash->insert(hash_value))
+    DBUG_RETURN(NESTED_LOOP_ERROR);           /* purecov: inspected */
+  join_tab->send_records++;
+  DBUG_RETURN(NESTED_LOOP_OK);
+}
+
+
 	/* ARGSUSED */
 enum_nested_loop_state
 end_write_group(JOIN *join, JOIN_TAB *join_tab, bool end_of_records)
@@ -4274,6 +4442,9 @@ QEP_tmp_table::prepare_tmp_table()
     (void) table->file->extra(HA_EXTRA_WRITE_CACHE);
     empty_record(table);
   }
+  /* Groups left over from an execution that was interrupted */
+  if (hash_group)
+    hash_group->reset();
   /* If it wasn't already, start index scan for grouping using table index. */
   if (!table->file->inited && table->group &&
       join_tab->tmp_table_param->sum_func_count && table->s->keys)
@@ -4292,6 +4463,13 @@ QEP_tmp_table::prepare_tmp_table()
 }
 
 
+void QEP_tmp_table::free()
+{
+  delete hash_group;
+  hash_group= NULL;
+}
+
+
 /**
   @brief Prepare table if necessary and call write_func to save record
 
@@ -22,6 +22,7 @@
 #include "records.h"                          /* READ_RECORD */
 
 class JOIN;
+class Group_hash_table;
 typedef struct st_join_table JOIN_TAB;
 typedef struct st_table_ref TABLE_REF;
 typedef struct st_position POSITION;
@@ -236,7 +237,7 @@ class QEP_tmp_table :public QEP_operation
 {
 public:
   QEP_tmp_table(JOIN_TAB *tab) : QEP_operation(tab),
-    write_func(NULL)
+    write_func(NULL), hash_group(NULL)
   {};
   enum_op_type type() { return OT_TMP_TABLE; }
   enum_nested_loop_state put_record() { return put_record(false); };
@@ -253,10 +254,19 @@ public:
   {
     write_func= new_write_func;
   }
+  /** Hash table used by end_hash_update(), NULL if not used */
+  Group_hash_table *get_hash_group() const { return hash_group; }
+  void set_hash_group(Group_hash_table *hash)
+  {
+    hash_group= hash;
+  }
+  void free();
 
 private:
   /** Write function that would be used for saving records in tmp table. */
   Next_select_func write_func;
+  /** Groups aggregated in memory by end_hash_update() */
+  Group_hash_table *hash_group;
   enum_nested_loop_state put_record(bool end_of_records);
   __attribute__((warn_unused_result))
   bool prepare_tmp_table();
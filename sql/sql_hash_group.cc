@@ -0,0 +1,328 @@
+/* Copyright (c) 2000, 2013, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file
+
+  @brief
+  In-memory hash aggregation of GROUP BY queries
+*/
+
+#include "sql_priv.h"
+#include "sql_select.h"
+#include "sql_optimizer.h"  // JOIN
+#include "sql_tmp_table.h"  // create_myisam_from_heap()
+#include "sql_hash_group.h"
+
+/* Number of slots the hash table starts with */
+static const uint MIN_SLOTS= 256;
+
+
+Group_hash_table::~Group_hash_table()
+{
+  my_free(slots);
+  free_root(&mem_root, MYF(0));
+}
+
+
+/**
+  Check whether the groups of a temporary table can be aggregated in memory
+
+  @param join   the join the temporary table belongs to
+  @param table  the temporary table, grouped with end_update()
+  @param param  parameters of the temporary table
+
+  @details
+  The records of the temporary table are copied with memcpy(), so they
+  must not contain BLOBs. The aggregate functions must keep their whole
+  state in their result fields, which is true for non-DISTINCT COUNT, SUM,
+  AVG, MIN and MAX.
+
+  @return TRUE if Group_hash_table can be used for the table
+*/
+
+bool Group_hash_table::is_applicable(JOIN *join, TABLE *table,
+                                     TMP_TABLE_PARAM *param)
+{
+  if (!join->thd->optimizer_switch_flag(OPTIMIZER_SWITCH_HASH_GROUP_BY) ||
+      table->s->db_type() != heap_hton || table->s->blob_fields ||
+      !param->group_buff || !param->group_length)
+    return FALSE;
+
+  for (ORDER *group= table->group; group; group= group->next)
+  {
+    if (!group->field || group->field->type() == MYSQL_TYPE_BIT)
+      return FALSE;
+  }
+
+  for (Item_sum **func= join->sum_funcs; *func; func++)
+  {
+    switch ((*func)->sum_func()) {
+    case Item_sum::COUNT_FUNC:
+    case Item_sum::SUM_FUNC:
+    case Item_sum::AVG_FUNC:
+    case Item_sum::MIN_FUNC:
+    case Item_sum::MAX_FUNC:
+      break;
+    default:
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+
+/**
+  Describe the parts of the group key
+
+  @param max_size_arg  memory the groups may take
+
+  @return TRUE on out of memory
+*/
+
+bool Group_hash_table::init(ulonglong max_size_arg)
+{
+  DBUG_ENTER("Group_hash_table::init");
+  max_size= max_size_arg;
+  key_length= param->group_length;
+  entry_size= ALIGN_SIZE(sizeof(Entry) + ALIGN_SIZE(key_length) +
+                         table->s->reclength);
+
+  n_parts= 0;
+  for (ORDER *group= table->group; group; group= group->next)
+    n_parts++;
+  if (!(parts= (Key_part *) sql_alloc(n_parts * sizeof(Key_part))))
+    DBUG_RETURN(TRUE);
+
+  Key_part *part= parts;
+  for (ORDER *group= table->group; group; group= group->next, part++)
+  {
+    Field *field= group->field;
+    part->field= field;
+    part->offset= (uint) ((uchar *) group->buff - param->group_buff);
+    part->length= field->pack_length();
+    part->maybe_null= (*group->item)->maybe_null;
+    part->length_bytes= 0;
+    part->cs= NULL;
+    if (field->real_type() == MYSQL_TYPE_VARCHAR)
+    {
+      part->length_bytes= ((Field_varstring *) field)->length_bytes;
+      part->cs= field->charset();
+    }
+    else if (field->real_type() == MYSQL_TYPE_STRING)
+      part->cs= field->charset();
+  }
+  DBUG_RETURN(FALSE);
+}
+
+
+/**
+  Compute the hash value of the group key in TMP_TABLE_PARAM::group_buff
+*/
+
+ulong Group_hash_table::hash_key() const
+{
+  ulong nr1= 1, nr2= 4;
+  for (const Key_part *part= parts; part < parts + n_parts; part++)
+  {
+    const uchar *pos= param->group_buff + part->offset;
+    if (part->maybe_null)
+    {
+      /* The NULL flag is hashed as the MEMORY engine does it */
+      if (pos[-1])
+      {
+        nr1^= (nr1 << 1) | 1;
+        continue;
+      }
+    }
+    if (part->length_bytes)
+    {
+      uint length= part->length_bytes == 1 ? (uint) *pos : uint2korr(pos);
+      part->cs->coll->hash_sort(part->cs, pos + part->length_bytes, length,
+                                &nr1, &nr2);
+    }
+    else if (part->cs)
+      part->cs->coll->hash_sort(part->cs, pos, part->length,
+                                &nr1, &nr2);
+    else
+      my_charset_bin.coll->hash_sort(&my_charset_bin, pos,
+                                     part->length, &nr1, &nr2);
+  }
+  return nr1;
+}
+
+
+/**
+  Compare the group key of an entry with the key in TMP_TABLE_PARAM::group_buff
+*/
+
+bool Group_hash_table::key_equal(Entry *entry) const
+{
+  const uchar *key= entry_key(entry);
+  for (const Key_part *part= parts; part < parts + n_parts; part++)
+  {
+    const uchar *a= param->group_buff + part->offset;
+    const uchar *b= key + part->offset;
+    if (part->maybe_null)
+    {
+      if (a[-1] != b[-1])
+        return FALSE;
+      if (a[-1])
+        continue;                               // NULL == NULL
+    }
+    if (part->cs)
+    {
+      if (part->field->cmp(a, b))
+        return FALSE;
+    }
+    else if (memcmp(a, b, part->length))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/**
+  Find the group with the key in TMP_TABLE_PARAM::group_buff
+
+  @param hash  hash value of the key, see hash_key()
+
+  @return the record of the group, or NULL if there is no such group
+*/
+
+uchar *Group_hash_table::find(ulong hash) const
+{
+  if (!n_slots)
+    return NULL;
+  uint mask= n_slots - 1;
+  for (uint idx= hash & mask; slots[idx]; idx= (idx + 1) & mask)
+  {
+    Entry *entry= slots[idx];
+    if (entry->hash == hash && key_equal(entry))
+      return entry_record(entry);
+  }
+  return NULL;
+}
+
+
+/**
+  Double the number of slots and rehash all entries
+
+  @return TRUE on out of memory
+*/
+
+bool Group_hash_table::grow()
+{
+  uint new_n_slots= n_slots ? n_slots * 2 : MIN_SLOTS;
+  Entry **new_slots= (Entry **) my_malloc(new_n_slots * sizeof(Entry *),
+                                          MYF(MY_WME | MY_ZEROFILL));
+  if (!new_slots)
+    return TRUE;
+  uint mask= new_n_slots - 1;
+  for (Entry *entry= first; entry; entry= entry->next)
+  {
+    uint idx= entry->hash & mask;
+    while (new_slots[idx])
+      idx= (idx + 1) & mask;
+    new_slots[idx]= entry;
+  }
+  my_free(slots);
+  slots= new_slots;
+  n_slots= new_n_slots;
+  return FALSE;
+}
+
+
+/**
+  Add a new group
+
+  @param hash  hash value of the key in TMP_TABLE_PARAM::group_buff
+
+  @details
+  The key is copied from TMP_TABLE_PARAM::group_buff and the record from
+  record[0] of the temporary table. The caller must have checked that
+  there is no group with the same key.
+
+  @return the record of the new group, or NULL on out of memory
+*/
+
+uchar *Group_hash_table::insert(ulong hash)
+{
+  if ((n_entries + 1) * 2 > n_slots && grow())
+    return NULL;
+
+  Entry *entry= (Entry *) alloc_root(&mem_root, entry_size);
+  if (!entry)
+    return NULL;
+  entry->next= NULL;
+  entry->hash= hash;
+  memcpy(entry_key(entry), param->group_buff, key_length);
+  memcpy(entry_record(entry), table->record[0], table->s->reclength);
+
+  uint mask= n_slots - 1;
+  uint idx= hash & mask;
+  while (slots[idx])
+    idx= (idx + 1) & mask;
+  slots[idx]= entry;
+
+  if (last)
+    last->next= entry;
+  else
+    first= entry;
+  last= entry;
+  n_entries++;
+  return entry_record(entry);
+}
+
+
+/**
+  Write the groups to the temporary table in the order they were created
+
+  @param      thd        thread handle
+  @param[out] converted  set to TRUE if the temporary table was converted
+                         to MyISAM because it became full
+
+  @return TRUE on error, which has been reported
+*/
+
+bool Group_hash_table::flush(THD *thd, bool *converted)
+{
+  DBUG_ENTER("Group_hash_table::flush");
+  *converted= FALSE;
+  for (Entry *entry= first; entry; entry= entry->next)
+  {
+    int error;
+    memcpy(table->record[0], entry_record(entry), table->s->reclength);
+    if ((error= table->file->ha_write_row(table->record[0])))
+    {
+      if (create_myisam_from_heap(thd, table, param->start_recinfo,
+                                  &param->recinfo, error, FALSE, NULL))
+        DBUG_RETURN(TRUE);                    // Not a table_is_full error
+      *converted= TRUE;
+    }
+  }
+  reset();
+  DBUG_RETURN(FALSE);
+}
+
+
+void Group_hash_table::reset()
+{
+  if (n_slots)
+    memset(slots, 0, n_slots * sizeof(Entry *));
+  n_entries= 0;
+  first= last= NULL;
+  free_root(&mem_root, MYF(MY_MARK_BLOCKS_FREE));
+}
@@ -0,0 +1,136 @@
+#ifndef SQL_HASH_GROUP_INCLUDED
+#define SQL_HASH_GROUP_INCLUDED
+
+/* Copyright (c) 2000, 2013, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/** @file Hash table used to aggregate GROUP BY queries in memory */
+
+#include "sql_alloc.h"
+#include "my_sys.h"
+
+class Field;
+class THD;
+class JOIN;
+struct TABLE;
+class TMP_TABLE_PARAM;
+
+/*
+  The class Group_hash_table keeps the groups of a GROUP BY query in memory
+  while the rows of the join are aggregated, instead of looking each group
+  up in the index of the temporary table and updating it there.
+
+  The groups are identified by the group key that end_update() builds in
+  TMP_TABLE_PARAM::group_buff. For every group an entry holds a copy of
+  that key and the image of the temporary table record with the current
+  values of the aggregate functions. The entries are allocated in a
+  MEM_ROOT and chained in the order they were created, so that they can be
+  written to the temporary table in the same order end_update() would have
+  inserted them. They are found through an open addressing table with
+  linear probing that is doubled when it becomes half full.
+
+  Group key parts are hashed and compared as the hash index of the MEMORY
+  engine would do it: CHAR and VARCHAR parts by their collation, all other
+  parts by their binary image, and NULLs are equal to each other.
+*/
+
+class Group_hash_table :public Sql_alloc
+{
+public:
+  Group_hash_table(TABLE *table_arg, TMP_TABLE_PARAM *param_arg)
+    : table(table_arg), param(param_arg), parts(NULL), n_parts(0),
+      slots(NULL), n_slots(0), n_entries(0), first(NULL), last(NULL),
+      key_length(0), entry_size(0), max_size(0)
+  {
+    init_sql_alloc(&mem_root, 8192, 0);
+  }
+  ~Group_hash_table();
+
+  /* Check whether the groups of the temporary table can be kept in memory */
+  static bool is_applicable(JOIN *join, TABLE *table, TMP_TABLE_PARAM *param);
+
+  bool init(ulonglong max_size_arg);
+
+  /* Compute the hash value of the group key in param->group_buff */
+  ulong hash_key() const;
+
+  /* Find the record of the group with the current key, NULL if none */
+  uchar *find(ulong hash) const;
+
+  /* Add the group with the current key and record[0] as its record */
+  uchar *insert(ulong hash);
+
+  /* Whether another group would take more memory than allowed */
+  bool is_full() const
+  {
+    return (ulonglong) (n_entries + 1) * entry_size +
+           (ulonglong) n_slots * sizeof(Entry *) > max_size;
+  }
+
+  /* Write all groups to the temporary table and empty the hash table */
+  bool flush(THD *thd, bool *converted);
+
+  /* Forget all groups */
+  void reset();
+
+private:
+  /* An entry for a group, followed by its key and its record */
+  struct Entry
+  {
+    Entry *next;                /**< next entry in creation order */
+    ulong hash;                 /**< hash value of the group key */
+  };
+
+  /* A part of the group key */
+  struct Key_part
+  {
+    Field *field;               /**< key field, see ORDER::field */
+    uint offset;                /**< offset of the value in the key */
+    uint length;                /**< length of the value in the key */
+    bool maybe_null;            /**< the value is preceded by a NULL flag */
+    uint length_bytes;          /**< bytes of the VARCHAR length, or 0 */
+    const CHARSET_INFO *cs;     /**< collation of string parts, or NULL */
+  };
+
+  TABLE *table;
+  TMP_TABLE_PARAM *param;
+  Key_part *parts;
+  uint n_parts;
+
+  /* Open addressing table of entries, the size is a power of 2 */
+  Entry **slots;
+  uint n_slots;
+  uint n_entries;
+  /* Entries in creation order */
+  Entry *first, *last;
+  /* Length of the group key */
+  uint key_length;
+  /* Memory taken by one entry together with its key and record */
+  size_t entry_size;
+  /* Memory the entries and the slots may take */
+  ulonglong max_size;
+
+  MEM_ROOT mem_root;
+
+  uchar *entry_key(Entry *entry) const { return (uchar *) (entry + 1); }
+  uchar *entry_record(Entry *entry) const
+  {
+    return entry_key(entry) + ALIGN_SIZE(key_length);
+  }
+  bool key_equal(Entry *entry) const;
+  bool grow();
+};
+
+#endif /* SQL_HASH_GROUP_INCLUDED */
@@ -29,6 +29,7 @@
 #include "sql_optimizer.h"  // JOIN
 #include "sql_join_buffer.h"
 #include "sql_tmp_table.h"  // instantiate_tmp_table()
+#include <my_bit.h>
 
 #include <algorithm>
 using std::max;
@@ -1915,6 +1916,377 @@ enum_nested_loop_state JOIN_CACHE_BNL::join_matching_records(bool skip_last)
   return rc;
 }
 
+
+/* Check whether values of a column of this type are hashed as integers */
+
+static inline bool is_integer_type(enum_field_types type)
+{
+  switch (type) {
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_INT24:
+  case MYSQL_TYPE_LONG:
+  case MYSQL_TYPE_LONGLONG:
+    return true;
+  default:
+    return false;
+  }
+}
+
+
+/* Check whether values of a column of this type are hashed as strings */
+
+static inline bool is_char_type(enum_field_types type)
+{
+  return type == MYSQL_TYPE_VARCHAR || type == MYSQL_TYPE_STRING ||
+         type == MYSQL_TYPE_VAR_STRING;
+}
+
+
+/*
+  Collect the equalities the hash key of a BNLH cache can be built from
+
+  SYNOPSIS
+    collect_hash_keys()
+      tab        the join table the cache is to be attached to
+      cond       the condition to look for the equalities in
+      keys       array to save the found equalities or NULL
+      n_keys     the number of equalities that have been found before
+
+  DESCRIPTION
+    The function looks for the conjuncts of cond of the form
+    inner_field = outer_field where inner_field is a column of tab and
+    outer_field is a column of one of the tables preceding tab in the plan.
+    Only the equalities whose arguments are compared in the same way as
+    their hash values are compared are taken into account: integer columns,
+    temporal columns of the same type and character columns whose collation
+    is the collation of the comparison.
+    If tab is the first inner table of an outer join the function also looks
+    into the ON condition, which is guarded by tab->not_null_compl and which
+    is always on when matches are searched for in the join buffer.
+    If keys is not NULL the found equalities are saved there.
+
+  RETURN
+    the total number of equalities found, not more than MAX_HASH_KEYS
+*/
+
+uint JOIN_CACHE_BNLH::collect_hash_keys(JOIN_TAB *tab, Item *cond,
+                                        Hash_key *keys, uint n_keys)
+{
+  if (cond == NULL || n_keys >= MAX_HASH_KEYS)
+    return n_keys;
+
+  if (cond->type() == Item::COND_ITEM)
+  {
+    if (((Item_cond *) cond)->functype() != Item_func::COND_AND_FUNC)
+      return n_keys;
+    List_iterator<Item> li(*((Item_cond *) cond)->argument_list());
+    Item *item;
+    while ((item= li++))
+      n_keys= collect_hash_keys(tab, item, keys, n_keys);
+    return n_keys;
+  }
+
+  if (cond->type() != Item::FUNC_ITEM)
+    return n_keys;
+
+  Item_func *func= (Item_func *) cond;
+  if (func->functype() == Item_func::TRIG_COND_FUNC)
+  {
+    if (tab->first_inner == tab &&
+        ((Item_func_trig_cond *) func)->get_trig_var() == &tab->not_null_compl)
+      return collect_hash_keys(tab, func->arguments()[0], keys, n_keys);
+    return n_keys;
+  }
+
+  if (func->functype() != Item_func::EQ_FUNC ||
+      func->arguments()[0]->type() != Item::FIELD_ITEM ||
+      func->arguments()[1]->type() != Item::FIELD_ITEM)
+    return n_keys;
+
+  Item_field *inner= (Item_field *) func->arguments()[0];
+  Item_field *outer= (Item_field *) func->arguments()[1];
+  if (inner->used_tables() != tab->table->map)
+    std::swap(inner, outer);
+  const table_map outer_map= outer->used_tables();
+  if (inner->used_tables() != tab->table->map ||
+      outer_map & (PSEUDO_TABLE_BITS | tab->table->map) ||
+      my_count_bits(outer_map) != 1 ||
+      !(outer_map & tab->prefix_tables()))
+    return n_keys;
+
+  Field *const inner_field= inner->field;
+  Field *const outer_field= outer->field;
+  enum_hash_key_kind kind;
+  const CHARSET_INFO *cs= NULL;
+  if (is_integer_type(inner_field->real_type()) &&
+      is_integer_type(outer_field->real_type()))
+    kind= HASH_KEY_INT;
+  else if (is_temporal_type(inner_field->type()) &&
+           inner_field->type() == outer_field->type())
+    kind= HASH_KEY_TEMPORAL;
+  else if (is_char_type(inner_field->real_type()) &&
+           is_char_type(outer_field->real_type()))
+  {
+    cs= ((Item_bool_func2 *) func)->compare_collation();
+    if (inner_field->charset() != cs || outer_field->charset() != cs)
+      return n_keys;
+    kind= HASH_KEY_STRING;
+  }
+  else
+    return n_keys;
+
+  if (keys)
+  {
+    keys[n_keys].inner= inner;
+    keys[n_keys].outer= outer;
+    keys[n_keys].kind= kind;
+    keys[n_keys].cs= cs;
+  }
+  return n_keys + 1;
+}
+
+
+/* 
+  Initialize a BNLH cache       
+
+  SYNOPSIS
+    init()
+
+  DESCRIPTION
+    The function collects the equalities the hash key is built from and
+    then initializes the cache in the same way as a BNL cache is
+    initialized. The hash entries of the records are placed at the end
+    of the allocated join buffer.
+
+  RETURN
+    0   initialization with buffer allocations has been succeeded
+    1   otherwise
+*/
+
+int JOIN_CACHE_BNLH::init()
+{
+  DBUG_ENTER("JOIN_CACHE_BNLH::init");
+
+  n_keys= collect_hash_keys(join_tab, join_tab->condition(), keys, 0);
+  if (!n_keys)
+    DBUG_RETURN(1);
+
+  if (JOIN_CACHE_BNL::init())
+    DBUG_RETURN(1);
+
+  hash_entries_end=
+    (Hash_entry *) (buff + buff_size - buff_size % sizeof(Hash_entry));
+
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Calculate the hash value of the inner or of the outer key
+
+  SYNOPSIS
+    calc_hash()
+      inner      calculate the hash value of the key built from join_tab
+      hash  OUT  the calculated hash value
+
+  DESCRIPTION
+    The function calculates the hash value of the key built either from
+    the inner fields of the equalities, or from their outer fields. The
+    values are taken from the record buffers of the tables.
+    Equal values have the same hash value: integer and temporal values are
+    hashed as 8 byte integers while character values are hashed by the
+    collation of their comparison.
+
+  RETURN
+    TRUE   if one of the key values is NULL, the key cannot match anything
+    FALSE  otherwise
+*/
+
+bool JOIN_CACHE_BNLH::calc_hash(bool inner, ulong *hash)
+{
+  ulong nr1= 1, nr2= 4;
+  for (Hash_key *key= keys; key < keys + n_keys; key++)
+  {
+    Item_field *item= inner ? key->inner : key->outer;
+    if (key->kind == HASH_KEY_STRING)
+    {
+      String *str= item->val_str(&hash_str);
+      if (item->null_value)
+        return TRUE;
+      key->cs->coll->hash_sort(key->cs, (const uchar *) str->ptr(),
+                               str->length(), &nr1, &nr2);
+    }
+    else
+    {
+      uchar buf[8];
+      longlong value= key->kind == HASH_KEY_INT ? item->val_int() :
+                      item->val_temporal_by_field_type();
+      if (item->null_value)
+        return TRUE;
+      int8store(buf, value);
+      my_charset_bin.coll->hash_sort(&my_charset_bin, buf, sizeof(buf),
+                                     &nr1, &nr2);
+    }
+  }
+  *hash= nr1;
+  return FALSE;
+}
+
+
+/* 
+  Add a record into the BNLH join buffer
+
+  SYNOPSIS
+    put_record_in_cache()
+
+  DESCRIPTION
+    The function writes the record into the join buffer as it is done for
+    a BNL cache. After this it saves the position of the record and the hash
+    value of its outer key in the hash entry of the record. 
+    
+  RETURN
+    TRUE    if it has been decided that it should be the last record
+            in the join buffer,
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_BNLH::put_record_in_cache()
+{
+  bool is_full= JOIN_CACHE::put_record_in_cache();
+  Hash_entry *entry= get_hash_entry(records - 1);
+  DBUG_ASSERT((uchar *) entry >= end_pos);
+  entry->rec= last_rec_pos;
+  entry->has_null= calc_hash(FALSE, &entry->hash);
+  return is_full;
+}
+
+
+/*
+  Using a hash table find matches from the next table for join buffer records
+
+  SYNOPSIS
+    join_matching_records()
+      skip_last    do not look for matches for the last partial join record 
+
+  DESCRIPTION
+    The function works as JOIN_CACHE_BNL::join_matching_records() does,
+    but it does not read all records from the join buffer for every row of
+    join_tab. Instead, before join_tab is scanned, the hash entries of the
+    records are linked into a hash table whose buckets are placed right
+    below the entries. Then for every row of join_tab only the records
+    whose outer key has the same hash value as the inner key of the row
+    are read from the join buffer and extended by the row.
+    The records whose keys contain NULL values are not put into the hash
+    table: they can get only null complementing extensions.
+      
+  RETURN
+    return one of enum_nested_loop_state.
+*/ 
+
+enum_nested_loop_state JOIN_CACHE_BNLH::join_matching_records(bool skip_last)
+{
+  int error;
+  READ_RECORD *info;
+  enum_nested_loop_state rc= NESTED_LOOP_OK;
+  SQL_SELECT *select= join_tab->cache_select;
+
+  join_tab->table->null_row= 0;
+
+  /* Return at once if there are no records in the join buffer */
+  if (!records)     
+    return NESTED_LOOP_OK;   
+ 
+  /* See the comment in JOIN_CACHE_BNL::join_matching_records() */
+  if (skip_last)     
+    put_record_in_cache();     
+
+  /* 
+    Build the hash table. The number of buckets is a power of 2 not greater
+    than the number of records, so the space reserved by rem_space() for
+    them is always enough. The entries are linked in the reverse order to get
+    the records of every bucket in the order they were written in.
+  */
+  const uint n_entries= records - MY_TEST(skip_last);
+  uint n_buckets= 1;
+  while (n_buckets * 2 <= n_entries)
+    n_buckets*= 2;
+  const ulong hash_mask= n_buckets - 1;
+  Hash_entry **buckets=
+    (Hash_entry **) (hash_entries_end - records) - n_buckets;
+  DBUG_ASSERT((uchar *) buckets >= end_pos);
+  memset(buckets, 0, n_buckets * sizeof(Hash_entry *));
+  for (uint i= n_entries; i > 0; i--)
+  {
+    Hash_entry *entry= get_hash_entry(i - 1);
+    if (entry->has_null)
+      continue;
+    entry->next= buckets[entry->hash & hash_mask];
+    buckets[entry->hash & hash_mask]= entry;
+  }
+
+  if (join_tab->use_quick == QS_DYNAMIC_RANGE && join_tab->select->quick)
+    /* A dynamic range access was used last. Clean up after it */
+    join_tab->select->set_quick(NULL);
+
+  /* Start retrieving all records of the joined table */
+  if ((error= (*join_tab->read_first_record)(join_tab))) 
+    return error < 0 ? NESTED_LOOP_OK : NESTED_LOOP_ERROR;
+
+  info= &join_tab->read_record;
+  do
+  {
+    if (join_tab->keep_current_rowid)
+      join_tab->table->file->position(join_tab->table->record[0]);
+
+    if (join->thd->killed)
+    {
+      /* The user has aborted the execution of the query */
+      join->thd->send_kill_message();
+      return NESTED_LOOP_KILLED;
+    }
+    
+    /* 
+      Do not look for matches if the last read record of the joined table
+      does not meet the conditions that have been pushed to this table
+    */
+    if (rc == NESTED_LOOP_OK)
+    {
+      bool skip_record;
+      ulong hash;
+      bool consider_record= (!select || 
+                             (!select->skip_record(join->thd, &skip_record) &&
+                              !skip_record));
+      if (select && join->thd->is_error())
+        return NESTED_LOOP_ERROR;
+      if (consider_record && !calc_hash(TRUE, &hash))
+      {
+        /* Read the records with the same hash value and look for matches */
+        for (Hash_entry *entry= buckets[hash & hash_mask];
+             entry;
+             entry= entry->next)
+        {
+          /* 
+            If only the first match is needed and it has been already found
+            for the record then the record is skipped.
+          */
+          if (entry->hash != hash ||
+              (check_only_first_match && get_match_flag_by_pos(entry->rec)))
+            continue;
+          get_record_by_pos(entry->rec);
+          rc= generate_full_extensions(entry->rec);
+          if (rc != NESTED_LOOP_OK)
+            return rc;
+        }
+      }
+    }
+  } while (!(error= info->read_record(info)));
+
+  if (error > 0)				// Fatal error
+    rc= NESTED_LOOP_ERROR; 
+  return rc;
+}
+
      
 /*
   Set match flag for a record in join buffer if it has not been set yet    
@@ -494,9 +494,10 @@ public:
   }
 
   /** Bits describing cache's type @sa setup_join_buffering() */
-  enum {ALG_NONE= 0, ALG_BNL= 1, ALG_BKA= 2, ALG_BKA_UNIQUE= 4};
+  enum {ALG_NONE= 0, ALG_BNL= 1, ALG_BKA= 2, ALG_BKA_UNIQUE= 4, ALG_BNLH= 8};
 
   friend class JOIN_CACHE_BNL;
+  friend class JOIN_CACHE_BNLH;
   friend class JOIN_CACHE_BKA;
   friend class JOIN_CACHE_BKA_UNIQUE;
 };
@@ -519,6 +520,114 @@ public:
 
 };
 
+/*
+  The class JOIN_CACHE_BNLH supports a hash join variant of the BNL join
+  algorithm. It is used when the condition attached to join_tab contains
+  equalities between fields of join_tab and fields of the preceding tables
+  that have no usable index.
+  Records are put into the join buffer exactly as for JOIN_CACHE_BNL.
+  In addition, the hash value of the outer key fields of every record is
+  saved in a hash entry. The hash entries are placed at the very end of the
+  join buffer and grow towards the records, the space for them being
+  reserved by rem_space() as records are added.
+  When the buffer is full, the entries are linked into a hash table that is
+  built right below them, and join_tab is scanned once. For every row of
+  join_tab only the records from the join buffer whose key has the same
+  hash value are checked against the join condition, instead of all of them.
+  The full join condition is still evaluated for these candidates, so hash
+  collisions cannot produce wrong results.
+
+  buff                                                        buff+buff_size
+  V                                                                        V
+  +---------------------------------------------------------------------+-+
+  |record_1|record_2|...|record_n|   free   |buckets|entry_n|...|entry_1| |
+  +---------------------------------------------------------------------+-+
+*/
+
+class JOIN_CACHE_BNLH :public JOIN_CACHE_BNL
+{
+public:
+  /* Maximum number of equalities used to build the hash key */
+  static const uint MAX_HASH_KEYS= 16;
+
+  /* Kinds of values that can be compared through their hash values */
+  enum enum_hash_key_kind {HASH_KEY_INT, HASH_KEY_TEMPORAL, HASH_KEY_STRING};
+
+  /* One equality inner_field = outer_field used to build the hash key */
+  struct Hash_key
+  {
+    Item_field *inner;          /**< field of join_tab */
+    Item_field *outer;          /**< field of one of the preceding tables */
+    enum_hash_key_kind kind;    /**< how the values are hashed */
+    const CHARSET_INFO *cs;     /**< collation of the comparison */
+  };
+
+  /* Check whether a hash join can be used to join the table tab */
+  static bool is_applicable(JOIN_TAB *tab)
+  {
+    return collect_hash_keys(tab, tab->condition(), NULL, 0) > 0;
+  }
+
+private:
+
+  /* The hash entry saved for each record put into the join buffer */
+  struct Hash_entry
+  {
+    uchar *rec;                 /**< position of the record in the buffer */
+    Hash_entry *next;           /**< next entry in the same bucket */
+    ulong hash;                 /**< hash value of the outer key */
+    bool has_null;              /**< the outer key contains a NULL value */
+  };
+
+  /* Space reserved for each record at the end of the join buffer */
+  static const uint HASH_SPACE_PER_RECORD=
+    sizeof(Hash_entry) + sizeof(Hash_entry *);
+
+  /* The equalities the hash key is built from */
+  Hash_key keys[MAX_HASH_KEYS];
+  /* The number of elements in keys */
+  uint n_keys;
+
+  /* The end of the hash entry array: entry i is at hash_entries_end[-1-i] */
+  Hash_entry *hash_entries_end;
+
+  /* Buffer used to read string values when calculating hash values */
+  String hash_str;
+
+  static uint collect_hash_keys(JOIN_TAB *tab, Item *cond,
+                                Hash_key *keys, uint n_keys);
+
+  Hash_entry *get_hash_entry(uint idx) { return hash_entries_end - 1 - idx; }
+
+  bool calc_hash(bool inner, ulong *hash);
+
+protected:
+
+  uint aux_buffer_min_size() const { return 2 * HASH_SPACE_PER_RECORD; }
+
+  /* Reserve the space for the hash entries of this and the next record */
+  ulong rem_space()
+  {
+    ulong used= (end_pos - buff) + (records + 1) * HASH_SPACE_PER_RECORD +
+                sizeof(Hash_entry);
+    return used < buff_size ? buff_size - used : 0;
+  }
+
+  /* Add a record into the join buffer and save the hash of its key */
+  bool put_record_in_cache();
+
+  /* Using a hash table find matches for records from the join buffer */
+  enum_nested_loop_state join_matching_records(bool skip_last);
+
+public:
+  JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab, JOIN_CACHE *prev)
+    : JOIN_CACHE_BNL(j, tab, prev), n_keys(0), hash_entries_end(NULL)
+  {}
+
+  /* Initialize the BNLH cache */
+  int init();
+};
+
 class JOIN_CACHE_BKA :public JOIN_CACHE
 {
 protected:
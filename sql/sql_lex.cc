@@ -498,6 +498,7 @@ void lex_start(THD *thd)
   lex->server_options.port= -1;
   lex->explain_format= NULL;
   lex->is_lex_started= TRUE;
+  lex->has_plan_cache_digest= false;
   lex->used_tables= 0;
   lex->reset_slave_info.all= false;
   lex->is_change_password= false;
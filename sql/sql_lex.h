@@ -27,6 +27,7 @@
 #include "sql_array.h"
 #include "mem_root_array.h"
 #include "sql_alter.h"                // Alter_info
+#include "my_md5.h"                  // MD5_HASH_SIZE
 
 /* YACC and LEX Definitions */
 
@@ -2548,6 +2549,13 @@ public:
   bool escape_used;
   bool is_lex_started; /* If lex_start() did run. For debugging. */
 
+  /*
+    MD5 of the digest of the statement, the key of its query blocks in the
+    plan cache. Only set if the plan cache is enabled when it is parsed.
+  */
+  uchar plan_cache_digest[MD5_HASH_SIZE];
+  bool has_plan_cache_digest;
+
   /*
     The set of those tables whose fields are referenced in all subqueries
     of the query.
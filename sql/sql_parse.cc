@@ -104,6 +104,7 @@
 #include "table_cache.h" // table_cache_manager
 
 #include "sql_digest.h"
+#include "sql_plan_cache.h" // plan_cache
 
 #include <algorithm>
 using std::max;
@@ -841,10 +842,8 @@ void do_handle_bootstrap(THD *thd)
     goto end;
   }
 
-  mysql_mutex_lock(&LOCK_thread_count);
   thd_added= true;
   add_global_thread(thd);
-  mysql_mutex_unlock(&LOCK_thread_count);
 
   handle_bootstrap_impl(thd);
 
@@ -7897,7 +7896,8 @@ void add_join_natural(TABLE_LIST *a, TABLE_LIST *b, List<String> *using_fields,
   @param only_kill_query        Should it kill the query or the connection
 
   @note
-    This is written such that we have a short lock on LOCK_thread_count
+    Only the partition of the global thread list holding the thread id is
+    locked, for a short time
 */
 
 uint kill_one_thread(THD *thd, ulong id, bool only_kill_query)
@@ -7907,21 +7907,11 @@ uint kill_one_thread(THD *thd, ulong id, bool only_kill_query)
   DBUG_ENTER("kill_one_thread");
   DBUG_PRINT("enter", ("id=%lu only_kill=%d", id, only_kill_query));
 
-  mysql_mutex_lock(&LOCK_thread_count);
-  Thread_iterator it= global_thread_list_begin();
-  Thread_iterator end= global_thread_list_end();
-  for (; it != end; ++it)
+  if ((tmp= find_thd_with_id(id)) && tmp->get_command() == COM_DAEMON)
   {
-    if ((*it)->get_command() == COM_DAEMON)
-      continue;
-    if ((*it)->thread_id == id)
-    {
-      tmp= *it;
-      mysql_mutex_lock(&tmp->LOCK_thd_data);    // Lock from delete
-      break;
-    }
+    mysql_mutex_unlock(&tmp->LOCK_thd_data);
+    tmp= NULL;
   }
-  mysql_mutex_unlock(&LOCK_thread_count);
   if (tmp)
   {
 
@@ -8987,12 +8977,14 @@ bool parse_sql(THD *thd,
     parser_state->m_digest_psi= MYSQL_DIGEST_START(thd->m_statement_psi);
 
     if (parser_state->m_input.m_compute_digest ||
-       (parser_state->m_digest_psi != NULL))
+       (parser_state->m_digest_psi != NULL) ||
+       plan_cache.is_enabled())
     {
       /*
         If either:
         - the caller wants to compute a digest
         - the performance schema wants to compute a digest
+        - the plan cache needs the digest as key
         set the digest listener in the lexer.
       */
       parser_state->m_lip.m_digest= thd->m_digest;
@@ -9032,6 +9024,21 @@ bool parse_sql(THD *thd,
 
   ret_value= mysql_parse_status || thd->is_fatal_error;
 
+  if ((ret_value == 0) &&
+      (thd->m_digest != NULL) && plan_cache.is_enabled())
+  {
+    /*
+      A digest that is empty or truncated does not identify the
+      statement, do not use it as key of the plan cache.
+    */
+    sql_digest_storage *storage= & thd->m_digest->m_digest_storage;
+    if (!storage->is_empty() && !storage->m_full)
+    {
+      compute_digest_md5(storage, thd->lex->plan_cache_digest);
+      thd->lex->has_plan_cache_digest= true;
+    }
+  }
+
   if ((ret_value == 0) &&
       (parser_state->m_digest_psi != NULL))
   {
@@ -0,0 +1,331 @@
+/* Copyright (c) 2013, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+/**
+  @file
+
+  @brief
+  Cache of the join orders chosen by the optimizer
+*/
+
+#include "sql_priv.h"
+#include "sql_class.h"
+#include "sql_select.h"
+#include "sql_optimizer.h"
+#include "sql_plan_cache.h"
+#include <my_bit.h>
+
+
+/**
+  The plan cache of the server.
+*/
+Plan_cache plan_cache;
+
+
+#ifdef HAVE_PSI_INTERFACE
+PSI_mutex_key Plan_cache::m_lock_key;
+PSI_mutex_info Plan_cache::m_mutex_keys[]= {
+  { &m_lock_key, "LOCK_plan_cache", PSI_FLAG_GLOBAL}
+};
+#endif
+
+
+/*
+  Key: MD5 of the statement digest, number of the query block, the
+  optimizer_switch, join_buffer_size, optimizer_search_depth and
+  optimizer_prune_level settings the order is chosen with, length of the
+  current database and the database name.
+*/
+static const uint PLAN_CACHE_KEY_HEADER= MD5_HASH_SIZE + 4 + 8 + 8 + 4 + 4 + 1;
+static const uint PLAN_CACHE_MAX_KEY= PLAN_CACHE_KEY_HEADER + NAME_LEN;
+
+
+/**
+  A cached join order and what it was chosen for.
+*/
+struct Plan_cache::Entry
+{
+  /* Neighbours in the LRU list */
+  Entry *prev, *next;
+  uchar key[PLAN_CACHE_MAX_KEY];
+  uint key_length;
+  /* Number of tables and const tables of the join */
+  uint tables, const_tables;
+  table_map const_table_map;
+  /* Numbers of the non-const tables, in join order */
+  uchar order[MAX_TABLES];
+  /* Version and row estimate bucket of each table, by table number */
+  ulonglong versions[MAX_TABLES];
+  uchar buckets[MAX_TABLES];
+};
+
+
+extern "C" uchar *plan_cache_get_key(const uchar *record, size_t *length,
+                                     my_bool not_used __attribute__((unused)))
+{
+  const Plan_cache::Entry *entry= (const Plan_cache::Entry *) record;
+  *length= entry->key_length;
+  return (uchar *) entry->key;
+}
+
+
+extern "C" void plan_cache_free_entry(void *entry)
+{
+  my_free(entry);
+}
+
+
+/**
+  Build the key of a query block in the plan cache
+
+  @return length of the key, 0 if the join order of the query block cannot
+          be cached
+*/
+
+static uint make_key(JOIN *join, uchar *key)
+{
+  THD *thd= join->thd;
+  LEX *lex= thd->lex;
+  /*
+    With less than two tables to order there is no search to skip. The
+    conditions of a subquery predicate depend on the execution strategy
+    chosen for it, which is not part of the key, so its order is not
+    cached.
+  */
+  if (!lex->has_plan_cache_digest ||
+      join->tables < join->const_tables + 2 ||
+      join->select_lex->master_unit()->item ||
+      !join->select_lex->sj_nests.is_empty() ||
+      join->tables > MAX_TABLES || thd->db_length > NAME_LEN)
+    return 0;
+
+  for (uint i= 0; i < join->tables; i++)
+  {
+    TABLE *table= join->join_tab[i].table;
+    /* Derived and temporary tables have no stable version */
+    if (table->s->tmp_table != NO_TMP_TABLE || table->tablenr >= MAX_TABLES)
+      return 0;
+  }
+
+  memcpy(key, lex->plan_cache_digest, MD5_HASH_SIZE);
+  uchar *pos= key + MD5_HASH_SIZE;
+  int4store(pos, join->select_lex->select_number);
+  int8store(pos + 4, thd->variables.optimizer_switch);
+  int8store(pos + 12, (ulonglong) thd->variables.join_buff_size);
+  int4store(pos + 20, (uint32) thd->variables.optimizer_search_depth);
+  int4store(pos + 24, (uint32) thd->variables.optimizer_prune_level);
+  pos[28]= (uchar) thd->db_length;
+  if (thd->db_length)
+    memcpy(key + PLAN_CACHE_KEY_HEADER, thd->db, thd->db_length);
+  return PLAN_CACHE_KEY_HEADER + thd->db_length;
+}
+
+
+/**
+  Bucket of the number of rows expected to be read from a table
+*/
+
+static inline uchar rows_bucket(ha_rows rows)
+{
+  if (rows == 0)
+    return 0;
+  if (rows >= (ha_rows) UINT_MAX32)
+    return 33;
+  return (uchar) (my_bit_log2((ulong) rows) + 1);
+}
+
+
+bool Plan_cache::init()
+{
+#ifdef HAVE_PSI_INTERFACE
+  mysql_mutex_register("sql", m_mutex_keys, array_elements(m_mutex_keys));
+#endif
+  mysql_mutex_init(m_lock_key, &m_lock, MY_MUTEX_INIT_FAST);
+  if (my_hash_init(&m_hash, &my_charset_bin, 64, 0, 0, plan_cache_get_key,
+                   plan_cache_free_entry, 0))
+  {
+    mysql_mutex_destroy(&m_lock);
+    return true;
+  }
+  return false;
+}
+
+
+void Plan_cache::destroy()
+{
+  if (!my_hash_inited(&m_hash))
+    return;
+  my_hash_free(&m_hash);
+  m_first= m_last= NULL;
+  entries= 0;
+  mysql_mutex_destroy(&m_lock);
+}
+
+
+void Plan_cache::unlink(Entry *entry)
+{
+  if (entry->prev)
+    entry->prev->next= entry->next;
+  else
+    m_first= entry->next;
+  if (entry->next)
+    entry->next->prev= entry->prev;
+  else
+    m_last= entry->prev;
+}
+
+
+void Plan_cache::link_first(Entry *entry)
+{
+  entry->prev= NULL;
+  entry->next= m_first;
+  if (m_first)
+    m_first->prev= entry;
+  else
+    m_last= entry;
+  m_first= entry;
+}
+
+
+void Plan_cache::remove(Entry *entry)
+{
+  unlink(entry);
+  my_hash_delete(&m_hash, (uchar *) entry);
+  entries--;
+}
+
+
+/**
+  Put the non-const tables of a join in the cached order
+
+  @details
+  Must be called after the const tables and the row estimates of the join
+  are known, that is just before the join order is searched. If the tables
+  are found in the cache and the entry is still valid, join->best_ref is
+  reordered so that optimize_straight_join() can build the plan.
+
+  @return true if the cached order was applied
+*/
+
+bool Plan_cache::lookup(JOIN *join)
+{
+  DBUG_ENTER("Plan_cache::lookup");
+  uchar key[PLAN_CACHE_MAX_KEY];
+  uint key_length;
+  if (!is_enabled() || !(key_length= make_key(join, key)))
+    DBUG_RETURN(false);
+
+  /* The JOIN_TAB of every table number, while the lock is not held */
+  JOIN_TAB *by_number[MAX_TABLES];
+  for (uint i= 0; i < join->tables; i++)
+    by_number[join->join_tab[i].table->tablenr]= join->join_tab + i;
+
+  mysql_mutex_lock(&m_lock);
+  Entry *entry= (Entry *) my_hash_search(&m_hash, key, key_length);
+  bool valid= entry != NULL &&
+              entry->tables == join->tables &&
+              entry->const_tables == join->const_tables &&
+              entry->const_table_map == join->const_table_map;
+  for (uint i= 0; valid && i < join->tables; i++)
+  {
+    JOIN_TAB *tab= join->join_tab + i;
+    uint nr= tab->table->tablenr;
+    valid= entry->versions[nr] == tab->table->s->get_table_ref_version() &&
+           ((join->const_table_map & tab->table->map) ||
+            entry->buckets[nr] == rows_bucket(tab->found_records));
+  }
+  if (!valid)
+  {
+    misses++;
+    mysql_mutex_unlock(&m_lock);
+    DBUG_PRINT("info", ("No valid cached join order"));
+    DBUG_RETURN(false);
+  }
+
+  for (uint idx= join->const_tables; idx < join->tables; idx++)
+    join->best_ref[idx]= by_number[entry->order[idx]];
+  unlink(entry);
+  link_first(entry);
+  hits++;
+  mysql_mutex_unlock(&m_lock);
+  DBUG_PRINT("info", ("Using cached join order"));
+  DBUG_RETURN(true);
+}
+
+
+/**
+  Remember the join order chosen for a join
+
+  @details
+  Must be called when join->best_positions holds the order chosen by the
+  search, and before the plan is built from it.
+*/
+
+void Plan_cache::store(JOIN *join)
+{
+  DBUG_ENTER("Plan_cache::store");
+  uchar key[PLAN_CACHE_MAX_KEY];
+  uint key_length;
+  if (!is_enabled() || !(key_length= make_key(join, key)))
+    DBUG_VOID_RETURN;
+
+  Entry *entry= (Entry *) my_malloc(sizeof(Entry), MYF(0));
+  if (!entry)
+    DBUG_VOID_RETURN;
+  memcpy(entry->key, key, key_length);
+  entry->key_length= key_length;
+  entry->tables= join->tables;
+  entry->const_tables= join->const_tables;
+  entry->const_table_map= join->const_table_map;
+  for (uint i= 0; i < join->tables; i++)
+  {
+    JOIN_TAB *tab= join->join_tab + i;
+    uint nr= tab->table->tablenr;
+    entry->versions[nr]= tab->table->s->get_table_ref_version();
+    entry->buckets[nr]= rows_bucket(tab->found_records);
+  }
+  for (uint idx= join->const_tables; idx < join->tables; idx++)
+    entry->order[idx]= (uchar) join->best_positions[idx].table->table->tablenr;
+
+  mysql_mutex_lock(&m_lock);
+  Entry *old= (Entry *) my_hash_search(&m_hash, key, key_length);
+  if (old)
+    remove(old);
+  while (entries >= plan_cache_size && m_last)
+    remove(m_last);
+  /* The cache may have been disabled meanwhile */
+  if (!plan_cache_size || my_hash_insert(&m_hash, (uchar *) entry))
+    my_free(entry);
+  else
+  {
+    link_first(entry);
+    entries++;
+  }
+  mysql_mutex_unlock(&m_lock);
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Remove the least recently used entries beyond plan_cache_size
+*/
+
+void Plan_cache::resize()
+{
+  mysql_mutex_lock(&m_lock);
+  while (entries > plan_cache_size && m_last)
+    remove(m_last);
+  mysql_mutex_unlock(&m_lock);
+}
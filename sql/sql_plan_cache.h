@@ -0,0 +1,102 @@
+#ifndef SQL_PLAN_CACHE_INCLUDED
+#define SQL_PLAN_CACHE_INCLUDED
+
+/* Copyright (c) 2013, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA */
+
+#include "my_global.h"
+#include "hash.h"
+#include "my_md5.h"
+#include "mysql/psi/mysql_thread.h"
+
+class JOIN;
+
+extern ulong plan_cache_size;
+
+/**
+  Cache of the join orders chosen by the optimizer.
+
+  Choosing the join order of a query block with greedy_search() is the
+  expensive part of the cost based optimization of short queries with
+  several tables. The cache remembers the order chosen for a query block,
+  identified by the digest of the statement text, the number of the query
+  block, the optimizer settings and the current database, so that the next
+  execution of the same prepared statement or of a text query with the
+  same digest can skip the search. The access methods are still chosen
+  for every execution by best_access_path(), for the cached order only.
+
+  A cached order is used only if the plan it was chosen for is still
+  likely to be the right one:
+    - the tables have the same versions, so the cache is invalidated by
+      DDL, by ANALYZE TABLE and by anything else that reopens a table,
+    - the same tables are const tables,
+    - the number of rows that the optimizer expects to read from each
+      table after range analysis is in the same power of 2 bucket. This
+      captures both changed table statistics and literals or parameters
+      of different selectivity.
+  Otherwise the order is searched again and replaces the cached one.
+
+  The cache holds at most plan_cache_size entries, the least recently
+  used one is removed when it is full. A size of 0 disables the cache.
+*/
+
+class Plan_cache
+{
+public:
+  Plan_cache() : m_first(NULL), m_last(NULL), hits(0), misses(0), entries(0)
+  {}
+
+  bool init();
+  void destroy();
+
+  bool is_enabled() const { return plan_cache_size != 0; }
+
+  /*
+    Put the non-const tables of join->best_ref in the cached order.
+    Returns true if an order was found.
+  */
+  bool lookup(JOIN *join);
+
+  /* Remember the order of join->best_positions */
+  void store(JOIN *join);
+
+  /* Remove entries beyond plan_cache_size */
+  void resize();
+
+  struct Entry;
+
+private:
+  mysql_mutex_t m_lock;
+  HASH m_hash;
+  /* Entries from the most to the least recently used */
+  Entry *m_first, *m_last;
+
+#ifdef HAVE_PSI_INTERFACE
+  static PSI_mutex_key m_lock_key;
+  static PSI_mutex_info m_mutex_keys[];
+#endif
+
+  void unlink(Entry *entry);
+  void link_first(Entry *entry);
+  void remove(Entry *entry);
+
+public:
+  /* Statistics, protected by m_lock */
+  ulong hits, misses, entries;
+};
+
+extern Plan_cache plan_cache;
+
+#endif /* SQL_PLAN_CACHE_INCLUDED */
@@ -30,6 +30,7 @@
 #include "opt_trace.h"
 #include "sql_executor.h"
 #include "merge_sort.h"
+#include "sql_plan_cache.h"
 #include <my_bit.h>
 
 #include <algorithm>
@@ -373,6 +374,53 @@ cache_record_length(JOIN *join,uint idx)
 }
 
 
+/**
+  Check whether a table scan of a table can be joined by a hash join.
+
+  A hash join is possible if a multiple equality contains both a column of
+  the table and a column of one of the tables in the partial plan.
+
+  @param join             the join being optimized
+  @param s                the table to be joined
+  @param remaining_tables set of tables not included in the partial plan yet
+
+  @return true if a hash join might be used to join the table
+*/
+
+static bool
+hash_join_possible(JOIN *join, const JOIN_TAB *s, table_map remaining_tables)
+{
+  COND_EQUAL *const levels[2]= {join->cond_equal,
+                                s->table->pos_in_table_list->cond_equal};
+  for (uint i= 0; i < 2; i++)
+  {
+    if (levels[i] == NULL)
+      continue;
+    List_iterator_fast<Item_equal> it(levels[i]->current_level);
+    Item_equal *item_equal;
+    while ((item_equal= it++))
+    {
+      if (item_equal->get_const())
+        continue;
+      bool inner= false, outer= false;
+      Item_equal_iterator fi(*item_equal);
+      Item_field *item;
+      while ((item= fi++))
+      {
+        const table_map map= item->field->table->map;
+        if (map == s->table->map)
+          inner= true;
+        else if (!(map & remaining_tables))
+          outer= true;
+      }
+      if (inner && outer)
+        return true;
+    }
+  }
+  return false;
+}
+
+
 /**
   Find the best access path for an extension of a partial execution
   plan and add this path to the plan.
@@ -958,6 +1006,7 @@ void Optimize_table_order::best_access_path(
       Here we estimate its cost.
     */
 
+    bool uses_hash_join= false;
     if (s->quick)
     {
       trace_access_scan.add_alnum("access_type", "range");
@@ -1014,11 +1063,26 @@ void Optimize_table_order::best_access_path(
            take into account cost to read and skip these records.
         */
         tmp+= (s->records - rnd_records) * ROW_EVALUATE_COST;
+
+        /*
+          With a hash join the join condition is evaluated only for the
+          records from the join buffer that have the same hash value as the
+          scanned row, so there is no cartesian product to evaluate. Instead
+          the cost of hashing every partial join record and every scanned row
+          is taken into account.
+        */
+        if (thd->optimizer_switch_flag(OPTIMIZER_SWITCH_HASH_JOIN) &&
+            hash_join_possible(join, s, remaining_tables))
+        {
+          trace_access_scan.add("using_hash_join", true);
+          uses_hash_join= true;
+        }
       }
     }
 
-    const double scan_cost=
-      tmp + (record_count * ROW_EVALUATE_COST * rnd_records);
+    const double scan_cost= tmp + (uses_hash_join ?
+      (record_count + rnd_records) * ROW_EVALUATE_COST :
+      record_count * ROW_EVALUATE_COST * rnd_records);
 
     trace_access_scan.add("rows", rows2double(rnd_records)).
       add("cost", scan_cost);
@@ -1144,10 +1208,17 @@ bool Optimize_table_order::choose_table_order()
                Opt_trace_context::GREEDY_SEARCH);
   if (straight_join)
     optimize_straight_join(join_tables);
+  else if (!emb_sjm_nest && plan_cache.lookup(join))
+  {
+    Opt_trace_object(&join->thd->opt_trace).add("cached_join_order", true);
+    optimize_straight_join(join_tables);
+  }
   else
   {
     if (greedy_search(join_tables))
       DBUG_RETURN(true);
+    if (!emb_sjm_nest)
+      plan_cache.store(join);
   }
 
   // Remaining part of this function not needed when processing semi-join nests.
@@ -0,0 +1,325 @@
+/* Copyright (c) 2000, 2013, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file
+
+  @brief
+  Evaluation of simple conditions on the record buffer of a table
+*/
+
+#include "sql_priv.h"
+#include "sql_class.h"
+#include "item_cmpfunc.h"
+#include "sql_scan_filter.h"
+
+
+/**
+  Compare the value of the column with the constant
+
+  @return -1, 0 or 1 as the column is less than, equal to or greater than
+          the constant
+*/
+
+int Scan_filter::Predicate::compare() const
+{
+  switch (kind) {
+  case KIND_INT:
+  case KIND_UINT:
+  {
+    longlong val;
+    switch (length) {
+    case 1:
+      val= kind == KIND_UINT ? (longlong) ptr[0] :
+                               (longlong) ((const signed char *) ptr)[0];
+      break;
+    case 2:
+      val= kind == KIND_UINT ? (longlong) uint2korr(ptr) :
+                               (longlong) sint2korr(ptr);
+      break;
+    case 3:
+      val= kind == KIND_UINT ? (longlong) uint3korr(ptr) :
+                               (longlong) sint3korr(ptr);
+      break;
+    case 4:
+      val= kind == KIND_UINT ? (longlong) uint4korr(ptr) :
+                               (longlong) sint4korr(ptr);
+      break;
+    default:
+      val= sint8korr(ptr);
+      break;
+    }
+    /* Same rules as Arg_comparator::compare_int_*() */
+    if (kind == KIND_UINT)
+    {
+      if (!int_unsigned && int_value < 0)
+        return 1;
+      return (ulonglong) val < (ulonglong) int_value ? -1 :
+             (ulonglong) val > (ulonglong) int_value ? 1 : 0;
+    }
+    if (int_unsigned)
+    {
+      if (val < 0)
+        return -1;
+      return (ulonglong) val < (ulonglong) int_value ? -1 :
+             (ulonglong) val > (ulonglong) int_value ? 1 : 0;
+    }
+    return val < int_value ? -1 : val > int_value ? 1 : 0;
+  }
+  case KIND_DATE:
+  {
+    longlong val= (longlong) uint3korr(ptr);
+    return val < int_value ? -1 : val > int_value ? 1 : 0;
+  }
+  case KIND_BYTES:
+  {
+    int res= memcmp(ptr, bytes, length);
+    return res < 0 ? -1 : res > 0 ? 1 : 0;
+  }
+  }
+  DBUG_ASSERT(0);
+  return 0;
+}
+
+
+bool Scan_filter::Predicate::eval() const
+{
+  if (null_ptr && (*null_ptr & null_bit))
+    return false;
+  int res= compare();
+  switch (op) {
+  case OP_EQ: return res == 0;
+  case OP_NE: return res != 0;
+  case OP_LT: return res < 0;
+  case OP_LE: return res <= 0;
+  case OP_GT: return res > 0;
+  case OP_GE: return res >= 0;
+  }
+  return false;
+}
+
+
+/**
+  Compile the leading conjuncts of a condition that compare columns with
+  constants
+
+  @param table  the table whose current row the filter will check
+  @param cond   the condition attached to the table
+
+  @return the filter, or NULL if no conjunct can be compiled
+*/
+
+Scan_filter *Scan_filter::compile(TABLE *table, Item *cond)
+{
+  DBUG_ENTER("Scan_filter::compile");
+  Scan_filter *filter= new Scan_filter(table);
+  if (!filter)
+    DBUG_RETURN(NULL);
+
+  filter->complete= filter->add_conjunct(cond);
+
+  if (!filter->n_preds && !filter->always_false)
+    DBUG_RETURN(NULL);
+  DBUG_PRINT("info", ("Compiled %u conjuncts, complete: %d",
+                      filter->n_preds, filter->complete));
+  DBUG_RETURN(filter);
+}
+
+
+/**
+  Compile a conjunct if it compares a column of the table with a constant
+
+  @details
+  The arguments of an AND are compiled in order, up to the first one that
+  cannot be compiled.
+
+  @return true if the whole conjunct was compiled
+*/
+
+bool Scan_filter::add_conjunct(Item *item)
+{
+  if (item->type() == Item::COND_ITEM &&
+      ((Item_cond *) item)->functype() == Item_func::COND_AND_FUNC)
+  {
+    List_iterator_fast<Item> it(*((Item_cond *) item)->argument_list());
+    Item *arg;
+    while ((arg= it++))
+    {
+      if (!add_conjunct(arg))
+        return false;
+    }
+    return true;
+  }
+
+  if (item->type() != Item::FUNC_ITEM || n_preds == MAX_PREDICATES)
+    return false;
+
+  Item_func *func= (Item_func *) item;
+  enum_op op;
+  switch (func->functype()) {
+  case Item_func::EQ_FUNC: op= OP_EQ; break;
+  case Item_func::NE_FUNC: op= OP_NE; break;
+  case Item_func::LT_FUNC: op= OP_LT; break;
+  case Item_func::LE_FUNC: op= OP_LE; break;
+  case Item_func::GT_FUNC: op= OP_GT; break;
+  case Item_func::GE_FUNC: op= OP_GE; break;
+  default:
+    return false;
+  }
+
+  Item **args= func->arguments();
+  Item *field_item= args[0]->real_item();
+  Item *value= args[1];
+  if (field_item->type() != Item::FIELD_ITEM)
+  {
+    /* constant <op> column is column <reversed op> constant */
+    field_item= args[1]->real_item();
+    value= args[0];
+    switch (op) {
+    case OP_LT: op= OP_GT; break;
+    case OP_LE: op= OP_GE; break;
+    case OP_GT: op= OP_LT; break;
+    case OP_GE: op= OP_LE; break;
+    default: break;
+    }
+  }
+  if (field_item->type() != Item::FIELD_ITEM ||
+      !value->const_item() || value->is_expensive() || value->has_subquery())
+    return false;
+
+  Field *field= ((Item_field *) field_item)->field;
+  if (field->table != table)
+    return false;
+
+  /*
+    An Item_param keeps type() == NULL_ITEM after it was bound to NULL
+    once, so check its value too. Other constants are only evaluated below,
+    once the column is known to be supported.
+  */
+  if (value->type() == Item::NULL_ITEM && value->is_null())
+  {
+    /* A comparison with NULL is never true */
+    always_false= true;
+    return true;
+  }
+
+  Predicate *pred= preds + n_preds;
+  pred->op= op;
+  pred->ptr= field->ptr;
+  pred->null_ptr= field->real_maybe_null() ?
+                  table->record[0] + field->null_offset() : NULL;
+  pred->null_bit= field->null_bit;
+  pred->length= field->pack_length();
+  pred->int_unsigned= false;
+  pred->bytes= NULL;
+
+  switch (field->real_type()) {
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_INT24:
+  case MYSQL_TYPE_LONG:
+  case MYSQL_TYPE_LONGLONG:
+  {
+#ifdef WORDS_BIGENDIAN
+    if (pred->length > 1 && pred->length != 3 && !table->s->db_low_byte_first)
+      return false;
+#endif
+    if (value->result_type() != INT_RESULT || value->is_temporal())
+      return false;
+    pred->kind= (field->flags & UNSIGNED_FLAG) ? KIND_UINT : KIND_INT;
+    pred->int_value= value->val_int();
+    pred->int_unsigned= value->unsigned_flag;
+    break;
+  }
+  case MYSQL_TYPE_NEWDECIMAL:
+  {
+    if (value->result_type() != INT_RESULT &&
+        value->result_type() != DECIMAL_RESULT)
+      return false;
+    my_decimal buf, check;
+    my_decimal *dec= value->val_decimal(&buf);
+    if (value->null_value)
+      break;
+    if (!dec)
+      return false;
+    if (my_decimal_is_zero(dec))
+      dec->sign(false);
+    Field_new_decimal *dec_field= (Field_new_decimal *) field;
+    uchar *image= (uchar *) sql_alloc(pred->length);
+    if (!image ||
+        my_decimal2binary(0, dec, image, dec_field->precision,
+                          dec_field->dec) != E_DEC_OK ||
+        binary2my_decimal(0, image, &check, dec_field->precision,
+                          dec_field->dec) != E_DEC_OK ||
+        my_decimal_cmp(dec, &check))
+      return false;                             // Not exact
+    pred->kind= KIND_BYTES;
+    pred->bytes= image;
+    break;
+  }
+  case MYSQL_TYPE_NEWDATE:
+  {
+    if (!value->is_temporal_with_date() ||
+        value->field_type() != MYSQL_TYPE_DATE)
+      return false;
+    /* As Arg_comparator::compare_datetime(), also for Item_date_with_ref */
+    longlong packed= value->val_date_temporal();
+    if (value->null_value)
+      break;
+    MYSQL_TIME ltime;
+    TIME_from_longlong_datetime_packed(&ltime, packed);
+    if (ltime.hour || ltime.minute || ltime.second || ltime.second_part)
+      return false;
+    pred->kind= KIND_DATE;
+    pred->int_value= ltime.year * 16 * 32 + ltime.month * 32 + ltime.day;
+    break;
+  }
+  case MYSQL_TYPE_STRING:
+  {
+    const CHARSET_INFO *cs= field->charset();
+    if (!(cs->state & MY_CS_BINSORT) || cs->mbmaxlen != 1 ||
+        cs == &my_charset_bin || value->result_type() != STRING_RESULT ||
+        ((Item_bool_func2 *) func)->compare_collation() != cs)
+      return false;
+    String tmp, *str= value->val_str(&tmp);
+    if (value->null_value)
+      break;
+    if (!str)
+      return false;
+    if (!my_charset_same(str->charset(), cs) || str->length() > pred->length)
+      return false;
+    uchar *image= (uchar *) sql_alloc(pred->length);
+    if (!image)
+      return false;
+    memcpy(image, str->ptr(), str->length());
+    cs->cset->fill(cs, (char *) image + str->length(),
+                   pred->length - str->length(), cs->pad_char);
+    pred->kind= KIND_BYTES;
+    pred->bytes= image;
+    break;
+  }
+  default:
+    return false;
+  }
+
+  if (value->null_value)
+  {
+    /* A comparison with NULL is never true */
+    always_false= true;
+    return true;
+  }
+  n_preds++;
+  return true;
+}
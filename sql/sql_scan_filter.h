@@ -0,0 +1,121 @@
+#ifndef SQL_SCAN_FILTER_INCLUDED
+#define SQL_SCAN_FILTER_INCLUDED
+
+/* Copyright (c) 2000, 2013, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/** @file Compiled comparisons of table columns with constants */
+
+#include "sql_alloc.h"
+#include "table.h"
+
+class Item;
+
+/*
+  The class Scan_filter evaluates the conjuncts of a condition that compare
+  a column of a table with a constant directly on the record buffer of the
+  table, without going through the val_int() calls of the Item tree.
+
+  Supported are the comparisons =, <>, <, <=, > and >= of
+    - integer columns with integer constants,
+    - DECIMAL columns with integer and decimal constants,
+    - DATE columns with date constants,
+    - CHAR columns in a single-byte binary collation with string constants.
+  The constant is converted once to the storage format of the column, so
+  that a row is checked by comparing integers or byte strings. Conversions
+  that are not exact make the conjunct unsupported.
+
+  The conjuncts are compiled from the first one up to the first that is
+  not supported. If all are supported, the filter replaces the condition.
+  Otherwise it is checked first, and the condition is only evaluated for
+  the rows that pass it. Since Item_cond_and stops at the first false
+  conjunct as well, the remaining conjuncts are evaluated for the same
+  rows as before, which matters if they have side effects.
+*/
+
+class Scan_filter :public Sql_alloc
+{
+public:
+  /* Maximum number of conjuncts compiled */
+  static const uint MAX_PREDICATES= 16;
+
+  /*
+    Compile the leading conjuncts of cond that compare columns of table
+    with constants. Returns NULL if there are none.
+  */
+  static Scan_filter *compile(TABLE *table, Item *cond);
+
+  /* Check the current row of the table */
+  bool eval() const
+  {
+    /* A NULL-complemented row has no values in the record */
+    if (always_false || table->null_row)
+      return false;
+    for (const Predicate *pred= preds; pred < preds + n_preds; pred++)
+    {
+      if (!pred->eval())
+        return false;
+    }
+    return true;
+  }
+
+  /* Whether the filter is equivalent to the whole condition */
+  bool is_complete() const { return complete; }
+
+  uint predicate_count() const { return n_preds; }
+
+private:
+  enum enum_kind
+  {
+    KIND_INT, KIND_UINT, KIND_DATE, KIND_BYTES
+  };
+  enum enum_op
+  {
+    OP_EQ, OP_NE, OP_LT, OP_LE, OP_GT, OP_GE
+  };
+
+  /* One comparison of a column with a constant */
+  struct Predicate
+  {
+    enum_kind kind;
+    enum_op op;
+    const uchar *ptr;           /**< value of the column in the record */
+    const uchar *null_ptr;      /**< NULL flag of the column, or NULL */
+    uchar null_bit;
+    uint length;                /**< bytes of the column */
+    longlong int_value;         /**< constant of integer kinds */
+    bool int_unsigned;          /**< int_value is unsigned */
+    const uchar *bytes;         /**< constant of KIND_BYTES */
+
+    bool eval() const;
+    int compare() const;
+  };
+
+  TABLE *table;
+  Predicate preds[MAX_PREDICATES];
+  uint n_preds;
+  /* All conjuncts were compiled */
+  bool complete;
+  /* A conjunct compares with NULL, so no row passes */
+  bool always_false;
+
+  Scan_filter(TABLE *table_arg)
+    : table(table_arg), n_preds(0), complete(true), always_false(false)
+  {}
+
+  bool add_conjunct(Item *item);
+};
+
+#endif /* SQL_SCAN_FILTER_INCLUDED */
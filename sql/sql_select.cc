@@ -2512,6 +2512,25 @@ static bool setup_join_buffering(JOIN_TAB *tab, JOIN *join,
       goto no_join_cache;
     }
 
+    /*
+      Use a hash join if the condition attached to the table contains
+      equalities with the preceding tables that can be used as a hash key.
+    */
+    if (join->thd->optimizer_switch_flag(OPTIMIZER_SWITCH_HASH_JOIN) &&
+        JOIN_CACHE_BNLH::is_applicable(tab))
+    {
+      if ((options & SELECT_DESCRIBE) ||
+          ((tab->op= new JOIN_CACHE_BNLH(join, tab, prev_cache)) &&
+           !tab->op->init()))
+      {
+        *icp_other_tables_ok= FALSE;
+        DBUG_ASSERT(might_do_join_buffering(join_buffer_alg(join->thd), tab));
+        tab->use_join_cache= JOIN_CACHE::ALG_BNLH;
+        return false;
+      }
+      goto no_join_cache;
+    }
+
     if ((options & SELECT_DESCRIBE) ||
         ((tab->op= new JOIN_CACHE_BNL(join, tab, prev_cache)) &&
          !tab->op->init()))
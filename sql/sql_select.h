@@ -494,6 +494,7 @@ typedef struct st_position : public Sql_alloc
 struct st_cache_field;
 class QEP_operation;
 class Filesort;
+class Scan_filter;
 
 typedef struct st_join_table : public Sql_alloc
 {
@@ -562,6 +563,17 @@ public:
     NULL means no index condition pushdown was performed.
   */
   Item          *pre_idx_push_cond;
+  /*
+    Compiled conjuncts of the condition used when the table is scanned,
+    see Scan_filter. scan_filter_cond is the condition it was compiled
+    from, the filter is not used if the condition has changed since.
+    The constants may differ between executions of a prepared statement,
+    so the filter is compiled again when scan_filter_query_id is not the
+    current query.
+  */
+  Scan_filter   *scan_filter;
+  Item          *scan_filter_cond;
+  query_id_t    scan_filter_query_id;
   
   /* Special content for EXPLAIN 'Extra' column or NULL if none */
   Extra_tag     info;
@@ -902,6 +914,9 @@ st_join_table::st_join_table()
     first_upper(NULL),
     first_unmatched(NULL),
     pre_idx_push_cond(NULL),
+    scan_filter(NULL),
+    scan_filter_cond(NULL),
+    scan_filter_query_id(0),
     info(ET_none),
     packed_info(0),
     materialize_table(NULL),
@@ -56,6 +56,7 @@
 #include "sql_tmp_table.h" // Tmp tables
 #include "sql_optimizer.h" // JOIN
 #include "global_threads.h"
+#include "threadpool.h"     // tp_fill_queue_times
 
 #include <algorithm>
 using std::max;
@@ -2066,6 +2067,96 @@ static const char *thread_state_info(THD *tmp)
   }
 }
 
+/**
+  Collect the processlist information of the threads for
+  SHOW PROCESSLIST.
+*/
+
+class List_process_list : public Do_THD_Impl
+{
+public:
+  List_process_list(THD *thd, const char *user,
+                    Mem_root_array<thread_info*, true> *thread_infos,
+                    ulong max_query_length)
+    : m_client_thd(thd), m_user(user), m_thread_infos(thread_infos),
+      m_max_query_length(max_query_length)
+  {}
+
+  virtual void operator()(THD *tmp)
+  {
+    Security_context *tmp_sctx= tmp->security_ctx;
+    struct st_my_thread_var *mysys_var;
+    if ((tmp->vio_ok() || tmp->system_thread) &&
+        (!m_user || (!tmp->system_thread && tmp_sctx->user &&
+                     !strcmp(tmp_sctx->user, m_user)))
+        && !acl_is_utility_user(tmp_sctx->user, tmp_sctx->get_host()->ptr(),
+                                tmp_sctx->get_ip()->ptr()))
+    {
+      thread_info *thd_info= new thread_info;
+
+      thd_info->thread_id=tmp->thread_id;
+      thd_info->user= m_client_thd->strdup(tmp_sctx->user ? tmp_sctx->user :
+                                           (tmp->system_thread ?
+                                            "system user" :
+                                            "unauthenticated user"));
+      if (tmp->peer_port && (tmp_sctx->get_host()->length() ||
+          tmp_sctx->get_ip()->length()) &&
+          m_client_thd->security_ctx->host_or_ip[0])
+      {
+        if ((thd_info->host= (char*)
+             m_client_thd->alloc(LIST_PROCESS_HOST_LEN+1)))
+          my_snprintf((char *) thd_info->host, LIST_PROCESS_HOST_LEN,
+                      "%s:%u", tmp_sctx->host_or_ip, tmp->peer_port);
+      }
+      else
+        thd_info->host= m_client_thd->strdup(tmp_sctx->host_or_ip[0] ?
+                                             tmp_sctx->host_or_ip :
+                                             tmp_sctx->get_host()->length() ?
+                                             tmp_sctx->get_host()->ptr() : "");
+      thd_info->command=(int) tmp->get_command();
+      DBUG_EXECUTE_IF("processlist_acquiring_dump_threads_LOCK_thd_data",
+                      {
+                       if (thd_info->command == COM_BINLOG_DUMP ||
+                           thd_info->command == COM_BINLOG_DUMP_GTID)
+                         DEBUG_SYNC(m_client_thd,
+                                    "processlist_after_LOCK_thd_count_before_LOCK_thd_data");
+                      });
+      mysql_mutex_lock(&tmp->LOCK_thd_data);
+      if ((thd_info->db= tmp->db))             // Safe test
+        thd_info->db= m_client_thd->strdup(thd_info->db);
+      if ((mysys_var= tmp->mysys_var))
+        mysql_mutex_lock(&mysys_var->mutex);
+      thd_info->proc_info= (char*) (tmp->killed == THD::KILL_CONNECTION?
+                                    "Killed" : 0);
+      thd_info->state_info= thread_state_info(tmp);
+      if (mysys_var)
+        mysql_mutex_unlock(&mysys_var->mutex);
+
+      /* Lock THD mutex that protects its data when looking at it. */
+      if (tmp->query())
+      {
+        uint length= min<uint>(m_max_query_length, tmp->query_length());
+        char *q= m_client_thd->strmake(tmp->query(),length);
+        /* Safety: in case strmake failed, we set length to 0. */
+        thd_info->query_string=
+          CSET_STRING(q, q ? length : 0, tmp->query_charset());
+      }
+      thd_info->rows_sent= tmp->get_sent_row_count();
+      thd_info->rows_examined= tmp->get_examined_row_count();
+      mysql_mutex_unlock(&tmp->LOCK_thd_data);
+      thd_info->start_time= tmp->start_time.tv_sec;
+      m_thread_infos->push_back(thd_info);
+    }
+  }
+
+private:
+  THD *m_client_thd;
+  const char *m_user;
+  Mem_root_array<thread_info*, true> *m_thread_infos;
+  ulong m_max_query_length;
+};
+
+
 void mysqld_list_processes(THD *thd,const char *user, bool verbose)
 {
   Item *field;
@@ -2100,85 +2191,17 @@ void mysqld_list_processes(THD *thd,const char *user, bool verbose)
 
   if (!thd->killed)
   {
-    /* take copy of global_thread_list */
-    std::set<THD*> global_thread_list_copy;
     DEBUG_SYNC(thd,"before_copying_threads");
     /*
       Allow inserts to global_thread_list. Newly added thd
       will not be accounted for `show processlist` and
       removal from global_thread_list is blocked as LOCK_thd_remove
-      mutex is not released yet
+      mutexes are not released yet
      */
-    mysql_mutex_lock(&LOCK_thd_remove);
-    copy_global_thread_list(&global_thread_list_copy);
-
-    DEBUG_SYNC(thd,"after_copying_threads");
     thread_infos.reserve(get_thread_count());
-    Thread_iterator it= global_thread_list_copy.begin();
-    Thread_iterator end= global_thread_list_copy.end();
-    for (; it != end; ++it)
-    {
-      THD *tmp= *it;
-      Security_context *tmp_sctx= tmp->security_ctx;
-      struct st_my_thread_var *mysys_var;
-      if ((tmp->vio_ok() || tmp->system_thread) &&
-          (!user || (!tmp->system_thread && tmp_sctx->user &&
-                     !strcmp(tmp_sctx->user, user)))
-          && !acl_is_utility_user(tmp_sctx->user, tmp_sctx->get_host()->ptr(),
-                                  tmp_sctx->get_ip()->ptr()))
-      {
-        thread_info *thd_info= new thread_info;
-
-        thd_info->thread_id=tmp->thread_id;
-        thd_info->user= thd->strdup(tmp_sctx->user ? tmp_sctx->user :
-                                    (tmp->system_thread ?
-                                     "system user" : "unauthenticated user"));
-	if (tmp->peer_port && (tmp_sctx->get_host()->length() ||
-            tmp_sctx->get_ip()->length()) && thd->security_ctx->host_or_ip[0])
-	{
-	  if ((thd_info->host= (char*) thd->alloc(LIST_PROCESS_HOST_LEN+1)))
-	    my_snprintf((char *) thd_info->host, LIST_PROCESS_HOST_LEN,
-			"%s:%u", tmp_sctx->host_or_ip, tmp->peer_port);
-	}
-	else
-	  thd_info->host= thd->strdup(tmp_sctx->host_or_ip[0] ? 
-                                      tmp_sctx->host_or_ip : 
-                                      tmp_sctx->get_host()->length() ?
-                                      tmp_sctx->get_host()->ptr() : "");
-        thd_info->command=(int) tmp->get_command();
-        DBUG_EXECUTE_IF("processlist_acquiring_dump_threads_LOCK_thd_data",
-                        {
-                         if (thd_info->command == COM_BINLOG_DUMP ||
-                             thd_info->command == COM_BINLOG_DUMP_GTID)
-                           DEBUG_SYNC(thd, "processlist_after_LOCK_thd_count_before_LOCK_thd_data");
-                        });
-        mysql_mutex_lock(&tmp->LOCK_thd_data);
-        if ((thd_info->db= tmp->db))             // Safe test
-          thd_info->db= thd->strdup(thd_info->db);
-        if ((mysys_var= tmp->mysys_var))
-          mysql_mutex_lock(&mysys_var->mutex);
-        thd_info->proc_info= (char*) (tmp->killed == THD::KILL_CONNECTION? "Killed" : 0);
-        thd_info->state_info= thread_state_info(tmp);
-        if (mysys_var)
-          mysql_mutex_unlock(&mysys_var->mutex);
-
-        /* Lock THD mutex that protects its data when looking at it. */
-        if (tmp->query())
-        {
-          uint length= min<uint>(max_query_length, tmp->query_length());
-          char *q= thd->strmake(tmp->query(),length);
-          /* Safety: in case strmake failed, we set length to 0. */
-          thd_info->query_string=
-            CSET_STRING(q, q ? length : 0, tmp->query_charset());
-        }
-        thd_info->rows_sent= tmp->get_sent_row_count();
-        thd_info->rows_examined= tmp->get_examined_row_count();
-        mysql_mutex_unlock(&tmp->LOCK_thd_data);
-        thd_info->start_time= tmp->start_time.tv_sec;
-        thread_infos.push_back(thd_info);
-      }
-    }
-    mysql_mutex_unlock(&LOCK_thd_remove);
+    List_process_list list_process_list(thd, user, &thread_infos,
+                                        max_query_length);
+    do_for_all_thd_copy(&list_process_list);
   }
 
   // Return list sorted by thread_id.
@@ -2213,10 +2236,139 @@ void mysqld_list_processes(THD *thd,const char *user, bool verbose)
   DBUG_VOID_RETURN;
 }
 
+/**
+  Store the processlist information of the threads in
+  INFORMATION_SCHEMA.PROCESSLIST.
+*/
+
+class Fill_process_list : public Do_THD_Impl
+{
+public:
+  Fill_process_list(THD *thd, TABLE *table, const char *user, time_t now,
+                    ulonglong now_utime)
+    : m_client_thd(thd), m_table(table), m_user(user), m_now(now),
+      m_now_utime(now_utime), m_cs(system_charset_info), m_error(false)
+  {}
+
+  virtual void operator()(THD *tmp)
+  {
+    if (m_error)
+      return;
+    Security_context *tmp_sctx= tmp->security_ctx;
+    struct st_my_thread_var *mysys_var;
+    const char *val, *db;
+
+    if ((!tmp->vio_ok() && !tmp->system_thread) ||
+        (m_user && (tmp->system_thread || !tmp_sctx->user ||
+                    strcmp(tmp_sctx->user, m_user)))
+        || acl_is_utility_user(tmp_sctx->user, tmp_sctx->get_host()->ptr(),
+                               tmp_sctx->get_ip()->ptr()))
+      return;
+
+    restore_record(m_table, s->default_values);
+    /* ID */
+
+    m_table->field[0]->store((ulonglong) tmp->thread_id, TRUE);
+    /* USER */
+    val= tmp_sctx->user ? tmp_sctx->user :
+          (tmp->system_thread ? "system user" : "unauthenticated user");
+    m_table->field[1]->store(val, strlen(val), m_cs);
+    /* HOST */
+    if (tmp->peer_port && (tmp_sctx->get_host()->length() ||
+        tmp_sctx->get_ip()->length()) &&
+        m_client_thd->security_ctx->host_or_ip[0])
+    {
+      char host[LIST_PROCESS_HOST_LEN + 1];
+      my_snprintf(host, LIST_PROCESS_HOST_LEN, "%s:%u",
+                  tmp_sctx->host_or_ip, tmp->peer_port);
+      m_table->field[2]->store(host, strlen(host), m_cs);
+    }
+    else
+      m_table->field[2]->store(tmp_sctx->host_or_ip,
+                               strlen(tmp_sctx->host_or_ip), m_cs);
+    DBUG_EXECUTE_IF("processlist_acquiring_dump_threads_LOCK_thd_data",
+                    {
+                    if (tmp->get_command() == COM_BINLOG_DUMP ||
+                        tmp->get_command() == COM_BINLOG_DUMP_GTID)
+                    DEBUG_SYNC(m_client_thd,
+                               "processlist_after_LOCK_thd_count_before_LOCK_thd_data");
+                    });
+    /* DB */
+    mysql_mutex_lock(&tmp->LOCK_thd_data);
+    if ((db= tmp->db))
+    {
+      m_table->field[3]->store(db, strlen(db), m_cs);
+      m_table->field[3]->set_notnull();
+    }
+
+    if ((mysys_var= tmp->mysys_var))
+      mysql_mutex_lock(&mysys_var->mutex);
+    /* COMMAND */
+    if ((val= (char *) (tmp->killed == THD::KILL_CONNECTION? "Killed" : 0)))
+      m_table->field[4]->store(val, strlen(val), m_cs);
+    else
+      m_table->field[4]->store(command_name[tmp->get_command()].str,
+                               command_name[tmp->get_command()].length, m_cs);
+    /* MYSQL_TIME */
+    longlong value_in_time_column= 0;
+    if(tmp->start_time.tv_sec)
+    {
+      value_in_time_column = (m_now - tmp->start_time.tv_sec);
+      if(value_in_time_column > m_now)
+      {
+        value_in_time_column= 0;
+      }
+    }
+    m_table->field[5]->store(value_in_time_column, FALSE);
+
+    /* STATE */
+    if ((val= thread_state_info(tmp)))
+    {
+      m_table->field[6]->store(val, strlen(val), m_cs);
+      m_table->field[6]->set_notnull();
+    }
+
+    if (mysys_var)
+      mysql_mutex_unlock(&mysys_var->mutex);
+    /* INFO */
+    if (tmp->query())
+    {
+      size_t const width=
+        min<size_t>(PROCESS_LIST_INFO_WIDTH, tmp->query_length());
+      m_table->field[7]->store(tmp->query(), width, m_cs);
+      m_table->field[7]->set_notnull();
+    }
+
+    /* TIME_MS */
+    ulonglong tmp_start_utime= tmp->start_utime;
+    m_table->field[8]->store(((tmp_start_utime < m_now_utime ?
+                               m_now_utime - tmp_start_utime : 0)/ 1000));
+
+    /* ROWS_SENT */
+    m_table->field[9]->store((ulonglong) tmp->get_sent_row_count());
+    /* ROWS_EXAMINED */
+    m_table->field[10]->store((ulonglong) tmp->get_examined_row_count());
+    mysql_mutex_unlock(&tmp->LOCK_thd_data);
+
+    if (schema_table_store_record(m_client_thd, m_table))
+      m_error= true;
+  }
+
+  bool has_error() const { return m_error; }
+
+private:
+  THD *m_client_thd;
+  TABLE *m_table;
+  const char *m_user;
+  time_t m_now;
+  ulonglong m_now_utime;
+  const CHARSET_INFO *m_cs;
+  bool m_error;
+};
+
+
 int fill_schema_processlist(THD* thd, TABLE_LIST* tables, Item* cond)
 {
-  TABLE *table= tables->table;
-  CHARSET_INFO *cs= system_charset_info;
   char *user;
   time_t now;
   ulonglong now_utime= my_micro_time_and_time(&now);
@@ -2229,123 +2381,17 @@ int fill_schema_processlist(THD* thd, TABLE_LIST* tables, Item* cond)
 
   if (!thd->killed)
   {
-    /* take copy of global_thread_list */
-    std::set<THD*> global_thread_list_copy;
     /*
       Allow inserts to global_thread_list. Newly added thd
       will not be accounted for `fill schema processlist` and
       removal from global_thread_list is blocked as LOCK_thd_remove
-      mutex is not released yet
+      mutexes are not released yet
      */
-    mysql_mutex_lock(&LOCK_thd_remove);
-    copy_global_thread_list(&global_thread_list_copy);
-
-    Thread_iterator it= global_thread_list_copy.begin();
-    Thread_iterator end= global_thread_list_copy.end();
-    for (; it != end; ++it)
-    {
-      THD* tmp= *it;
-      Security_context *tmp_sctx= tmp->security_ctx;
-      struct st_my_thread_var *mysys_var;
-      const char *val, *db;
-
-      if ((!tmp->vio_ok() && !tmp->system_thread) ||
-          (user && (tmp->system_thread || !tmp_sctx->user ||
-                    strcmp(tmp_sctx->user, user)))
-          || acl_is_utility_user(tmp_sctx->user, tmp_sctx->get_host()->ptr(),
-                                 tmp_sctx->get_ip()->ptr()))
-        continue;
-
-      restore_record(table, s->default_values);
-      /* ID */
-
-      table->field[0]->store((ulonglong) tmp->thread_id, TRUE);
-      /* USER */
-      val= tmp_sctx->user ? tmp_sctx->user :
-            (tmp->system_thread ? "system user" : "unauthenticated user");
-      table->field[1]->store(val, strlen(val), cs);
-      /* HOST */
-      if (tmp->peer_port && (tmp_sctx->get_host()->length() ||
-          tmp_sctx->get_ip()->length()) && thd->security_ctx->host_or_ip[0])
-      {
-        char host[LIST_PROCESS_HOST_LEN + 1];
-        my_snprintf(host, LIST_PROCESS_HOST_LEN, "%s:%u",
-                    tmp_sctx->host_or_ip, tmp->peer_port);
-        table->field[2]->store(host, strlen(host), cs);
-      }
-      else
-        table->field[2]->store(tmp_sctx->host_or_ip,
-                               strlen(tmp_sctx->host_or_ip), cs);
-      DBUG_EXECUTE_IF("processlist_acquiring_dump_threads_LOCK_thd_data",
-                      {
-                      if (tmp->get_command() == COM_BINLOG_DUMP ||
-                          tmp->get_command() == COM_BINLOG_DUMP_GTID)
-                      DEBUG_SYNC(thd, "processlist_after_LOCK_thd_count_before_LOCK_thd_data");
-                      });
-      /* DB */
-      mysql_mutex_lock(&tmp->LOCK_thd_data);
-      if ((db= tmp->db))
-      {
-        table->field[3]->store(db, strlen(db), cs);
-        table->field[3]->set_notnull();
-      }
-
-      if ((mysys_var= tmp->mysys_var))
-        mysql_mutex_lock(&mysys_var->mutex);
-      /* COMMAND */
-      if ((val= (char *) (tmp->killed == THD::KILL_CONNECTION? "Killed" : 0)))
-        table->field[4]->store(val, strlen(val), cs);
-      else
-        table->field[4]->store(command_name[tmp->get_command()].str,
-                               command_name[tmp->get_command()].length, cs);
-      /* MYSQL_TIME */
-      longlong value_in_time_column= 0;
-      if(tmp->start_time.tv_sec)
-      {
-        value_in_time_column = (now - tmp->start_time.tv_sec);
-        if(value_in_time_column > now)
-        {
-          value_in_time_column= 0;
-        }
-      }
-      table->field[5]->store(value_in_time_column, FALSE);
-
-      /* STATE */
-      if ((val= thread_state_info(tmp)))
-      {
-        table->field[6]->store(val, strlen(val), cs);
-        table->field[6]->set_notnull();
-      }
-
-      if (mysys_var)
-        mysql_mutex_unlock(&mysys_var->mutex);
-      /* INFO */
-      if (tmp->query())
-      {
-        size_t const width=
-          min<size_t>(PROCESS_LIST_INFO_WIDTH, tmp->query_length());
-        table->field[7]->store(tmp->query(), width, cs);
-        table->field[7]->set_notnull();
-      }
-
-      /* TIME_MS */
-      ulonglong tmp_start_utime= tmp->start_utime;
-      table->field[8]->store(((tmp_start_utime < now_utime ?
-                               now_utime - tmp_start_utime : 0)/ 1000));
-
-      /* ROWS_SENT */
-      table->field[9]->store((ulonglong) tmp->get_sent_row_count());
-      /* ROWS_EXAMINED */
-      table->field[10]->store((ulonglong) tmp->get_examined_row_count());
-      mysql_mutex_unlock(&tmp->LOCK_thd_data);
-
-      if (schema_table_store_record(thd, table))
-      {
-        mysql_mutex_unlock(&LOCK_thd_remove);
-        DBUG_RETURN(1);
-      }
-    }
-    mysql_mutex_unlock(&LOCK_thd_remove);
+    Fill_process_list fill_process_list(thd, tables->table, user, now,
+                                        now_utime);
+    do_for_all_thd_copy(&fill_process_list);
+    if (fill_process_list.has_error())
+      DBUG_RETURN(1);
   }
 
   DBUG_RETURN(0);
@@ -2942,6 +2988,20 @@ int fill_schema_client_stats(THD* thd, TABLE_LIST* tables, Item* cond)
   DBUG_RETURN(1);
 }
 
+int fill_thread_pool_queue_times(THD* thd, TABLE_LIST* tables, Item* cond)
+{
+  DBUG_ENTER("fill_thread_pool_queue_times");
+
+  if (check_global_access(thd, SUPER_ACL | PROCESS_ACL))
+    DBUG_RETURN(1);
+
+#if defined(HAVE_POOL_OF_THREADS) && !defined(_WIN32)
+  DBUG_RETURN(tp_fill_queue_times(thd, tables->table));
+#else
+  DBUG_RETURN(0);
+#endif
+}
+
 int fill_schema_thread_stats(THD* thd, TABLE_LIST* tables, Item* cond)
 {
   TABLE *table= tables->table;
@@ -3056,24 +3116,33 @@ int fill_schema_index_stats(THD* thd, TABLE_LIST* tables, Item* cond)
 }
 
 
+class Add_status : public Do_THD_Impl
+{
+public:
+  Add_status(STATUS_VAR* value) : m_stat_var(value) {}
+
+  virtual void operator()(THD *thd)
+  {
+    add_to_status(m_stat_var, &thd->status_var);
+  }
+
+private:
+  STATUS_VAR *m_stat_var;
+};
+
+
 /* collect status for all running threads */
 
 void calc_sum_of_all_status(STATUS_VAR *to)
 {
   DBUG_ENTER("calc_sum_of_all_status");
 
-  mysql_mutex_lock(&LOCK_thread_count);
-
-  Thread_iterator it= global_thread_list_begin();
-  Thread_iterator end= global_thread_list_end();
   /* Get global values as base */
   *to= global_status_var;
-  
+
   /* Add to this status from existing threads */
-  for (; it != end; ++it)
-    add_to_status(to, &(*it)->status_var);
-  
-  mysql_mutex_unlock(&LOCK_thread_count);
+  Add_status add_status(to);
+  do_for_all_thd(&add_status);
   DBUG_VOID_RETURN;
 }
 
@@ -4204,23 +4273,23 @@ static int store_temporary_table_record(THD *thd, TABLE *table, TABLE *tmp_table
     @retval       1                        error
 */
 
-static int fill_global_temporary_tables(THD *thd, TABLE_LIST *tables, Item *cond)
+class Fill_global_temporary_tables : public Do_THD_Impl
 {
-  DBUG_ENTER("fill_global_temporary_tables");
-
-  mysql_mutex_lock(&LOCK_thread_count);
-
-  Thread_iterator it= global_thread_list_begin();
-  Thread_iterator end= global_thread_list_end();
-  THD *thd_item;
-  TABLE *tmp;
+public:
+  Fill_global_temporary_tables(THD *thd, TABLE_LIST *tables)
+    : m_client_thd(thd), m_tables(tables), m_error(false)
+  {}
 
+  virtual void operator()(THD *thd_item)
+  {
+    TABLE *tmp;
 #ifndef NO_EMBEDDED_ACCESS_CHECKS
-  Security_context *sctx= thd->security_ctx;
-  uint db_access;
+    Security_context *sctx= m_client_thd->security_ctx;
+    uint db_access;
 #endif
- 
-  while (it != end && (thd_item=*(it++))) {
+
+    if (m_error)
+      return;
     mysql_mutex_lock(&thd_item->LOCK_temporary_tables);
     for (tmp=thd_item->temporary_tables; tmp; tmp=tmp->next) {
 
@@ -4232,27 +4301,42 @@ static int fill_global_temporary_tables(THD *thd, TABLE_LIST *tables, Item *cond
                             sctx->priv_user, tmp->s->db.str, 0)
                     | sctx->master_access);
 
-      if (!(db_access & DB_ACLS) && check_grant_db(thd,tmp->s->db.str)) {
+      if (!(db_access & DB_ACLS) &&
+          check_grant_db(m_client_thd, tmp->s->db.str)) {
         //no access for temp tables within this db for user
         continue;
       }
 #endif
 
-      DEBUG_SYNC(thd, "fill_global_temporary_tables_before_storing_rec");
+      DEBUG_SYNC(m_client_thd,
+                 "fill_global_temporary_tables_before_storing_rec");
 
-      if (store_temporary_table_record(thd_item, tables->table, tmp,
-                                       thd->lex->select_lex.db)) {
-        mysql_mutex_unlock(&thd_item->LOCK_temporary_tables);
-        mysql_mutex_unlock(&LOCK_thread_count); 
-        DBUG_RETURN(1);
+      if (store_temporary_table_record(thd_item, m_tables->table, tmp,
+                                       m_client_thd->lex->select_lex.db)) {
+        m_error= true;
+        break;
       }
 
     }
     mysql_mutex_unlock(&thd_item->LOCK_temporary_tables);
   }
 
-  mysql_mutex_unlock(&LOCK_thread_count); 
-  DBUG_RETURN(0);
+  bool has_error() const { return m_error; }
+
+private:
+  THD *m_client_thd;
+  TABLE_LIST *m_tables;
+  bool m_error;
+};
+
+
+static int fill_global_temporary_tables(THD *thd, TABLE_LIST *tables, Item *cond)
+{
+  DBUG_ENTER("fill_global_temporary_tables");
+
+  Fill_global_temporary_tables fill_temporary_tables(thd, tables);
+  do_for_all_thd(&fill_temporary_tables);
+  DBUG_RETURN(fill_temporary_tables.has_error());
 }
 
 /**
@@ -8720,6 +8804,21 @@ ST_FIELD_INFO client_stats_fields_info[]=
   {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, 0}
 };
 
+ST_FIELD_INFO thread_pool_queue_times_fields_info[]=
+{
+  {"RESOURCE_GROUP", NAME_CHAR_LEN, MYSQL_TYPE_STRING, 0, 0, "Resource_group",
+   SKIP_OPEN_TABLE},
+  {"WEIGHT", 4, MYSQL_TYPE_LONG, 0, MY_I_S_UNSIGNED, "Weight",
+   SKIP_OPEN_TABLE},
+  {"TIME", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED | MY_I_S_MAYBE_NULL, "Time", SKIP_OPEN_TABLE},
+  {"COUNT", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, "Count", SKIP_OPEN_TABLE},
+  {"TOTAL", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, "Total", SKIP_OPEN_TABLE},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE}
+};
+
 ST_FIELD_INFO thread_stats_fields_info[]=
 {
   {"THREAD_ID", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
@@ -9079,6 +9178,9 @@ ST_SCHEMA_TABLE schema_tables[]=
   {"TEMPORARY_TABLES", temporary_table_fields_info, create_schema_table,
    fill_temporary_tables, make_temporary_tables_old_format, 0, 2, 3, 0,
    OPEN_TABLE_ONLY|OPTIMIZE_I_S_TABLE},
+  {"THREAD_POOL_QUEUE_TIMES", thread_pool_queue_times_fields_info,
+   create_schema_table, fill_thread_pool_queue_times, make_old_format, 0, -1,
+   -1, 0, 0},
   {"THREAD_STATISTICS", thread_stats_fields_info, create_schema_table,
     fill_schema_thread_stats, make_old_format, 0, -1, -1, 0, 0},
   {"TRIGGERS", triggers_fields_info, create_schema_table,
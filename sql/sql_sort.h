@@ -79,6 +79,7 @@ public:
   uint addon_length;          // Length of added packed fields.
   uint res_length;            // Length of records in final sorted file/buffer.
   uint max_keys_per_buffer;   // Max keys / buffer.
+  uint sort_threads;          // Max threads sorting a buffer.
   ha_rows max_rows;           // Select limit, or HA_POS_ERROR if unlimited.
   ha_rows examined_rows;      // Number of examined rows.
   TABLE *sort_form;           // For quicker make_sortkey.
@@ -22,6 +22,7 @@
 #include "opt_trace.h"
 #include "debug_sync.h"
 #include "filesort.h"   // filesort_free_buffers
+#include "keycaches.h"  // get_or_create_key_cache
 
 #include <algorithm>
 using std::max;
@@ -457,6 +458,7 @@ create_tmp_table(THD *thd,TMP_TABLE_PARAM *param,List<Item> &fields,
   uint fieldnr= 0;
   ulong reclength, string_total_length;
   bool  using_unique_constraint= false;
+  bool  blob_in_key= false;
   bool  use_packed_rows= false;
   bool  not_all_columns= !(select_options & TMP_TABLE_ALL_COLUMNS);
   char  *tmpname,path[FN_REFLEN];
@@ -800,9 +802,34 @@ update_hidden:
   *blob_field= 0;				// End marker
   share->fields= field_count;
 
+  /*
+    MEMORY keeps BLOBs in variable-size records but cannot index them, so
+    BLOBs only force MyISAM when a key of the table would cover one, or
+    when duplicates may have to be removed from it (remove_duplicates()
+    cannot do that for a MEMORY table with BLOBs).
+    INFORMATION_SCHEMA tables keep the format CREATE TABLE ... LIKE copies.
+    MEMORY does not store GEOMETRY columns at all.
+  */
+  if (blob_count && !using_unique_constraint)
+  {
+    if (distinct || (select_options & SELECT_DISTINCT) || param->schema_table)
+      blob_in_key= true;
+    for (Field **field= table->field; *field && !blob_in_key; field++)
+    {
+      if ((*field)->type() == MYSQL_TYPE_GEOMETRY)
+        blob_in_key= true;
+    }
+    for (ORDER *tmp= group; tmp && !blob_in_key; tmp= tmp->next)
+    {
+      Field *field= (*tmp->item)->get_tmp_table_field();
+      if (!field || (field->flags & BLOB_FLAG))
+        blob_in_key= true;
+    }
+  }
+
   /* If result table is small; use a heap */
   /* future: storage engine selection can be made dynamic? */
-  if (blob_count || using_unique_constraint
+  if (blob_in_key || using_unique_constraint
       || (thd->variables.big_tables && !(select_options & SELECT_SMALL_RESULT))
       || (select_options & TMP_TABLE_FORCE_MYISAM))
   {
@@ -857,6 +884,14 @@ update_hidden:
 
   if (!use_packed_rows)
     share->db_create_options&= ~HA_OPTION_PACK_RECORD;
+  else if (share->db_type() == heap_hton && !param->schema_table)
+  {
+    /*
+      Let MEMORY store the rows in variable-size chunks instead of
+      padding every VARCHAR to its full width.
+    */
+    share->row_type= ROW_TYPE_DYNAMIC;
+  }
 
   share->reclength= reclength;
   {
@@ -1694,6 +1729,10 @@ bool create_myisam_tmp_table(TABLE *table, KEY *keyinfo,
       keydef.flag= keyinfo->flags;
       keydef.keysegs=  keyinfo->user_defined_key_parts;
       keydef.seg= seg;
+      /* Match the index pages to the blocks of the key cache they go to */
+      KEY_CACHE *key_cache= myisam_internal_key_cache;
+      if (key_cache && key_cache->can_be_used)
+        keydef.block_length= key_cache->key_cache_block_size;
     }
     for (uint i=0; i < keyinfo->user_defined_key_parts ; i++,seg++)
     {
@@ -1904,6 +1943,36 @@ free_tmp_table(THD *thd, TABLE *entry)
   DBUG_VOID_RETURN;
 }
 
+/**
+  Make MyISAM use the key cache named by internal_tmp_disk_key_cache for
+  the indexes of on-disk internal temporary tables. The key cache is
+  created, empty, if it does not exist yet; until it is given a size, the
+  tables keep using the default key cache.
+
+  The caller must hold LOCK_global_system_variables.
+
+  @return true if the key cache could not be created
+*/
+
+bool update_internal_tmp_disk_key_cache()
+{
+  bool error= false;
+  mysql_mutex_assert_owner(&LOCK_global_system_variables);
+  const char *name= opt_internal_tmp_disk_key_cache;
+  if (name == NULL || name[0] == '\0')
+    myisam_internal_key_cache= NULL;
+  else
+  {
+    KEY_CACHE *key_cache= get_or_create_key_cache(name, strlen(name));
+    if (key_cache == NULL)
+      error= true;
+    else
+      myisam_internal_key_cache= key_cache;
+  }
+  return error;
+}
+
+
 /**
   If a MEMORY table gets full, create a disk-based table and copy all rows
   to this.
@@ -2031,8 +2100,13 @@ bool create_myisam_from_heap(THD *thd, TABLE *table,
     is safe as this is a temporary MyISAM table without timestamp/autoincrement
     or partitioning.
   */
-  while (!table->file->ha_rnd_next(new_table.record[1]))
+  for (;;)
   {
+    int read_err= table->file->ha_rnd_next(new_table.record[1]);
+    if (read_err == HA_ERR_RECORD_DELETED)
+      continue;                         // Continuation of a dynamic row
+    if (read_err)
+      break;
     write_err= new_table.file->ha_write_row(new_table.record[1]);
     DBUG_EXECUTE_IF("raise_error", write_err= HA_ERR_FOUND_DUPP_KEY ;);
     if (write_err)
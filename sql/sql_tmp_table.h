@@ -57,6 +57,7 @@ bool create_myisam_from_heap(THD *thd, TABLE *table,
 			     int error, bool ignore_last_dup,
                              bool *is_duplicate);
 void free_tmp_table(THD *thd, TABLE *entry);
+bool update_internal_tmp_disk_key_cache();
 TABLE *create_duplicate_weedout_tmp_table(THD *thd, 
                                           uint uniq_tuple_length_arg,
                                           SJ_TMP_TABLE *sjtbl);
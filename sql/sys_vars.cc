@@ -58,6 +58,8 @@
 #include "hostname.h"                           // host_cache_size
 #include "sql_show.h"                           // opt_ignore_db_dirs
 #include "table_cache.h"                        // Table_cache_manager
+#include "sql_plan_cache.h"                     // plan_cache
+#include "sql_tmp_table.h"                      // update_internal_tmp_disk_key_cache
 #include "my_aes.h" // my_aes_opmode_names
 
 #include "log_event.h"
@@ -1958,10 +1960,13 @@ static Sys_var_ulong Sys_metadata_locks_cache_size(
        BLOCK_SIZE(1));
 
 static Sys_var_ulong Sys_metadata_locks_hash_instances(
-       "metadata_locks_hash_instances", "Number of metadata locks hash instances",
+       "metadata_locks_hash_instances",
+       "Number of metadata locks hash instances. This variable is deprecated "
+       "and has no effect, as metadata locks are kept in a lock-free hash.",
        READ_ONLY GLOBAL_VAR(mdl_locks_hash_partitions), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(1, 1024), DEFAULT(MDL_LOCKS_HASH_PARTITIONS_DEFAULT),
-       BLOCK_SIZE(1));
+       BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+       ON_UPDATE(0), DEPRECATED(""));
 
 static Sys_var_ulong Sys_pseudo_thread_id(
        "pseudo_thread_id",
@@ -2016,6 +2021,13 @@ static Sys_var_ulong Sys_max_length_for_sort_data(
        SESSION_VAR(max_length_for_sort_data), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(4, 8192*1024L), DEFAULT(1024), BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_max_parallel_degree(
+       "max_parallel_degree",
+       "Maximum number of threads a single query may use to scan a table "
+       "in a storage engine or to sort rows. 1 disables parallel execution",
+       SESSION_VAR(max_parallel_degree), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 256), DEFAULT(1), BLOCK_SIZE(1));
+
 static PolyLock_mutex PLock_prepared_stmt_count(&LOCK_prepared_stmt_count);
 static Sys_var_ulong Sys_max_prepared_stmt_count(
        "max_prepared_stmt_count",
@@ -2215,6 +2227,21 @@ static Sys_var_ulong Sys_optimizer_search_depth(
        SESSION_VAR(optimizer_search_depth), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(0, MAX_TABLES+1), DEFAULT(MAX_TABLES+1), BLOCK_SIZE(1));
 
+static bool fix_plan_cache_size(sys_var *self, THD *thd, enum_var_type type)
+{
+  plan_cache.resize();
+  return false;
+}
+static Sys_var_ulong Sys_plan_cache_size(
+       "plan_cache_size",
+       "Maximum number of join orders of query blocks kept in the plan "
+       "cache, to be reused by later executions of the same prepared "
+       "statement or of queries with the same digest. 0 disables the cache",
+       GLOBAL_VAR(plan_cache_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 1024*1024), DEFAULT(0), BLOCK_SIZE(1),
+       NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+       ON_UPDATE(fix_plan_cache_size));
+
 static const char *optimizer_switch_names[]=
 {
   "index_merge", "index_merge_union", "index_merge_sort_union",
@@ -2225,7 +2252,7 @@ static const char *optimizer_switch_names[]=
   "materialization", "semijoin", "loosescan", "firstmatch",
   "subquery_materialization_cost_based",
 #endif
-  "use_index_extensions", "default", NullS
+  "use_index_extensions", "hash_join", "hash_group_by", "default", NullS
 };
 /** propagates changes to @@engine_condition_pushdown */
 static bool fix_optimizer_switch(sys_var *self, THD *thd,
@@ -2247,8 +2274,8 @@ static Sys_var_flagset Sys_optimizer_switch(
        ", materialization, semijoin, loosescan, firstmatch,"
        " subquery_materialization_cost_based"
 #endif
-       ", block_nested_loop, batched_key_access, use_index_extensions"
-       "} and val is one of {on, off, default}",
+       ", block_nested_loop, batched_key_access, use_index_extensions,"
+       " hash_join, hash_group_by} and val is one of {on, off, default}",
        SESSION_VAR(optimizer_switch), CMD_LINE(REQUIRED_ARG),
        optimizer_switch_names, DEFAULT(OPTIMIZER_SWITCH_DEFAULT),
        NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(NULL),
@@ -2724,6 +2751,14 @@ static Sys_var_mybool Sys_query_cache_strip_comments(
        GLOBAL_VAR(opt_query_cache_strip_comments), CMD_LINE(OPT_ARG),
        DEFAULT(FALSE));
 
+static Sys_var_uint Sys_query_cache_partitions(
+       "query_cache_partitions",
+       "Number of partitions of the query cache. Each partition has its own "
+       "lock and an equal share of query_cache_size, queries are assigned "
+       "to the partitions by a hash of their text",
+       READ_ONLY GLOBAL_VAR(query_cache_partitions), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 64), DEFAULT(1), BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_query_cache_limit(
        "query_cache_limit",
        "Don't cache results that are bigger than this",
@@ -3248,6 +3283,20 @@ static bool fix_threadpool_stall_limit(sys_var*, THD*, enum_var_type)
   tp_set_threadpool_stall_limit(threadpool_stall_limit);
   return false;
 }
+
+
+static bool check_threadpool_resource_groups(sys_var *self, THD *thd,
+                                             set_var *var)
+{
+  return tp_check_resource_groups(var->save_result.string_value.str);
+}
+
+
+static bool fix_threadpool_resource_groups(sys_var*, THD*, enum_var_type)
+{
+  tp_set_resource_groups(threadpool_resource_groups);
+  return false;
+}
 #endif
 
 #ifdef _WIN32
@@ -3316,6 +3365,29 @@ static Sys_var_enum Sys_threadpool_high_prio_mode(
   SESSION_VAR(threadpool_high_prio_mode), CMD_LINE(REQUIRED_ARG),
   threadpool_high_prio_mode_names, DEFAULT(TP_HIGH_PRIO_MODE_TRANSACTIONS));
 
+static Sys_var_charptr Sys_threadpool_resource_groups(
+  "thread_pool_resource_groups",
+  "Resource groups of the thread pool, as a list of "
+  "name:weight:account,account,... entries separated by semicolons, "
+  "where an account is user@host or user. The low priority queue of each "
+  "thread group is split by resource group, and the queues are served in "
+  "proportion to the weights of the groups. Accounts that are not listed "
+  "are in the group named default, which has weight 1 unless set with a "
+  "default:weight entry.",
+  GLOBAL_VAR(threadpool_resource_groups), CMD_LINE(REQUIRED_ARG),
+  IN_SYSTEM_CHARSET, DEFAULT(""), NO_MUTEX_GUARD, NOT_IN_BINLOG,
+  ON_CHECK(check_threadpool_resource_groups),
+  ON_UPDATE(fix_threadpool_resource_groups));
+
+static Sys_var_mybool Sys_threadpool_numa(
+  "thread_pool_numa",
+  "Bind the thread groups of the thread pool to the NUMA nodes of the "
+  "server, round robin, and serve every client connection by a thread "
+  "group on the node where the network packets of its socket are "
+  "processed.",
+  READ_ONLY GLOBAL_VAR(threadpool_numa), CMD_LINE(OPT_ARG),
+  DEFAULT(FALSE));
+
 #endif /* !WIN32 */
 static Sys_var_uint Sys_threadpool_max_threads(
   "thread_pool_max_threads",
@@ -3420,6 +3492,25 @@ static Sys_var_ulonglong Sys_tmp_table_size(
        VALID_RANGE(1024, (ulonglong)~(intptr)0), DEFAULT(16*1024*1024),
        BLOCK_SIZE(1));
 
+static bool fix_internal_tmp_disk_key_cache(sys_var *self, THD *thd,
+                                            enum_var_type type)
+{
+  if (update_internal_tmp_disk_key_cache())
+  {
+    my_error(ER_OUT_OF_RESOURCES, MYF(0));
+    return true;
+  }
+  return false;
+}
+static Sys_var_charptr Sys_internal_tmp_disk_key_cache(
+       "internal_tmp_disk_key_cache",
+       "Name of the key cache used for the indexes of on-disk internal "
+       "temporary tables, which are then created with index blocks of the "
+       "key cache block size. An empty value means the default key cache",
+       GLOBAL_VAR(opt_internal_tmp_disk_key_cache), CMD_LINE(REQUIRED_ARG),
+       IN_SYSTEM_CHARSET, DEFAULT(""), NO_MUTEX_GUARD, NOT_IN_BINLOG,
+       ON_CHECK(0), ON_UPDATE(fix_internal_tmp_disk_key_cache));
+
 static Sys_var_mybool Sys_timed_mutexes(
        "timed_mutexes",
        "Specify whether to time mutexes. Deprecated, has no effect.",
@@ -14,6 +14,8 @@
    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
 
 #define MAX_THREAD_GROUPS 128
+#define MAX_RESOURCE_GROUPS 16
+#define MAX_RESOURCE_GROUP_ACCOUNTS 64
 
 enum tp_high_prio_mode_t {
   TP_HIGH_PRIO_MODE_TRANSACTIONS,
@@ -28,6 +30,8 @@ extern uint threadpool_size; /* Number of parallel executing threads */
 extern uint threadpool_stall_limit;  /* time interval in 10 ms units for stall checks*/
 extern uint threadpool_max_threads;  /* Maximum threads in pool */
 extern uint threadpool_oversubscribe;  /* Maximum active threads in group */
+extern char *threadpool_resource_groups; /* Resource groups of accounts */
+extern my_bool threadpool_numa; /* Bind thread groups to NUMA nodes */
 
 /* Possible values for thread_pool_high_prio_mode */
 extern const char *threadpool_high_prio_mode_names[];
@@ -69,6 +73,11 @@ extern void tp_set_min_threads(uint val);
 extern void tp_set_max_threads(uint val);
 extern void tp_set_threadpool_size(uint val);
 extern void tp_set_threadpool_stall_limit(uint val);
+extern bool tp_check_resource_groups(const char *val);
+extern bool tp_set_resource_groups(const char *val);
+
+/* Fills INFORMATION_SCHEMA.THREAD_POOL_QUEUE_TIMES */
+extern int tp_fill_queue_times(THD *thd, TABLE *table);
 
 /* Activate threadpool scheduler */
 extern void tp_scheduler(void);
@@ -35,6 +35,8 @@ uint threadpool_size;
 uint threadpool_stall_limit;
 uint threadpool_max_threads;
 uint threadpool_oversubscribe;
+char *threadpool_resource_groups;
+my_bool threadpool_numa;
 
 /* Stats */
 TP_STATISTICS tp_stats;
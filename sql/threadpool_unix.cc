@@ -26,12 +26,17 @@
 #include <sql_plist.h>
 #include <threadpool.h>
 #include <global_threads.h>
+#include <sql_show.h>
+#include <my_bit.h>
 #include <mysql/thread_pool_priv.h>             // thd_is_transaction_active()
 #include <time.h>
 #ifdef __linux__
 #include <sys/epoll.h>
 typedef struct epoll_event native_event;
 #endif
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
 #if defined (__FreeBSD__) || defined (__APPLE__)
 #include <sys/event.h>
 typedef struct kevent native_event;
@@ -48,6 +53,15 @@ typedef port_event_t native_event;
 for stall detection to kick in */
 #define THREADPOOL_CREATE_THREADS_ON_WAIT
 
+/**
+  Number of buckets of the queue time histograms. Bucket i counts the events
+  that waited up to 2^i microseconds, the last one counts longer waits.
+*/
+#define QUEUE_TIME_BUCKETS 24
+
+/** Pass of a resource group of weight 1 in the weighted fair scheduling */
+#define RESOURCE_GROUP_STRIDE (1U << 20)
+
 /* Possible values for thread_pool_high_prio_mode */
 const char *threadpool_high_prio_mode_names[]= {"transactions", "statements",
                                                  "none", NullS};
@@ -65,10 +79,12 @@ static bool threadpool_started= false;
 #ifdef HAVE_PSI_INTERFACE
 static PSI_mutex_key key_group_mutex;
 static PSI_mutex_key key_timer_mutex;
+static PSI_mutex_key key_resource_groups_mutex;
 static PSI_mutex_info mutex_list[]=
 {
   { &key_group_mutex, "group_mutex", 0},
-  { &key_timer_mutex, "timer_mutex", PSI_FLAG_GLOBAL}
+  { &key_timer_mutex, "timer_mutex", PSI_FLAG_GLOBAL},
+  { &key_resource_groups_mutex, "resource_groups_mutex", PSI_FLAG_GLOBAL}
 };
 
 static PSI_cond_key key_worker_cond;
@@ -125,6 +141,18 @@ struct connection_t
   bool bound_to_poll_descriptor;
   bool waiting;
   uint tickets;
+  /* Time the connection was put into a queue, in microseconds */
+  ulonglong enqueue_time;
+  /*
+    Resource group of the connection, chosen for the account below with
+    the resource_groups_version configuration.
+  */
+  uint resource_group;
+  int32 resource_group_version;
+  char resource_group_user[USERNAME_LENGTH];
+  char resource_group_host[MAX_HOSTNAME];
+  /* NUMA node the client socket is served on, -1 if unknown */
+  int numa_node;
 };
 
 typedef I_P_List<connection_t,
@@ -138,8 +166,19 @@ connection_queue_t;
 struct thread_group_t 
 {
   mysql_mutex_t mutex;
-  connection_queue_t queue;
+  /* Low priority queues, one per resource group */
+  connection_queue_t queue[MAX_RESOURCE_GROUPS];
   connection_queue_t high_prio_queue;
+  /* Bit i is set if queue[i] is not empty */
+  uint queue_mask;
+  /*
+    Weighted fair scheduling of the low priority queues: the non-empty queue
+    with the smallest pass is served first, and its pass is advanced by the
+    stride of its resource group. queue_vtime is the pass of the last
+    served queue.
+  */
+  ulonglong queue_pass[MAX_RESOURCE_GROUPS];
+  ulonglong queue_vtime;
   worker_list_t waiting_threads; 
   worker_thread_t *listener;
   pthread_attr_t *pthread_attr;
@@ -155,6 +194,11 @@ struct thread_group_t
   int  shutdown_pipe[2];
   bool shutdown;
   bool stalled;
+  /* NUMA node the threads of the group run on, -1 if not bound */
+  int numa_node;
+  /* Queue time histograms, by resource group */
+  ulonglong queue_time_count[MAX_RESOURCE_GROUPS][QUEUE_TIME_BUCKETS];
+  ulonglong queue_time_total[MAX_RESOURCE_GROUPS][QUEUE_TIME_BUCKETS];
   
 } MY_ALIGNED(512);
 
@@ -167,6 +211,46 @@ static uint group_count;
 */
 static ulonglong pool_block_start;
 
+/*
+  Resource groups, see thread_pool_resource_groups. Group 0 is the default
+  group of the accounts that are not listed.
+*/
+struct resource_group_t
+{
+  char name[NAME_CHAR_LEN + 1];
+  uint weight;
+};
+
+struct resource_group_account_t
+{
+  char user[USERNAME_LENGTH];
+  char host[MAX_HOSTNAME];                      /* Empty for any host */
+  uint group;
+};
+
+struct resource_groups_t
+{
+  resource_group_t groups[MAX_RESOURCE_GROUPS];
+  uint group_count;
+  resource_group_account_t accounts[MAX_RESOURCE_GROUP_ACCOUNTS];
+  uint account_count;
+};
+
+/* The current resource groups, protected by LOCK_resource_groups */
+static resource_groups_t resource_groups;
+static mysql_mutex_t LOCK_resource_groups;
+/* Incremented when the resource groups change */
+static volatile int32 resource_groups_version;
+/* Stride of each resource group, read by the scheduler without lock */
+static uint resource_group_stride[MAX_RESOURCE_GROUPS];
+
+/*
+  NUMA nodes the thread groups are bound to with thread_pool_numa. Thread
+  group i runs on node numa_nodes[i % numa_node_count].
+*/
+static int numa_nodes[MAX_THREAD_GROUPS];
+static uint numa_node_count;
+
 /* Global timer for all groups  */
 struct pool_timer_t
 {
@@ -449,6 +533,74 @@ inline bool connection_is_high_prio(connection_t *c)
 
 } // namespace
 
+/*
+  Put a connection into the low priority queue of its resource group.
+  A queue that was empty starts at the current virtual time, so that a
+  resource group does not save up credit while it is idle.
+*/
+
+static void queue_push(thread_group_t *thread_group, connection_t *connection,
+                       ulonglong now)
+{
+  uint group= connection->resource_group;
+  if (!(thread_group->queue_mask & (1U << group)))
+  {
+    set_if_bigger(thread_group->queue_pass[group], thread_group->queue_vtime);
+    thread_group->queue_mask|= 1U << group;
+  }
+  connection->enqueue_time= now;
+  thread_group->queue[group].push_back(connection);
+}
+
+
+/* Remove the connection to handle next from the low priority queues */
+
+static connection_t *queue_pop(thread_group_t *thread_group)
+{
+  uint group= MAX_RESOURCE_GROUPS;
+  uint mask= thread_group->queue_mask;
+  for (uint i= 0; mask; i++, mask>>= 1)
+  {
+    if ((mask & 1) &&
+        (group == MAX_RESOURCE_GROUPS ||
+         thread_group->queue_pass[i] < thread_group->queue_pass[group]))
+      group= i;
+  }
+  if (group == MAX_RESOURCE_GROUPS)
+    return NULL;
+
+  connection_t *c= thread_group->queue[group].front();
+  thread_group->queue[group].remove(c);
+  if (thread_group->queue[group].is_empty())
+    thread_group->queue_mask&= ~(1U << group);
+  thread_group->queue_vtime= thread_group->queue_pass[group];
+  thread_group->queue_pass[group]+= resource_group_stride[group];
+  return c;
+}
+
+
+/*
+  Account an event of a connection in the queue time histogram of its
+  resource group. queue_time is in microseconds, 0 for the events that
+  were handled without being queued.
+*/
+
+static void account_queue_time(thread_group_t *thread_group,
+                               connection_t *connection, ulonglong queue_time)
+{
+  uint bucket;
+  if (queue_time <= 1)
+    bucket= 0;
+  else if (queue_time > (1ULL << (QUEUE_TIME_BUCKETS - 2)))
+    bucket= QUEUE_TIME_BUCKETS - 1;
+  else
+    bucket= my_bit_log2((ulong) (queue_time - 1)) + 1;
+  thread_group->queue_time_count[connection->resource_group][bucket]++;
+  thread_group->queue_time_total[connection->resource_group][bucket]+=
+    queue_time;
+}
+
+
 /* Dequeue element from a workqueue */
 
 static connection_t *queue_get(thread_group_t *thread_group)
@@ -462,13 +614,19 @@ static connection_t *queue_get(thread_group_t *thread_group)
     thread_group->high_prio_queue.remove(c);
   }
   /*
-    Don't pick events from the low priority queue if there are too many
-    active + waiting threads.
+    Don't pick events from the low priority queues if there are too many
+    active + waiting threads. Otherwise the weights of the resource groups
+    decide which one is served.
   */
-  else if (!too_many_busy_threads(thread_group) &&
-           (c= thread_group->queue.front()))
+  else if (!too_many_busy_threads(thread_group))
   {
-    thread_group->queue.remove(c);
+    c= queue_pop(thread_group);
+  }
+  if (c)
+  {
+    ulonglong now= my_micro_time();
+    account_queue_time(thread_group, c,
+                       now > c->enqueue_time ? now - c->enqueue_time : 0);
   }
   DBUG_RETURN(c);  
 }
@@ -480,27 +638,16 @@ static connection_t *queue_get(thread_group_t *thread_group)
   Also, recalculate time when next timeout check should run.
 */
 
-static void timeout_check(pool_timer_t *timer)
+class Timeout_check : public Do_THD_Impl
 {
-  std::set<THD*> global_thread_list_copy;
-  DBUG_ENTER("timeout_check");
+public:
+  Timeout_check(pool_timer_t *timer) : m_timer(timer) {}
 
-  mysql_mutex_lock(&LOCK_thd_remove);
-  copy_global_thread_list(&global_thread_list_copy);
-
-  Thread_iterator it= global_thread_list_copy.begin();
-  Thread_iterator end= global_thread_list_copy.end();
-
-  /* Reset next timeout check, it will be recalculated in the loop below */
-  my_atomic_fas64((volatile int64*)&timer->next_timeout_check, ULONGLONG_MAX);
-
-  THD *thd;
-  for ( ; it != end; ++it)
+  virtual void operator()(THD *thd)
   {
-    thd= (*it);
     if (thd->net.reading_or_writing != 1)
-      continue;
- 
+      return;
+
     connection_t *connection= (connection_t *)thd->event_scheduler.data;
     if (!connection)
     {
@@ -508,10 +655,10 @@ static void timeout_check(pool_timer_t *timer)
         Connection does not have scheduler data. This happens for example
         if THD belongs to a different scheduler, that is listening to extra_port.
       */
-      continue;
+      return;
     }
 
-    if(connection->abs_wait_timeout < timer->current_microtime)
+    if(connection->abs_wait_timeout < m_timer->current_microtime)
     {
       /* Wait timeout exceeded, kill connection. */
       mysql_mutex_lock(&thd->LOCK_thd_data);
@@ -524,7 +671,21 @@ static void timeout_check(pool_timer_t *timer)
       set_next_timeout_check(connection->abs_wait_timeout);
     }
   }
-  mysql_mutex_unlock(&LOCK_thd_remove);
+
+private:
+  pool_timer_t *m_timer;
+};
+
+
+static void timeout_check(pool_timer_t *timer)
+{
+  DBUG_ENTER("timeout_check");
+
+  /* Reset next timeout check, it will be recalculated in the loop below */
+  my_atomic_fas64((volatile int64*)&timer->next_timeout_check, ULONGLONG_MAX);
+
+  Timeout_check timeout_check(timer);
+  do_for_all_thd_copy(&timeout_check);
   DBUG_VOID_RETURN;
 }
 
@@ -601,7 +762,7 @@ static void* timer_thread(void *param)
 static bool queues_are_empty(thread_group_t *tg)
 {
   return (tg->high_prio_queue.is_empty() &&
-          (tg->queue.is_empty() || too_many_busy_threads(tg)));
+          (!tg->queue_mask || too_many_busy_threads(tg)));
 }
 
 void check_stall(thread_group_t *thread_group)
@@ -773,25 +934,27 @@ static connection_t * listener(worker_thread_t *current_thread,
     */
     
     bool listener_picks_event= thread_group->high_prio_queue.is_empty() &&
-      thread_group->queue.is_empty();
+      !thread_group->queue_mask;
     
     /* 
       If listener_picks_event is set, listener thread will handle first event, 
       and put the rest into the queue. If listener_pick_event is not set, all 
       events go to the queue.
     */
+    ulonglong now= my_micro_time();
     for(int i=(listener_picks_event)?1:0; i < cnt ; i++)
     {
       connection_t *c= (connection_t *)native_event_get_userdata(&ev[i]);
       if (connection_is_high_prio(c))
       {
         c->tickets--;
+        c->enqueue_time= now;
         thread_group->high_prio_queue.push_back(c);
       }
       else
       {
         c->tickets= c->thd->variables.threadpool_high_prio_tickets;
-        thread_group->queue.push_back(c);
+        queue_push(thread_group, c, now);
       }
     }
     
@@ -799,6 +962,7 @@ static connection_t * listener(worker_thread_t *current_thread,
     {
       /* Handle the first event. */
       retval= (connection_t *)native_event_get_userdata(&ev[0]);
+      account_queue_time(thread_group, retval, 0);
       mysql_mutex_unlock(&thread_group->mutex);
       break;
     }
@@ -984,6 +1148,7 @@ int thread_group_init(thread_group_t *thread_group, pthread_attr_t* thread_attr)
   thread_group->pollfd= -1;
   thread_group->shutdown_pipe[0]= -1;
   thread_group->shutdown_pipe[1]= -1;
+  thread_group->numa_node= -1;
   DBUG_RETURN(0);
 }
 
@@ -1088,7 +1253,7 @@ static void queue_put(thread_group_t *thread_group, connection_t *connection)
 
   mysql_mutex_lock(&thread_group->mutex);
   connection->tickets= connection->thd->variables.threadpool_high_prio_tickets;
-  thread_group->queue.push_back(connection);
+  queue_push(thread_group, connection, my_micro_time());
 
   if (thread_group->active_thread_count == 0)
     wake_or_create_thread(thread_group);
@@ -1186,13 +1351,14 @@ connection_t *get_event(worker_thread_t *current_thread,
 
           connection->tickets=
             connection->thd->variables.threadpool_high_prio_tickets;
-          thread_group->queue.push_back(connection);
+          queue_push(thread_group, connection, my_micro_time());
           connection= NULL;
         }
 
         if (connection)
         {
           thread_group->queue_event_count++;
+          account_queue_time(thread_group, connection, 0);
           break;
         }
       }
@@ -1305,12 +1471,73 @@ connection_t *alloc_connection(THD *thd)
     connection->bound_to_poll_descriptor= false;
     connection->abs_wait_timeout= ULONGLONG_MAX;
     connection->tickets = 0;
+    connection->enqueue_time= 0;
+    connection->resource_group= 0;
+    connection->resource_group_version= -1;
+    connection->resource_group_user[0]= 0;
+    connection->resource_group_host[0]= 0;
+    connection->numa_node= -1;
   }
   DBUG_RETURN(connection);
 }
 
 
 
+/**
+  Find the NUMA node a client socket is served on
+
+  @details
+  This is the node of the CPU that processed the last packet received on
+  the socket, where the interrupts of the network queue of the connection
+  are handled.
+
+  @return index of the node in numa_nodes, -1 if it is not known
+*/
+
+static int socket_numa_node(int fd __attribute__((unused)))
+{
+#if defined(HAVE_LIBNUMA) && defined(SO_INCOMING_CPU)
+  int cpu;
+  socklen_t length= sizeof(cpu);
+  if (numa_node_count &&
+      !getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &length) && cpu >= 0)
+  {
+    int node= numa_node_of_cpu(cpu);
+    for (uint i= 0; i < numa_node_count; i++)
+    {
+      if (numa_nodes[i] == node)
+        return (int) i;
+    }
+  }
+#endif
+  return -1;
+}
+
+
+/**
+  Choose the thread group of a connection
+
+  @details
+  Connections are spread over the groups by thread id. If the NUMA node of
+  the client socket is known, only the groups bound to that node are used.
+*/
+
+static thread_group_t *connection_group(connection_t *connection)
+{
+  uint count= group_count;
+  ulong thread_id= connection->thd->thread_id;
+  uint node= (uint) connection->numa_node;
+
+  if (connection->numa_node >= 0 && node < count)
+  {
+    /* Groups node, node + numa_node_count, ... run on the node */
+    uint node_groups= (count - node + numa_node_count - 1) / numa_node_count;
+    return &all_groups[node + (thread_id % node_groups) * numa_node_count];
+  }
+  return &all_groups[thread_id % count];
+}
+
+
 /**
   Add a new connection to thread pool..
 */
@@ -1320,15 +1547,13 @@ void tp_add_connection(THD *thd)
   DBUG_ENTER("tp_add_connection");
   
   add_global_thread(thd);
-  mysql_mutex_unlock(&LOCK_thread_count);
   connection_t *connection= alloc_connection(thd);
   if (connection)
   {
     thd->event_scheduler.data= connection;
       
     /* Assign connection to a group. */
-    thread_group_t *group= 
-      &all_groups[thd->thread_id%group_count];
+    thread_group_t *group= connection_group(connection);
     
     connection->thread_group=group;
       
@@ -1513,9 +1738,14 @@ static int start_io(connection_t *connection)
 
     So we recalculate in which group the connection should be, based
     on thread_id and current group count, and migrate if necessary.
+
+    With thread_pool_numa, the connection also moves to a group on the
+    NUMA node of its socket once the login packet has been received on it.
   */ 
-  thread_group_t *group = 
-    &all_groups[connection->thd->thread_id%group_count];
+  if (!connection->bound_to_poll_descriptor)
+    connection->numa_node= socket_numa_node(fd);
+
+  thread_group_t *group= connection_group(connection);
 
   if (group != connection->thread_group)
   {
@@ -1537,6 +1767,60 @@ static int start_io(connection_t *connection)
 
 
 
+/**
+  Find the resource group of an account
+
+  @details
+  An entry for the user and the host of the account takes precedence over
+  an entry for the user only. Must be called with LOCK_resource_groups.
+*/
+
+static uint find_resource_group(const char *user, const char *host)
+{
+  uint group= 0;
+  for (uint i= 0; i < resource_groups.account_count; i++)
+  {
+    resource_group_account_t *account= &resource_groups.accounts[i];
+    if (strcmp(account->user, user))
+      continue;
+    if (!account->host[0])
+      group= account->group;
+    else if (!my_strcasecmp(system_charset_info, account->host, host))
+      return account->group;
+  }
+  return group;
+}
+
+
+/**
+  Choose the resource group of a connection for its current account
+
+  @details
+  The group is chosen again only if the resource groups or the account
+  (after COM_CHANGE_USER) have changed. Must be called while the connection
+  is not in a queue.
+*/
+
+static void set_resource_group(connection_t *c)
+{
+  Security_context *sctx= &c->thd->main_security_ctx;
+  if (c->resource_group_version == resource_groups_version &&
+      !strcmp(c->resource_group_user, sctx->priv_user) &&
+      !strcmp(c->resource_group_host, sctx->priv_host))
+    return;
+
+  strmake(c->resource_group_user, sctx->priv_user,
+          sizeof(c->resource_group_user) - 1);
+  strmake(c->resource_group_host, sctx->priv_host,
+          sizeof(c->resource_group_host) - 1);
+  mysql_mutex_lock(&LOCK_resource_groups);
+  c->resource_group= find_resource_group(c->resource_group_user,
+                                         c->resource_group_host);
+  c->resource_group_version= resource_groups_version;
+  mysql_mutex_unlock(&LOCK_resource_groups);
+}
+
+
 static void handle_event(connection_t *connection)
 {
 
@@ -1556,6 +1840,7 @@ static void handle_event(connection_t *connection)
   if(err)
     goto end;
 
+  set_resource_group(connection);
   set_wait_timeout(connection);
   err= start_io(connection);
 
@@ -1583,6 +1868,12 @@ static void *worker_main(void *param)
   
   thread_group_t *thread_group = (thread_group_t *)param;
 
+#ifdef HAVE_LIBNUMA
+  /* Run on the CPUs of the node of the group, the listener as well */
+  if (thread_group->numa_node >= 0)
+    numa_run_on_node(thread_group->numa_node);
+#endif
+
   /* Init per-thread structure */
   mysql_cond_init(key_worker_cond, &this_thread.cond, NULL);
   this_thread.thread_group= thread_group;
@@ -1624,6 +1915,45 @@ static void *worker_main(void *param)
 }
 
 
+/**
+  Bind the thread groups to the NUMA nodes, round robin
+*/
+
+static void tp_init_numa()
+{
+  numa_node_count= 0;
+#ifdef HAVE_LIBNUMA
+  if (numa_available() >= 0)
+  {
+    /* Nodes that have both memory and CPUs */
+    struct bitmask *cpus= numa_allocate_cpumask();
+    for (int node= 0; node <= numa_max_node(); node++)
+    {
+      if (numa_bitmask_isbitset(numa_all_nodes_ptr, node) &&
+          !numa_node_to_cpus(node, cpus) && numa_bitmask_weight(cpus) &&
+          numa_node_count < array_elements(numa_nodes))
+        numa_nodes[numa_node_count++]= node;
+    }
+    numa_free_cpumask(cpus);
+  }
+  if (numa_node_count < 2)
+  {
+    sql_print_information("Thread pool: less than two NUMA nodes are "
+                          "available, thread_pool_numa has no effect");
+    numa_node_count= 0;
+    return;
+  }
+  for (uint i= 0; i < array_elements(all_groups); i++)
+    all_groups[i].numa_node= numa_nodes[i % numa_node_count];
+  sql_print_information("Thread pool: thread groups are bound to %u NUMA "
+                        "nodes", numa_node_count);
+#else
+  sql_print_warning("Thread pool: the server is built without NUMA "
+                    "support, thread_pool_numa has no effect");
+#endif
+}
+
+
 bool tp_init()
 {
   DBUG_ENTER("tp_init");
@@ -1634,6 +1964,8 @@ bool tp_init()
   {
     thread_group_init(&all_groups[i], get_connection_attrib());  
   }
+  if (threadpool_numa)
+    tp_init_numa();
   tp_set_threadpool_size(threadpool_size);
   if(group_count == 0)
   {
@@ -1646,6 +1978,14 @@ bool tp_init()
   PSI_register(cond);
   PSI_register(thread);
 #endif
+
+  mysql_mutex_init(key_resource_groups_mutex, &LOCK_resource_groups, NULL);
+  if (tp_set_resource_groups(threadpool_resource_groups))
+  {
+    sql_print_error("Invalid thread_pool_resource_groups value '%s'",
+                    threadpool_resource_groups);
+    DBUG_RETURN(1);
+  }
   
   pool_timer.tick_interval= threadpool_stall_limit;
   start_timer(&pool_timer);
@@ -1665,6 +2005,7 @@ void tp_end()
   {
     thread_group_close(&all_groups[i]);
   }
+  mysql_mutex_destroy(&LOCK_resource_groups);
   threadpool_started= false;
   DBUG_VOID_RETURN;
 }
@@ -1713,6 +2054,250 @@ void tp_set_threadpool_stall_limit(uint limit)
 }
 
 
+static inline const char *skip_spaces(const char *pos)
+{
+  while (my_isspace(system_charset_info, *pos))
+    pos++;
+  return pos;
+}
+
+
+/**
+  Parse a thread_pool_resource_groups value
+
+  @details
+  The value is a list of resource groups separated by semicolons. Each one
+  is given as name:weight:account,account,... where an account is either
+  user@host, as in CREATE USER, or just user for all its hosts. The weight
+  of the implicit group named default, which has the accounts not listed,
+  can be set with a default:weight entry.
+
+  @return true if the value is not valid
+*/
+
+static bool parse_resource_groups(const char *val, resource_groups_t *rg)
+{
+  rg->group_count= 1;
+  rg->account_count= 0;
+  strmov(rg->groups[0].name, "default");
+  rg->groups[0].weight= 1;
+  if (!val)
+    return false;
+
+  bool default_given= false;
+  const char *pos= val;
+  for (;;)
+  {
+    pos= skip_spaces(pos);
+    if (!*pos)
+      break;
+
+    const char *name= pos;
+    while (my_isalnum(system_charset_info, *pos) || *pos == '_')
+      pos++;
+    size_t name_length= pos - name;
+    pos= skip_spaces(pos);
+    if (!name_length || name_length > NAME_CHAR_LEN || *pos++ != ':')
+      return true;
+
+    pos= skip_spaces(pos);
+    char *end;
+    ulong weight= strtoul(pos, &end, 10);
+    if (end == pos || weight < 1 || weight > 1000)
+      return true;
+    pos= skip_spaces(end);
+
+    uint group;
+    for (group= 0; group < rg->group_count; group++)
+    {
+      if (strlen(rg->groups[group].name) == name_length &&
+          !my_strnncoll(system_charset_info,
+                        (const uchar *) rg->groups[group].name, name_length,
+                        (const uchar *) name, name_length))
+        break;
+    }
+    if (group == 0 && !default_given)
+      default_given= true;
+    else if (group < rg->group_count)
+      return true;                              /* Given twice */
+    else if (group == MAX_RESOURCE_GROUPS)
+      return true;
+    else
+    {
+      strmake(rg->groups[group].name, name, name_length);
+      rg->group_count++;
+    }
+    rg->groups[group].weight= (uint) weight;
+
+    if (*pos == ':')
+    {
+      /* The default group has the accounts that are not listed */
+      if (group == 0)
+        return true;
+      do
+      {
+        pos= skip_spaces(pos + 1);
+        const char *user= pos;
+        while (*pos && *pos != '@' && *pos != ',' && *pos != ';' &&
+               !my_isspace(system_charset_info, *pos))
+          pos++;
+        size_t user_length= pos - user;
+        const char *host= pos;
+        size_t host_length= 0;
+        if (*pos == '@')
+        {
+          host= ++pos;
+          while (*pos && *pos != ',' && *pos != ';' &&
+                 !my_isspace(system_charset_info, *pos))
+            pos++;
+          host_length= pos - host;
+          if (!host_length)
+            return true;
+        }
+        if (!user_length || user_length >= USERNAME_LENGTH ||
+            host_length >= MAX_HOSTNAME ||
+            rg->account_count == MAX_RESOURCE_GROUP_ACCOUNTS)
+          return true;
+
+        resource_group_account_t *account= &rg->accounts[rg->account_count];
+        strmake(account->user, user, user_length);
+        strmake(account->host, host, host_length);
+        account->group= group;
+        for (uint i= 0; i < rg->account_count; i++)
+        {
+          if (!strcmp(rg->accounts[i].user, account->user) &&
+              !my_strcasecmp(system_charset_info, rg->accounts[i].host,
+                             account->host))
+            return true;                        /* In two groups */
+        }
+        rg->account_count++;
+        pos= skip_spaces(pos);
+      } while (*pos == ',');
+    }
+
+    if (*pos == ';')
+      pos++;
+    else if (*pos)
+      return true;
+  }
+  return false;
+}
+
+
+/**
+  Check a thread_pool_resource_groups value
+
+  @return true if the value is not valid
+*/
+
+bool tp_check_resource_groups(const char *val)
+{
+  resource_groups_t rg;
+  return parse_resource_groups(val, &rg);
+}
+
+
+/**
+  Use new resource groups
+
+  @details
+  The connections choose their group again after their next request. The
+  queue time histograms are reset.
+
+  @return true if the value is not valid
+*/
+
+bool tp_set_resource_groups(const char *val)
+{
+  resource_groups_t rg;
+  if (parse_resource_groups(val, &rg))
+    return true;
+  if (!threadpool_started)
+    return false;
+
+  mysql_mutex_lock(&LOCK_resource_groups);
+  resource_groups= rg;
+  for (uint i= 0; i < MAX_RESOURCE_GROUPS; i++)
+  {
+    /* The queues of removed groups are drained with weight 1 */
+    uint weight= i < rg.group_count ? rg.groups[i].weight : 1;
+    resource_group_stride[i]= RESOURCE_GROUP_STRIDE / weight;
+  }
+  resource_groups_version++;
+  mysql_mutex_unlock(&LOCK_resource_groups);
+
+  for (uint i= 0; i < array_elements(all_groups); i++)
+  {
+    thread_group_t *group= &all_groups[i];
+    mysql_mutex_lock(&group->mutex);
+    memset(group->queue_time_count, 0, sizeof(group->queue_time_count));
+    memset(group->queue_time_total, 0, sizeof(group->queue_time_total));
+    mysql_mutex_unlock(&group->mutex);
+  }
+  return false;
+}
+
+
+/**
+  Fill INFORMATION_SCHEMA.THREAD_POOL_QUEUE_TIMES
+
+  @details
+  There is a row for each bucket of the queue time histogram of each
+  resource group, with the histograms of all the thread groups summed up.
+*/
+
+int tp_fill_queue_times(THD *thd, TABLE *table)
+{
+  DBUG_ENTER("tp_fill_queue_times");
+  if (!threadpool_started)
+    DBUG_RETURN(0);
+
+  ulonglong count[MAX_RESOURCE_GROUPS][QUEUE_TIME_BUCKETS];
+  ulonglong total[MAX_RESOURCE_GROUPS][QUEUE_TIME_BUCKETS];
+  memset(count, 0, sizeof(count));
+  memset(total, 0, sizeof(total));
+  for (uint i= 0; i < array_elements(all_groups); i++)
+  {
+    thread_group_t *group= &all_groups[i];
+    mysql_mutex_lock(&group->mutex);
+    for (uint j= 0; j < MAX_RESOURCE_GROUPS; j++)
+    {
+      for (uint k= 0; k < QUEUE_TIME_BUCKETS; k++)
+      {
+        count[j][k]+= group->queue_time_count[j][k];
+        total[j][k]+= group->queue_time_total[j][k];
+      }
+    }
+    mysql_mutex_unlock(&group->mutex);
+  }
+
+  mysql_mutex_lock(&LOCK_resource_groups);
+  resource_groups_t rg= resource_groups;
+  mysql_mutex_unlock(&LOCK_resource_groups);
+
+  for (uint j= 0; j < rg.group_count; j++)
+  {
+    for (uint k= 0; k < QUEUE_TIME_BUCKETS; k++)
+    {
+      restore_record(table, s->default_values);
+      table->field[0]->store(rg.groups[j].name, strlen(rg.groups[j].name),
+                             system_charset_info);
+      table->field[1]->store((ulonglong) rg.groups[j].weight, true);
+      if (k < QUEUE_TIME_BUCKETS - 1)
+      {
+        table->field[2]->set_notnull();
+        table->field[2]->store(1ULL << k, true);
+      }
+      table->field[3]->store(count[j][k], true);
+      table->field[4]->store(total[j][k], true);
+      if (schema_table_store_record(thd, table))
+        DBUG_RETURN(1);
+    }
+  }
+  DBUG_RETURN(0);
+}
+
+
 /**
  Calculate number of idle/waiting threads in the pool.
  
@@ -672,12 +672,10 @@ static void CALLBACK shm_read_callback(PTP_CALLBACK_INSTANCE instance,
 
 /*
   Notify the thread pool about a new connection.
-  NOTE: LOCK_thread_count is locked on entry. This function must unlock it.
 */
 void tp_add_connection(THD *thd)
 {
   threads.append(thd);
-  mysql_mutex_unlock(&LOCK_thread_count);
 
   connection_t *con = (connection_t *)malloc(sizeof(connection_t));
   if(!con)
@@ -871,6 +871,10 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
   hp_create_info->auto_key= auto_key;
   hp_create_info->auto_key_type= auto_key_type;
   hp_create_info->max_table_size=current_thd->variables.max_heap_table_size;
+  /* Internal temporary tables are also limited by tmp_table_size */
+  if (internal_table)
+    set_if_smaller(hp_create_info->max_table_size,
+                   current_thd->variables.tmp_table_size);
   hp_create_info->with_auto_increment= found_real_auto_increment;
   hp_create_info->internal_table= internal_table;
   hp_create_info->max_chunk_size= share->key_block_size;
@@ -879,7 +883,14 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
   hp_create_info->columndef= columndef;
   hp_create_info->fixed_key_fieldnr= fixed_key_fieldnr;
   hp_create_info->fixed_data_size= fixed_data_size;
-  hp_create_info->max_records= (ulong) share->max_rows;
+  /*
+    The rows of a dynamic internal table take less than reclength, which
+    max_rows was estimated from, so only max_table_size limits them.
+  */
+  if (internal_table && hp_create_info->is_dynamic)
+    hp_create_info->max_records= 0;
+  else
+    hp_create_info->max_records= (ulong) share->max_rows;
   hp_create_info->min_records= (ulong) share->min_rows;
   hp_create_info->keys= share->keys;
   hp_create_info->reclength= share->reclength;
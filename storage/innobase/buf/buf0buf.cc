@@ -56,6 +56,11 @@ Created 11/5/1995 Heikki Tuuri
 #include "trx0trx.h"
 #include "srv0start.h"
 
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#include <numaif.h>
+#endif /* HAVE_LIBNUMA */
+
 /* prototypes for new functions added to ha_innodb.cc */
 trx_t* innobase_get_trx();
 
@@ -1116,6 +1121,68 @@ buf_block_init(
 	ut_ad(rw_lock_validate(&(block->lock)));
 }
 
+#ifdef HAVE_LIBNUMA
+/** NUMA nodes that have memory, with innodb_buffer_pool_numa. Buffer
+pool instance i is placed on node buf_numa_nodes[i % buf_n_numa_nodes]. */
+static int	buf_numa_nodes[MAX_BUFFER_POOLS];
+static ulint	buf_n_numa_nodes;
+
+/********************************************************************//**
+Finds the NUMA nodes to place the buffer pool instances on. */
+static
+void
+buf_numa_init(void)
+/*===============*/
+{
+	buf_n_numa_nodes = 0;
+
+	if (numa_available() < 0) {
+		return;
+	}
+
+	for (int node = 0;
+	     node <= numa_max_node() && buf_n_numa_nodes < MAX_BUFFER_POOLS;
+	     node++) {
+
+		if (numa_bitmask_isbitset(numa_all_nodes_ptr, node)) {
+			buf_numa_nodes[buf_n_numa_nodes++] = node;
+		}
+	}
+}
+
+/********************************************************************//**
+Places the memory of a chunk on the NUMA node of its buffer pool instance.
+The pages that are already faulted in, the block descriptors and the
+frames preallocated with innodb_buffer_pool_populate, are moved there. The
+node is only preferred: if it runs out of memory, the pages come from
+another one. */
+static
+void
+buf_chunk_set_numa_node(
+/*====================*/
+	buf_chunk_t*	chunk,		/*!< in: chunk of buffers */
+	ulint		instance_no)	/*!< in: id of the instance */
+{
+	struct bitmask*	nodes = numa_allocate_nodemask();
+
+	numa_bitmask_setbit(
+		nodes, buf_numa_nodes[instance_no % buf_n_numa_nodes]);
+
+	if (mbind(chunk->mem, chunk->mem_size, MPOL_PREFERRED,
+		  nodes->maskp, nodes->size + 1, MPOL_MF_MOVE)) {
+
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Failed to place buffer pool instance %lu on NUMA "
+			"node %d, errno %d",
+			instance_no,
+			buf_numa_nodes[instance_no % buf_n_numa_nodes],
+			errno);
+	}
+
+	numa_bitmask_free(nodes);
+}
+#endif /* HAVE_LIBNUMA */
+
 /********************************************************************//**
 Allocates a chunk of buffer frames.
 @return	chunk, or NULL on failure */
@@ -1149,6 +1216,12 @@ buf_chunk_init(
 		return(NULL);
 	}
 
+#ifdef HAVE_LIBNUMA
+	if (buf_n_numa_nodes > 1) {
+		buf_chunk_set_numa_node(chunk, buf_pool->instance_no);
+	}
+#endif /* HAVE_LIBNUMA */
+
 	/* Allocate the block descriptors from
 	the start of the memory block. */
 	chunk->blocks = (buf_block_t*) chunk->mem;
@@ -1367,6 +1440,7 @@ buf_pool_init_instance(
 		     &buf_pool->flush_state_mutex, SYNC_BUF_FLUSH_STATE);
 
 	if (buf_pool_size > 0) {
+		buf_pool->instance_no = instance_no;
 		buf_pool->n_chunks = 1;
 
 		buf_pool->chunks = chunk =
@@ -1381,7 +1455,6 @@ buf_pool_init_instance(
 			return(DB_ERROR);
 		}
 
-		buf_pool->instance_no = instance_no;
 		buf_pool->old_pool_size = buf_pool_size;
 		buf_pool->curr_size = chunk->size;
 		buf_pool->read_ahead_area
@@ -1493,6 +1566,26 @@ buf_pool_init(
 	buf_pool_ptr = (buf_pool_t*) mem_zalloc(
 		n_instances * sizeof *buf_pool_ptr);
 
+	if (srv_buf_pool_numa) {
+#ifdef HAVE_LIBNUMA
+		buf_numa_init();
+
+		if (buf_n_numa_nodes > 1) {
+			ib_logf(IB_LOG_LEVEL_INFO,
+				"Placing the buffer pool instances on %lu "
+				"NUMA nodes", buf_n_numa_nodes);
+		} else {
+			ib_logf(IB_LOG_LEVEL_INFO,
+				"Less than two NUMA nodes are available, "
+				"innodb_buffer_pool_numa has no effect");
+		}
+#else
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"The server is built without NUMA support, "
+			"innodb_buffer_pool_numa has no effect");
+#endif /* HAVE_LIBNUMA */
+	}
+
 	for (i = 0; i < n_instances; i++) {
 		buf_pool_t*	ptr	= &buf_pool_ptr[i];
 
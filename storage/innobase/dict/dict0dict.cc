@@ -482,6 +482,164 @@ dict_table_stats_unlock(
 	}
 }
 
+/** Number of rw_locks protecting dict_sys->table_hash and
+dict_sys->table_id_hash each */
+#define DICT_TABLE_HASH_N_LOCKS	64
+
+/**********************************************************************//**
+Increments the count of open handles to a table. The count may be
+incremented from 0 only while holding dict_sys->mutex. */
+UNIV_INLINE
+void
+dict_table_n_ref_count_inc(
+/*=======================*/
+	dict_table_t*	table)	/*!< in/out: table */
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+	ut_ad(table->n_ref_count > 0 || mutex_own(&dict_sys->mutex));
+	os_atomic_increment_ulint(&table->n_ref_count, 1);
+#else /* HAVE_ATOMIC_BUILTINS */
+	ut_ad(mutex_own(&dict_sys->mutex));
+	++table->n_ref_count;
+#endif /* HAVE_ATOMIC_BUILTINS */
+}
+
+/**********************************************************************//**
+Decrements the count of open handles to a table.
+@return	the count after the decrement */
+UNIV_INLINE
+ulint
+dict_table_n_ref_count_dec(
+/*=======================*/
+	dict_table_t*	table)	/*!< in/out: table */
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+	return(os_atomic_decrement_ulint(&table->n_ref_count, 1));
+#else /* HAVE_ATOMIC_BUILTINS */
+	ut_ad(mutex_own(&dict_sys->mutex));
+	return(--table->n_ref_count);
+#endif /* HAVE_ATOMIC_BUILTINS */
+}
+
+#ifdef HAVE_ATOMIC_BUILTINS
+/**********************************************************************//**
+Tries to increment the count of open handles to a table that is already
+open elsewhere, without acquiring dict_sys->mutex. The count is never
+incremented from 0 here, so that a table that dict_sys->mutex holders
+see unreferenced cannot become referenced behind their back.
+@return	TRUE if the count was incremented */
+UNIV_INLINE
+ibool
+dict_table_n_ref_count_inc_if_open(
+/*===============================*/
+	dict_table_t*	table)	/*!< in/out: table */
+{
+	for (;;) {
+		ulint	n_ref_count = table->n_ref_count;
+
+		if (n_ref_count == 0) {
+			return(FALSE);
+		}
+
+		if (os_compare_and_swap_ulint(&table->n_ref_count,
+					      n_ref_count, n_ref_count + 1)) {
+			return(TRUE);
+		}
+	}
+}
+
+/**********************************************************************//**
+Tries to decrement the count of open handles to a table without
+acquiring dict_sys->mutex. Fails if the count would drop to 0, because
+that transition must be done under dict_sys->mutex.
+@return	TRUE if the count was decremented */
+UNIV_INLINE
+ibool
+dict_table_n_ref_count_dec_if_shared(
+/*=================================*/
+	dict_table_t*	table)	/*!< in/out: table */
+{
+	for (;;) {
+		ulint	n_ref_count = table->n_ref_count;
+
+		ut_a(n_ref_count > 0);
+
+		if (n_ref_count == 1) {
+			return(FALSE);
+		}
+
+		if (os_compare_and_swap_ulint(&table->n_ref_count,
+					      n_ref_count, n_ref_count - 1)) {
+			return(TRUE);
+		}
+	}
+}
+
+/**********************************************************************//**
+Looks up a cached table by name and, if it is already open elsewhere,
+increments its count of open handles without acquiring dict_sys->mutex.
+@return	table, or NULL if the caller must take the dict_sys->mutex path */
+static
+dict_table_t*
+dict_table_open_on_name_shared(
+/*===========================*/
+	const char*		table_name,	/*!< in: table name */
+	dict_err_ignore_t	ignore_err)	/*!< in: errors to ignore */
+{
+	dict_table_t*	table;
+	ulint		fold = ut_fold_string(table_name);
+
+	hash_lock_s(dict_sys->table_hash, fold);
+
+	HASH_SEARCH(name_hash, dict_sys->table_hash, fold,
+		    dict_table_t*, table, ut_ad(table->cached),
+		    !strcmp(table->name, table_name));
+
+	if (table != NULL
+	    && (table->drop_aborted
+		|| (ignore_err == DICT_ERR_IGNORE_NONE && table->corrupted)
+		|| !dict_table_n_ref_count_inc_if_open(table))) {
+
+		table = NULL;
+	}
+
+	hash_unlock_s(dict_sys->table_hash, fold);
+
+	return(table);
+}
+
+/**********************************************************************//**
+Looks up a cached table by id and, if it is already open elsewhere,
+increments its count of open handles without acquiring dict_sys->mutex.
+@return	table, or NULL if the caller must take the dict_sys->mutex path */
+static
+dict_table_t*
+dict_table_open_on_id_shared(
+/*=========================*/
+	table_id_t	table_id)	/*!< in: table id */
+{
+	dict_table_t*	table;
+	ulint		fold = ut_fold_ull(table_id);
+
+	hash_lock_s(dict_sys->table_id_hash, fold);
+
+	HASH_SEARCH(id_hash, dict_sys->table_id_hash, fold,
+		    dict_table_t*, table, ut_ad(table->cached),
+		    table->id == table_id);
+
+	if (table != NULL
+	    && (table->drop_aborted
+		|| !dict_table_n_ref_count_inc_if_open(table))) {
+
+		table = NULL;
+	}
+
+	hash_unlock_s(dict_sys->table_id_hash, fold);
+
+	return(table);
+}
+#endif /* HAVE_ATOMIC_BUILTINS */
+
 /**********************************************************************//**
 Try to drop any indexes after an aborted index creation.
 This can also be after a server kill during DROP INDEX. */
@@ -510,9 +668,9 @@ dict_table_try_drop_aborted(
 
 	if (table && table->n_ref_count == ref_count && table->drop_aborted) {
 		/* Silence a debug assertion in row_merge_drop_indexes(). */
-		ut_d(table->n_ref_count++);
+		ut_d(dict_table_n_ref_count_inc(table));
 		row_merge_drop_indexes(trx, table, TRUE);
-		ut_d(table->n_ref_count--);
+		ut_d(dict_table_n_ref_count_dec(table));
 		ut_ad(table->n_ref_count == ref_count);
 		trx_commit_for_mysql(trx);
 	}
@@ -564,6 +722,19 @@ dict_table_close(
 					indexes after an aborted online
 					index creation */
 {
+#ifdef HAVE_ATOMIC_BUILTINS
+	/* Only the last handle needs dict_sys->mutex: it may reset the
+	statistics, requeue the table in the LRU list or drop indexes
+	left over from an aborted online index creation. */
+	if (!dict_locked
+	    && !(try_drop && table->drop_aborted)
+	    && dict_table_n_ref_count_dec_if_shared(table)) {
+
+		MONITOR_ATOMIC_DEC(MONITOR_TABLE_REFERENCE);
+		return;
+	}
+#endif /* HAVE_ATOMIC_BUILTINS */
+
 	if (!dict_locked) {
 		mutex_enter(&dict_sys->mutex);
 	}
@@ -571,7 +742,11 @@ dict_table_close(
 	ut_ad(mutex_own(&dict_sys->mutex));
 	ut_a(table->n_ref_count > 0);
 
-	--table->n_ref_count;
+	if (dict_table_n_ref_count_dec(table) == 0 && table->can_be_evicted) {
+		/* Opens that found the table already referenced did not
+		touch the LRU list; account for them now. */
+		dict_move_to_mru(table);
+	}
 
 	/* Force persistent stats re-read upon next open of the table
 	so that FLUSH TABLE can be used to forcibly fetch stats from disk
@@ -585,7 +760,7 @@ dict_table_close(
 		dict_stats_deinit(table);
 	}
 
-	MONITOR_DEC(MONITOR_TABLE_REFERENCE);
+	MONITOR_ATOMIC_DEC(MONITOR_TABLE_REFERENCE);
 
 	ut_ad(dict_lru_validate());
 
@@ -932,6 +1107,17 @@ dict_table_open_on_id(
 {
 	dict_table_t*	table;
 
+#ifdef HAVE_ATOMIC_BUILTINS
+	if (!dict_locked) {
+		table = dict_table_open_on_id_shared(table_id);
+
+		if (table != NULL) {
+			MONITOR_ATOMIC_INC(MONITOR_TABLE_REFERENCE);
+			return(table);
+		}
+	}
+#endif /* HAVE_ATOMIC_BUILTINS */
+
 	if (!dict_locked) {
 		mutex_enter(&dict_sys->mutex);
 	}
@@ -950,9 +1136,9 @@ dict_table_open_on_id(
 			dict_move_to_mru(table);
 		}
 
-		++table->n_ref_count;
+		dict_table_n_ref_count_inc(table);
 
-		MONITOR_INC(MONITOR_TABLE_REFERENCE);
+		MONITOR_ATOMIC_INC(MONITOR_TABLE_REFERENCE);
 	}
 
 	if (!dict_locked) {
@@ -1031,6 +1217,10 @@ dict_init(void)
 	dict_sys->table_id_hash = hash_create(buf_pool_get_curr_size()
 					      / (DICT_POOL_PER_TABLE_HASH
 						 * UNIV_WORD_SIZE));
+	hash_create_sync_obj(dict_sys->table_hash, HASH_TABLE_SYNC_RW_LOCK,
+			     DICT_TABLE_HASH_N_LOCKS, SYNC_DICT_TABLE_HASH);
+	hash_create_sync_obj(dict_sys->table_id_hash, HASH_TABLE_SYNC_RW_LOCK,
+			     DICT_TABLE_HASH_N_LOCKS, SYNC_DICT_TABLE_HASH);
 	rw_lock_create(dict_operation_lock_key,
 		       &dict_operation_lock, SYNC_DICT_OPERATION);
 
@@ -1085,6 +1275,19 @@ dict_table_open_on_name(
 {
 	dict_table_t*	table;
 
+#ifdef HAVE_ATOMIC_BUILTINS
+	if (!dict_locked) {
+		ut_ad(table_name);
+
+		table = dict_table_open_on_name_shared(table_name, ignore_err);
+
+		if (table != NULL) {
+			MONITOR_ATOMIC_INC(MONITOR_TABLE_REFERENCE);
+			return(table);
+		}
+	}
+#endif /* HAVE_ATOMIC_BUILTINS */
+
 	if (!dict_locked) {
 		mutex_enter(&(dict_sys->mutex));
 	}
@@ -1129,9 +1332,9 @@ dict_table_open_on_name(
 			dict_move_to_mru(table);
 		}
 
-		++table->n_ref_count;
+		dict_table_n_ref_count_inc(table);
 
-		MONITOR_INC(MONITOR_TABLE_REFERENCE);
+		MONITOR_ATOMIC_INC(MONITOR_TABLE_REFERENCE);
 	}
 
 	ut_ad(dict_lru_validate());
@@ -1273,12 +1476,16 @@ dict_table_add_to_cache(
 	}
 
 	/* Add table to hash table of tables */
+	hash_lock_x(dict_sys->table_hash, fold);
 	HASH_INSERT(dict_table_t, name_hash, dict_sys->table_hash, fold,
 		    table);
+	hash_unlock_x(dict_sys->table_hash, fold);
 
 	/* Add table to hash table of tables based on table id */
+	hash_lock_x(dict_sys->table_id_hash, id_fold);
 	HASH_INSERT(dict_table_t, id_hash, dict_sys->table_id_hash, id_fold,
 		    table);
+	hash_unlock_x(dict_sys->table_id_hash, id_fold);
 
 	table->can_be_evicted = can_be_evicted;
 
@@ -1680,8 +1887,10 @@ dict_table_rename_in_cache(
 	}
 
 	/* Remove table from the hash tables of tables */
+	hash_lock_x(dict_sys->table_hash, ut_fold_string(old_name));
 	HASH_DELETE(dict_table_t, name_hash, dict_sys->table_hash,
 		    ut_fold_string(old_name), table);
+	hash_unlock_x(dict_sys->table_hash, ut_fold_string(old_name));
 
 	if (strlen(new_name) > strlen(table->name)) {
 		/* We allocate MAX_FULL_NAME_LEN + 1 bytes here to avoid
@@ -1695,8 +1904,10 @@ dict_table_rename_in_cache(
 	memcpy(table->name, new_name, strlen(new_name) + 1);
 
 	/* Add table to hash table of tables */
+	hash_lock_x(dict_sys->table_hash, fold);
 	HASH_INSERT(dict_table_t, name_hash, dict_sys->table_hash, fold,
 		    table);
+	hash_unlock_x(dict_sys->table_hash, fold);
 
 	dict_sys->size += strlen(new_name) - strlen(old_name);
 	ut_a(dict_sys->size > 0);
@@ -1967,13 +2178,17 @@ dict_table_change_id_in_cache(
 
 	/* Remove the table from the hash table of id's */
 
+	hash_lock_x(dict_sys->table_id_hash, ut_fold_ull(table->id));
 	HASH_DELETE(dict_table_t, id_hash, dict_sys->table_id_hash,
 		    ut_fold_ull(table->id), table);
+	hash_unlock_x(dict_sys->table_id_hash, ut_fold_ull(table->id));
 	table->id = new_id;
 
 	/* Add the table back to the hash table */
+	hash_lock_x(dict_sys->table_id_hash, ut_fold_ull(table->id));
 	HASH_INSERT(dict_table_t, id_hash, dict_sys->table_id_hash,
 		    ut_fold_ull(table->id), table);
+	hash_unlock_x(dict_sys->table_id_hash, ut_fold_ull(table->id));
 }
 
 /**********************************************************************//**
@@ -2023,11 +2238,15 @@ dict_table_remove_from_cache_low(
 
 	/* Remove table from the hash tables of tables */
 
+	hash_lock_x(dict_sys->table_hash, ut_fold_string(table->name));
 	HASH_DELETE(dict_table_t, name_hash, dict_sys->table_hash,
 		    ut_fold_string(table->name), table);
+	hash_unlock_x(dict_sys->table_hash, ut_fold_string(table->name));
 
+	hash_lock_x(dict_sys->table_id_hash, ut_fold_ull(table->id));
 	HASH_DELETE(dict_table_t, id_hash, dict_sys->table_id_hash,
 		    ut_fold_ull(table->id), table);
+	hash_unlock_x(dict_sys->table_id_hash, ut_fold_ull(table->id));
 
 	/* Remove table from LRU or non-LRU list. */
 	if (table->can_be_evicted) {
@@ -6355,10 +6574,12 @@ dict_close(void)
 		}
 	}
 
+	hash_free_sync_obj(dict_sys->table_hash);
 	hash_table_free(dict_sys->table_hash);
 
 	/* The elements are the same instance as in dict_sys->table_hash,
 	therefore we don't delete the individual elements. */
+	hash_free_sync_obj(dict_sys->table_id_hash);
 	hash_table_free(dict_sys->table_id_hash);
 
 	dict_ind_free();
@@ -944,6 +944,47 @@ dict_insert_tablespace_and_filepath(
 	return(err);
 }
 
+/********************************************************************//**
+Opens the tablespaces that dict_check_tablespaces_and_store_max_id()
+queued at a normal startup. Tablespaces with a link file are opened here,
+because their SYS_DATAFILES record may need to be fixed. */
+static
+void
+dict_open_queued_tablespaces(
+/*=========================*/
+	fil_open_item_t**	items,	/*!< in/out: queued tablespaces */
+	ulint			n_items)/*!< in: number of items */
+{
+#ifdef UNIV_SYNC_DEBUG
+	ut_ad(rw_lock_own(&dict_operation_lock, RW_LOCK_EX));
+#endif /* UNIV_SYNC_DEBUG */
+	ut_ad(mutex_own(&dict_sys->mutex));
+
+	fil_open_single_table_tablespaces(items, n_items);
+
+	for (ulint i = 0; i < n_items; i++) {
+		fil_open_item_t*	item = items[i];
+
+		if (item->has_link) {
+			item->err = fil_open_single_table_tablespace(
+				false, srv_read_only_mode ? false : true,
+				item->id, item->flags, item->tablename, NULL);
+		}
+
+		if (item->err != DB_SUCCESS) {
+			char	table_name[MAX_FULL_NAME_LEN + 1];
+
+			innobase_format_name(
+				table_name, sizeof(table_name),
+				item->tablename, FALSE);
+
+			ib_logf(IB_LOG_LEVEL_ERROR,
+				"Tablespace open failed for '%s', "
+				"ignored.", table_name);
+		}
+	}
+}
+
 /********************************************************************//**
 This function looks at each table defined in SYS_TABLES.  It checks the
 tablespace for any table with a space_id > 0.  It looks up the tablespace
@@ -954,7 +995,9 @@ This function compares the space id information in the InnoDB data dictionary
 to what we already read with fil_load_single_table_tablespaces().
 
 In a normal startup, we create the tablespace objects for every table in
-InnoDB's data dictionary, if the corresponding .ibd file exists.
+InnoDB's data dictionary, if the corresponding .ibd file exists. Tables
+in the default location are queued and their .ibd files are checked in
+parallel once SYS_TABLES has been scanned.
 We also scan the biggest space id, and store it to fil_system. */
 UNIV_INTERN
 void
@@ -968,6 +1011,10 @@ dict_check_tablespaces_and_store_max_id(
 	const rec_t*	rec;
 	ulint		max_space_id;
 	mtr_t		mtr;
+	mem_heap_t*	heap		= mem_heap_create(1024);
+	fil_open_item_t** items		= NULL;
+	ulint		n_items		= 0;
+	ulint		max_items	= 0;
 
 	rw_lock_x_lock(&dict_operation_lock);
 	mutex_enter(&(dict_sys->mutex));
@@ -996,6 +1043,11 @@ loop:
 		btr_pcur_close(&pcur);
 		mtr_commit(&mtr);
 
+		dict_open_queued_tablespaces(items, n_items);
+
+		ut_free(items);
+		mem_heap_free(heap);
+
 		/* We must make the tablespace cache aware of the biggest
 		known space id */
 
@@ -1151,6 +1203,27 @@ loop:
 			if (DICT_TF_HAS_DATA_DIR(flags)) {
 				filepath = dict_get_first_path(
 					space_id, name);
+			} else {
+				fil_open_item_t*	item;
+
+				/* The .ibd file should be in the
+				default location. */
+				if (n_items == max_items) {
+					max_items = max_items
+						? 2 * max_items : 1024;
+					items = static_cast<fil_open_item_t**>(
+						ut_realloc(items, max_items
+							   * sizeof *items));
+					ut_a(items != NULL);
+				}
+
+				item = static_cast<fil_open_item_t*>(
+					mem_heap_alloc(heap, sizeof *item));
+				item->id = space_id;
+				item->flags = dict_tf_to_fsp_flags(flags);
+				item->tablename = mem_heap_strdup(heap, name);
+				items[n_items++] = item;
+				break;
 			}
 
 			/* We set the 2nd param (fix_dict = true)
@@ -50,6 +50,7 @@ Created 10/25/1995 Heikki Tuuri
 # include "ibuf0ibuf.h"
 # include "sync0sync.h"
 # include "os0sync.h"
+# include "srv0mon.h"
 #else /* !UNIV_HOTBACKUP */
 # include "srv0srv.h"
 static ulint srv_data_read, srv_data_written;
@@ -140,6 +141,24 @@ UNIV_INTERN mysql_pfs_key_t	fil_system_mutex_key;
 UNIV_INTERN mysql_pfs_key_t	fil_space_latch_key;
 #endif /* UNIV_PFS_RWLOCK */
 
+#ifdef UNIV_PFS_THREAD
+/* Key to register the file flush thread with performance schema */
+UNIV_INTERN mysql_pfs_key_t	fil_flush_thread_key;
+/* Key to register the startup tablespace loading threads with
+performance schema */
+UNIV_INTERN mysql_pfs_key_t	fil_load_thread_key;
+#endif /* UNIV_PFS_THREAD */
+
+#ifndef UNIV_HOTBACKUP
+/** true while fil_flush_thread is running */
+static bool	fil_flush_thread_active	= false;
+#endif /* !UNIV_HOTBACKUP */
+
+/** The file flush thread is woken up when fewer than 1/FIL_LRU_RESERVE of
+innodb_open_files can be closed without a flush and fewer than that many
+more files may be opened */
+#define FIL_LRU_RESERVE		8
+
 /** File node of a tablespace or the log data space */
 struct fil_node_t {
 	fil_space_t*	space;	/*!< backpointer to the space where this node
@@ -157,7 +176,11 @@ struct fil_node_t {
 	ulint		n_pending;
 				/*!< count of pending i/o's on this file;
 				closing of the file is not allowed if
-				this is > 0 */
+				this is > 0. Updated atomically when
+				FIL_IO_SHARED is defined; it may only be
+				incremented from 0 while holding
+				fil_system->mutex if the node belongs to
+				fil_system->LRU or is closed */
 	ulint		n_pending_flushes;
 				/*!< count of pending flushes on this file;
 				closing of the file is not allowed if
@@ -180,6 +203,9 @@ struct fil_node_t {
 /** Value of fil_node_t::magic_n */
 #define	FIL_NODE_MAGIC_N	89389
 
+/** Number of rw_locks protecting fil_system->spaces */
+#define FIL_SPACE_HASH_N_LOCKS	64
+
 /** Tablespace or log data space: let us call them by a common name space */
 struct fil_space_t {
 	char*		name;	/*!< space name = the path to the first file in
@@ -265,20 +291,26 @@ struct fil_system_t {
 #endif /* !UNIV_HOTBACKUP */
 	hash_table_t*	spaces;		/*!< The hash table of spaces in the
 					system; they are hashed on the space
-					id */
+					id. Modified while holding both the
+					mutex and the rw_lock of the hash
+					cell in X mode; the i/o path may
+					search it holding only the rw_lock
+					in S mode */
 	hash_table_t*	name_hash;	/*!< hash table based on the space
 					name */
 	UT_LIST_BASE_NODE_T(fil_node_t) LRU;
 					/*!< base node for the LRU list of the
 					most recently used open files with no
-					pending i/o's; if we start an i/o on
-					the file, we first remove it from this
-					list, and return it to the start of
-					the list when the i/o ends;
-					log files and the system tablespace are
-					not put to this list: they are opened
-					after the startup, and kept open until
-					shutdown */
+					pending i/o's and no unflushed writes,
+					so that the last one can always be
+					closed; if we start an i/o on the file,
+					we first remove it from this list, and
+					return it to the start of the list when
+					the i/o ends, or when fil_flush() has
+					flushed the writes; log files and the
+					system tablespace are not put to this
+					list: they are opened after the
+					startup, and kept open until shutdown */
 	UT_LIST_BASE_NODE_T(fil_space_t) unflushed_spaces;
 					/*!< base node for the list of those
 					tablespaces whose files contain
@@ -331,6 +363,11 @@ static fil_system_t*	fil_system	= NULL;
 # define fil_buffering_disabled(s)	(0)
 #endif /* __WIN__ */
 
+#if defined HAVE_ATOMIC_BUILTINS && !defined UNIV_HOTBACKUP
+/** Define if i/o on already open files may bypass fil_system->mutex */
+# define FIL_IO_SHARED
+#endif /* HAVE_ATOMIC_BUILTINS && !UNIV_HOTBACKUP */
+
 #ifdef UNIV_DEBUG
 /** Try fil_validate() every this many times */
 # define FIL_VALIDATE_SKIP	17
@@ -373,6 +410,58 @@ fil_space_belongs_in_lru(
 	       && fil_is_user_tablespace_id(space->id));
 }
 
+/********************************************************************//**
+Determines if an open file node is in the LRU list. Files with pending
+i/o's or unflushed writes are kept out of the list, so that any file in it
+can be closed right away. The caller must hold the fil_sys mutex.
+@return true if the node is in fil_system->LRU */
+UNIV_INLINE
+bool
+fil_node_is_in_lru(
+/*===============*/
+	const fil_node_t*	node)	/*!< in: file node */
+{
+	ut_ad(mutex_own(&fil_system->mutex));
+
+	return(node->open
+	       && node->n_pending == 0
+	       && node->modification_counter == node->flush_counter
+	       && fil_space_belongs_in_lru(node->space));
+}
+
+#ifndef UNIV_HOTBACKUP
+/********************************************************************//**
+Determines if the open files must be flushed so that some of them can be
+closed when more files are opened. The caller must hold the fil_sys mutex.
+@return true if fil_flush_thread should flush the files */
+UNIV_INLINE
+bool
+fil_open_files_need_flush(void)
+/*===========================*/
+{
+	ulint	reserve = fil_system->max_n_open / FIL_LRU_RESERVE + 1;
+
+	ut_ad(mutex_own(&fil_system->mutex));
+
+	return(UT_LIST_GET_LEN(fil_system->unflushed_spaces) > 0
+	       && UT_LIST_GET_LEN(fil_system->LRU) < reserve
+	       && fil_system->n_open + reserve >= fil_system->max_n_open);
+}
+
+/********************************************************************//**
+Wakes up fil_flush_thread if the open files need to be flushed. The
+caller must hold the fil_sys mutex. */
+UNIV_INLINE
+void
+fil_flush_thread_wakeup_if_needed(void)
+/*===================================*/
+{
+	if (fil_flush_thread_active && fil_open_files_need_flush()) {
+		os_event_set(srv_fil_flush_event);
+	}
+}
+#endif /* !UNIV_HOTBACKUP */
+
 /********************************************************************//**
 NOTE: you must call fil_mutex_enter_and_prepare_for_io() first!
 
@@ -882,7 +971,7 @@ add_size:
 	system->n_open++;
 	fil_n_file_opened++;
 
-	if (fil_space_belongs_in_lru(space)) {
+	if (fil_node_is_in_lru(node)) {
 
 		/* Put the node to the LRU list */
 		UT_LIST_ADD_FIRST(LRU, system->LRU, node);
@@ -918,18 +1007,18 @@ fil_node_close_file(
 
 	/* printf("Closing file %s\n", node->name); */
 
-	node->open = FALSE;
-	ut_a(system->n_open > 0);
-	system->n_open--;
-	fil_n_file_opened--;
-
-	if (fil_space_belongs_in_lru(node->space)) {
+	if (fil_node_is_in_lru(node)) {
 
 		ut_a(UT_LIST_GET_LEN(system->LRU) > 0);
 
 		/* The node is in the LRU list, remove it */
 		UT_LIST_REMOVE(LRU, system->LRU, node);
 	}
+
+	node->open = FALSE;
+	ut_a(system->n_open > 0);
+	system->n_open--;
+	fil_n_file_opened--;
 }
 
 /********************************************************************//**
@@ -957,50 +1046,47 @@ fil_try_to_close_file_in_LRU(
 			(ulong) UT_LIST_GET_LEN(fil_system->LRU));
 	}
 
-	for (node = UT_LIST_GET_LAST(fil_system->LRU);
-	     node != NULL;
-	     node = UT_LIST_GET_PREV(LRU, node)) {
-
-		if (node->modification_counter == node->flush_counter
-		    && node->n_pending_flushes == 0
-		    && !node->being_extended) {
-
-			fil_node_close_file(node, fil_system);
-
-			return(TRUE);
-		}
+	/* Only files without pending i/o's or unflushed writes are
+	kept in the LRU list, so the least recently used one can be
+	closed without looking further. */
+	node = UT_LIST_GET_LAST(fil_system->LRU);
 
-		if (!print_info) {
-			continue;
-		}
-
-		if (node->n_pending_flushes > 0) {
-			fputs("InnoDB: cannot close file ", stderr);
-			ut_print_filename(stderr, node->name);
-			fprintf(stderr, ", because n_pending_flushes %lu\n",
-				(ulong) node->n_pending_flushes);
-		}
+	if (node != NULL) {
+		ut_ad(node->n_pending_flushes == 0);
+		ut_ad(!node->being_extended);
 
-		if (node->modification_counter != node->flush_counter) {
-			fputs("InnoDB: cannot close file ", stderr);
-			ut_print_filename(stderr, node->name);
-			fprintf(stderr,
-				", because mod_count %ld != fl_count %ld\n",
-				(long) node->modification_counter,
-				(long) node->flush_counter);
+		fil_node_close_file(node, fil_system);
 
-		}
+		return(TRUE);
+	}
 
-		if (node->being_extended) {
-			fputs("InnoDB: cannot close file ", stderr);
-			ut_print_filename(stderr, node->name);
-			fprintf(stderr, ", because it is being extended\n");
-		}
+	if (print_info) {
+		fprintf(stderr,
+			"InnoDB: cannot close any of the %lu open files,"
+			" because they have pending i/o's"
+			" or unflushed writes\n",
+			(ulong) fil_system->n_open);
 	}
 
 	return(FALSE);
 }
 
+#ifndef UNIV_HOTBACKUP
+/********************************************************************//**
+Acquires fil_system->mutex on the i/o path, counting the acquisitions
+that had to wait for it. */
+UNIV_INLINE
+void
+fil_mutex_enter_for_io(void)
+/*========================*/
+{
+	if (mutex_enter_nowait(&fil_system->mutex)) {
+		MONITOR_ATOMIC_INC(MONITOR_FIL_SYSTEM_MUTEX_WAIT);
+		mutex_enter(&fil_system->mutex);
+	}
+}
+#endif /* !UNIV_HOTBACKUP */
+
 /*******************************************************************//**
 Reserves the fil_system mutex and tries to make sure we can open at least one
 file while holding it. This should be called before calling
@@ -1014,11 +1100,16 @@ fil_mutex_enter_and_prepare_for_io(
 	fil_space_t*	space;
 	ibool		success;
 	ibool		print_info	= FALSE;
+	ibool		flush_requested	= FALSE;
 	ulint		count		= 0;
 	ulint		count2		= 0;
 
 retry:
+#ifndef UNIV_HOTBACKUP
+	fil_mutex_enter_for_io();
+#else /* !UNIV_HOTBACKUP */
 	mutex_enter(&fil_system->mutex);
+#endif /* !UNIV_HOTBACKUP */
 
 	if (space_id == 0 || space_id >= SRV_LOG_SPACE_FIRST_ID) {
 		/* We keep log files and system tablespace files always open;
@@ -1127,6 +1218,16 @@ close_more:
 	performed */
 	os_aio_simulated_wake_handler_threads();
 
+	if (!flush_requested && fil_flush_thread_active) {
+		/* Let the file flush thread flush the files in one
+		batch; only flush them ourselves if that was not
+		enough. */
+		flush_requested = TRUE;
+		os_event_set(srv_fil_flush_event);
+		os_thread_sleep(20000);
+		goto retry;
+	}
+
 	os_thread_sleep(20000);
 #endif
 	/* Flush tablespaces so that we can close modified files in the LRU
@@ -1156,10 +1257,18 @@ fil_node_free(
 	ut_a(!node->being_extended);
 
 	if (node->open) {
+		bool	in_lru = fil_node_is_in_lru(node);
+
 		/* We fool the assertion in fil_node_close_file() to think
 		there are no unflushed modifications in the file */
 
 		node->modification_counter = node->flush_counter;
+
+		if (!in_lru && fil_node_is_in_lru(node)) {
+			/* fil_node_close_file() will take the node off
+			the LRU list now that it looks flushed */
+			UT_LIST_ADD_FIRST(LRU, system->LRU, node);
+		}
 		os_event_set(node->sync_event);
 
 		if (fil_buffering_disabled(space)) {
@@ -1356,7 +1465,9 @@ fil_space_create(
 
 	rw_lock_create(fil_space_latch_key, &space->latch, SYNC_FSP);
 
+	hash_lock_x(fil_system->spaces, id);
 	HASH_INSERT(fil_space_t, hash, fil_system->spaces, id, space);
+	hash_unlock_x(fil_system->spaces, id);
 
 	HASH_INSERT(fil_space_t, name_hash, fil_system->name_hash,
 		    ut_fold_string(name), space);
@@ -1462,7 +1573,9 @@ fil_space_free(
 		return(FALSE);
 	}
 
+	hash_lock_x(fil_system->spaces, id);
 	HASH_DELETE(fil_space_t, hash, fil_system->spaces, id, space);
+	hash_unlock_x(fil_system->spaces, id);
 
 	fnamespace = fil_space_get_by_name(space->name);
 	ut_a(fnamespace);
@@ -1729,6 +1842,10 @@ fil_init(
 
 	fil_system->spaces = hash_create(hash_size);
 	fil_system->name_hash = hash_create(hash_size);
+#ifndef UNIV_HOTBACKUP
+	hash_create_sync_obj(fil_system->spaces, HASH_TABLE_SYNC_RW_LOCK,
+			     FIL_SPACE_HASH_N_LOCKS, SYNC_FIL_SPACE_HASH);
+#endif /* !UNIV_HOTBACKUP */
 
 	UT_LIST_INIT(fil_system->LRU);
 
@@ -4598,6 +4715,249 @@ func_exit_after_close:
 	mem_free(def.filepath);
 }
 
+#ifndef UNIV_HOTBACKUP
+/** Minimum number of tablespaces handed to each thread that opens
+tablespaces at startup. Below this, starting threads costs more than
+the file system calls they would save. */
+#define FIL_LOAD_ITEMS_PER_THREAD	64
+
+/** Work queue shared by the threads that open tablespaces at startup */
+struct fil_load_queue_t {
+	os_fast_mutex_t	mutex;		/*!< protects next and n_running */
+	void**		items;		/*!< work items */
+	ulint		n_items;	/*!< number of work items */
+	ulint		next;		/*!< index of the next item to be
+					processed */
+	ulint		n_running;	/*!< number of helper threads that
+					have not finished yet */
+	os_event_t	done;		/*!< set when n_running drops to 0 */
+	void		(*func)(void*);	/*!< processes one work item */
+};
+
+/********************************************************************//**
+Processes work items from a tablespace loading queue until it is empty. */
+static
+void
+fil_load_queue_process(
+/*===================*/
+	fil_load_queue_t*	queue)	/*!< in/out: work queue */
+{
+	for (;;) {
+		void*	item;
+
+		os_fast_mutex_lock(&queue->mutex);
+
+		if (queue->next == queue->n_items) {
+			os_fast_mutex_unlock(&queue->mutex);
+			return;
+		}
+
+		item = queue->items[queue->next++];
+
+		os_fast_mutex_unlock(&queue->mutex);
+
+		queue->func(item);
+	}
+}
+
+/********************************************************************//**
+Helper thread that opens tablespaces in parallel with the thread that
+started it.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(fil_load_thread)(
+/*============================*/
+	void*	arg)	/*!< in: fil_load_queue_t* */
+{
+	fil_load_queue_t*	queue = static_cast<fil_load_queue_t*>(arg);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(fil_load_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	fil_load_queue_process(queue);
+
+	os_fast_mutex_lock(&queue->mutex);
+
+	ut_ad(queue->n_running > 0);
+
+	if (--queue->n_running == 0) {
+		os_event_set(queue->done);
+	}
+
+	os_fast_mutex_unlock(&queue->mutex);
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/********************************************************************//**
+Applies func to every work item. Opening a tablespace is dominated by
+file system latency, so when there are many items the work is shared
+between the calling thread and up to srv_n_read_io_threads - 1 helper
+threads. Returns when all the items have been processed. */
+static
+void
+fil_load_queue_run(
+/*===============*/
+	void		(*func)(void*),	/*!< in: processes one work item */
+	void**		items,		/*!< in: work items */
+	ulint		n_items)	/*!< in: number of work items */
+{
+	fil_load_queue_t	queue;
+	ulint			n_threads;
+
+	n_threads = ut_min(srv_n_read_io_threads,
+			   n_items / FIL_LOAD_ITEMS_PER_THREAD);
+
+	queue.items = items;
+	queue.n_items = n_items;
+	queue.next = 0;
+	queue.func = func;
+
+	if (n_threads <= 1) {
+		for (ulint i = 0; i < n_items; i++) {
+			func(items[i]);
+		}
+
+		return;
+	}
+
+	os_fast_mutex_init(PFS_NOT_INSTRUMENTED, &queue.mutex);
+	queue.done = os_event_create();
+	queue.n_running = n_threads - 1;
+
+	for (ulint i = 1; i < n_threads; i++) {
+		os_thread_create(fil_load_thread, &queue, NULL);
+	}
+
+	fil_load_queue_process(&queue);
+
+	os_event_wait(queue.done);
+
+	/* The last helper thread sets the event while holding the
+	mutex. Wait for it to release the mutex before queue goes out
+	of scope. */
+	os_fast_mutex_lock(&queue.mutex);
+	ut_ad(queue.n_running == 0);
+	os_fast_mutex_unlock(&queue.mutex);
+
+	os_event_free(queue.done);
+	os_fast_mutex_free(&queue.mutex);
+}
+
+/** A single-table tablespace file found by
+fil_load_single_table_tablespaces() */
+struct fil_load_item_t {
+	char*	dbname;		/*!< database name */
+	char*	filename;	/*!< file name, including the .ibd or
+				.isl extension */
+};
+
+/********************************************************************//**
+fil_load_queue_run() callback for fil_load_single_table_tablespaces(). */
+static
+void
+fil_load_item_process(
+/*==================*/
+	void*	arg)	/*!< in: fil_load_item_t* */
+{
+	const fil_load_item_t*	item = static_cast<fil_load_item_t*>(arg);
+
+	fil_load_single_table_tablespace(item->dbname, item->filename);
+}
+
+/********************************************************************//**
+fil_load_queue_run() callback for fil_open_single_table_tablespaces(). */
+static
+void
+fil_open_item_process(
+/*==================*/
+	void*	arg)	/*!< in/out: fil_open_item_t* */
+{
+	fil_open_item_t*	item = static_cast<fil_open_item_t*>(arg);
+	char*			link_filepath;
+	ibool			exists;
+	os_file_type_t		type;
+
+	/* A linked tablespace may require the data dictionary to be
+	updated, which only the caller can do. */
+	link_filepath = fil_make_isl_name(item->tablename);
+
+	item->has_link = !os_file_status(link_filepath, &exists, &type)
+		|| exists;
+
+	mem_free(link_filepath);
+
+	if (item->has_link) {
+		item->err = DB_SUCCESS;
+		return;
+	}
+
+	item->err = fil_open_single_table_tablespace(
+		false, false, item->id, item->flags, item->tablename, NULL);
+}
+
+/********************************************************************//**
+Checks if an .ibd or .isl file found in a database directory must be
+passed to fil_load_single_table_tablespace(). That function looks at
+both the .ibd and the .isl file of a table, so an .isl file is skipped
+when the .ibd file exists in the same directory.
+@return false if the file is handled together with the .ibd file */
+static
+bool
+fil_load_isl_is_needed(
+/*===================*/
+	const char*	dbpath,		/*!< in: database directory path */
+	const char*	filename)	/*!< in: file name, including the
+					.ibd or .isl extension */
+{
+	ulint		filename_len = strlen(filename);
+	ulint		len;
+	char*		ibd_filepath;
+	ibool		exists;
+	os_file_type_t	type;
+
+	if (0 != strcmp(filename + filename_len - 4, ".isl")) {
+		return(true);
+	}
+
+	len = strlen(dbpath) + filename_len + 2;
+	ibd_filepath = static_cast<char*>(mem_alloc(len));
+	ut_snprintf(ibd_filepath, len, "%s/%.*s.ibd",
+		    dbpath, (int) (filename_len - 4), filename);
+
+	if (!os_file_status(ibd_filepath, &exists, &type)) {
+		exists = FALSE;
+	}
+
+	mem_free(ibd_filepath);
+
+	return(!exists);
+}
+
+/********************************************************************//**
+Opens the single-table tablespaces of tables found in the data dictionary
+at a normal startup. The existence checks done by
+fil_open_single_table_tablespace() are spread over several threads. The
+dictionary is not updated: item->has_link is set instead for tablespaces
+with an .isl file, and the caller must open those itself. */
+UNIV_INTERN
+void
+fil_open_single_table_tablespaces(
+/*==============================*/
+	fil_open_item_t**	items,	/*!< in/out: tablespaces to open */
+	ulint			n_items)/*!< in: number of items */
+{
+	fil_load_queue_run(fil_open_item_process,
+			   reinterpret_cast<void**>(items), n_items);
+}
+#endif /* !UNIV_HOTBACKUP */
+
 /***********************************************************************//**
 A fault-tolerant function that tries to read the next file name in the
 directory. We retry 100 times if os_file_readdir_next_file() returns -1. The
@@ -4640,7 +5000,8 @@ directories under the MySQL datadir, looking for .ibd files. Those files are
 single-table tablespaces. We need to know the space id in each of them so that
 we know into which file we should look to check the contents of a page stored
 in the doublewrite buffer, also to know where to apply log records where the
-space id is != 0.
+space id is != 0. The directories are scanned first and the files found are
+then opened and validated by several threads.
 @return	DB_SUCCESS or error number */
 UNIV_INTERN
 dberr_t
@@ -4655,6 +5016,12 @@ fil_load_single_table_tablespaces(void)
 	os_file_stat_t	dbinfo;
 	os_file_stat_t	fileinfo;
 	dberr_t		err		= DB_SUCCESS;
+#ifndef UNIV_HOTBACKUP
+	mem_heap_t*	heap;
+	void**		items		= NULL;
+	ulint		n_items		= 0;
+	ulint		max_items	= 0;
+#endif /* !UNIV_HOTBACKUP */
 
 	/* The datadir of MySQL is always the default directory of mysqld */
 
@@ -4666,6 +5033,9 @@ fil_load_single_table_tablespaces(void)
 	}
 
 	dbpath = static_cast<char*>(mem_alloc(dbpath_len));
+#ifndef UNIV_HOTBACKUP
+	heap = mem_heap_create(1024);
+#endif /* !UNIV_HOTBACKUP */
 
 	/* Scan all directories under the datadir. They are the database
 	directories of MySQL. */
@@ -4724,10 +5094,44 @@ fil_load_single_table_tablespaces(void)
 					|| 0 == strcmp(fileinfo.name
 						   + strlen(fileinfo.name) - 4,
 						   ".isl"))) {
+#ifndef UNIV_HOTBACKUP
+					fil_load_item_t*	item;
+
+					/* The name ends in .ibd or .isl.
+					Both files of a table are handled
+					by the same call, so queue an .isl
+					file only if there is no .ibd file
+					next to it. */
+					if (!fil_load_isl_is_needed(
+						    dbpath, fileinfo.name)) {
+						goto next_file_item;
+					}
+
+					if (n_items == max_items) {
+						max_items = max_items
+							? 2 * max_items : 1024;
+						items = static_cast<void**>(
+							ut_realloc(
+								items,
+								max_items
+								* sizeof *items));
+						ut_a(items != NULL);
+					}
+
+					item = static_cast<fil_load_item_t*>(
+						mem_heap_alloc(
+							heap, sizeof *item));
+					item->dbname = mem_heap_strdup(
+						heap, dbinfo.name);
+					item->filename = mem_heap_strdup(
+						heap, fileinfo.name);
+					items[n_items++] = item;
+#else
 					/* The name ends in .ibd or .isl;
 					try opening the file */
 					fil_load_single_table_tablespace(
 						dbinfo.name, fileinfo.name);
+#endif /* !UNIV_HOTBACKUP */
 				}
 next_file_item:
 				ret = fil_file_readdir_next_file(&err,
@@ -4757,9 +5161,16 @@ next_datadir_item:
 		fprintf(stderr,
 			"InnoDB: Error: could not close MySQL datadir\n");
 
-		return(DB_ERROR);
+		err = DB_ERROR;
 	}
 
+#ifndef UNIV_HOTBACKUP
+	fil_load_queue_run(fil_load_item_process, items, n_items);
+
+	ut_free(items);
+	mem_heap_free(heap);
+#endif /* !UNIV_HOTBACKUP */
+
 	return(err);
 }
 
@@ -5434,7 +5845,7 @@ fil_node_prepare_for_io(
 		}
 	}
 
-	if (node->n_pending == 0 && fil_space_belongs_in_lru(space)) {
+	if (fil_node_is_in_lru(node)) {
 		/* The node is in the LRU list, remove it */
 
 		ut_a(UT_LIST_GET_LEN(system->LRU) > 0);
@@ -5442,7 +5853,11 @@ fil_node_prepare_for_io(
 		UT_LIST_REMOVE(LRU, system->LRU, node);
 	}
 
+#ifdef FIL_IO_SHARED
+	os_atomic_increment_ulint(&node->n_pending, 1);
+#else /* FIL_IO_SHARED */
 	node->n_pending++;
+#endif /* FIL_IO_SHARED */
 
 	return(true);
 }
@@ -5466,7 +5881,11 @@ fil_node_complete_io(
 
 	ut_a(node->n_pending > 0);
 
+#ifdef FIL_IO_SHARED
+	os_atomic_decrement_ulint(&node->n_pending, 1);
+#else /* FIL_IO_SHARED */
 	node->n_pending--;
+#endif /* FIL_IO_SHARED */
 
 	if (type == OS_FILE_WRITE) {
 		ut_ad(!srv_read_only_mode);
@@ -5490,13 +5909,246 @@ fil_node_complete_io(
 		}
 	}
 
-	if (node->n_pending == 0 && fil_space_belongs_in_lru(node->space)) {
+	if (fil_node_is_in_lru(node)) {
 
 		/* The node must be put back to the LRU list */
 		UT_LIST_ADD_FIRST(LRU, system->LRU, node);
+
+	}
+#ifndef UNIV_HOTBACKUP
+	else if (type == OS_FILE_WRITE
+		 && fil_space_belongs_in_lru(node->space)) {
+
+		/* The file can only be closed after it has been
+		flushed. */
+		fil_flush_thread_wakeup_if_needed();
+	}
+#endif /* !UNIV_HOTBACKUP */
+}
+
+#ifdef FIL_IO_SHARED
+/********************************************************************//**
+Tries to reserve an already open file node for i/o without acquiring
+fil_system->mutex. This fails whenever fil_node_prepare_for_io() would have
+to change the state of fil_system: when the node must be taken off the LRU
+list or the file must be opened.
+@return true if node->n_pending was incremented */
+UNIV_INLINE
+bool
+fil_node_prepare_for_io_shared(
+/*===========================*/
+	fil_node_t*	node)	/*!< in/out: file node */
+{
+	for (;;) {
+		ulint	n_pending = node->n_pending;
+
+		if (n_pending == 0
+		    && (!node->open || fil_space_belongs_in_lru(node->space))) {
+
+			return(false);
+		}
+
+		if (os_compare_and_swap_ulint(&node->n_pending,
+					      n_pending, n_pending + 1)) {
+			return(true);
+		}
+	}
+}
+
+/********************************************************************//**
+Tries to complete a read on a file node without acquiring
+fil_system->mutex. This fails if the node must be put back to the LRU list.
+@return true if node->n_pending was decremented */
+UNIV_INLINE
+bool
+fil_node_complete_read_shared(
+/*==========================*/
+	fil_node_t*	node)	/*!< in/out: file node */
+{
+	for (;;) {
+		ulint	n_pending = node->n_pending;
+
+		ut_a(n_pending > 0);
+
+		if (n_pending == 1 && fil_space_belongs_in_lru(node->space)) {
+			return(false);
+		}
+
+		if (os_compare_and_swap_ulint(&node->n_pending,
+					      n_pending, n_pending - 1)) {
+			return(true);
+		}
 	}
 }
 
+/********************************************************************//**
+Looks up the file node for a page of a tablespace and reserves it for i/o,
+without acquiring fil_system->mutex. Only files that are already open and
+tablespaces that are not being renamed or dropped qualify; everything else
+must go through fil_mutex_enter_and_prepare_for_io().
+@return file node with n_pending incremented, or NULL */
+static
+fil_node_t*
+fil_space_prepare_for_io_shared(
+/*============================*/
+	ulint		space_id,	/*!< in: space id */
+	ulint*		block_offset,	/*!< in: page number in the space;
+					out: page number in the file,
+					if found */
+	fil_space_t**	space)		/*!< out: tablespace, if found */
+{
+	fil_node_t*	node	= NULL;
+	ulint		offset	= *block_offset;
+
+	hash_lock_s(fil_system->spaces, space_id);
+
+	HASH_SEARCH(hash, fil_system->spaces, space_id,
+		    fil_space_t*, *space,
+		    ut_ad((*space)->magic_n == FIL_SPACE_MAGIC_N),
+		    (*space)->id == space_id);
+
+	if (*space != NULL && !(*space)->stop_ios
+	    && !(*space)->stop_new_ops) {
+
+		for (node = UT_LIST_GET_FIRST((*space)->chain);
+		     node != NULL && node->size <= offset;
+		     node = UT_LIST_GET_NEXT(chain, node)) {
+
+			if (node->size == 0) {
+				/* The size is not known until the
+				file has been opened */
+				node = NULL;
+				break;
+			}
+
+			offset -= node->size;
+		}
+
+		if (node != NULL && !fil_node_prepare_for_io_shared(node)) {
+			node = NULL;
+		}
+	}
+
+	hash_unlock_s(fil_system->spaces, space_id);
+
+	if (node != NULL) {
+		*block_offset = offset;
+		MONITOR_ATOMIC_INC(MONITOR_FIL_IO_SHARED);
+	}
+
+	return(node);
+}
+#endif /* FIL_IO_SHARED */
+
+#ifndef UNIV_HOTBACKUP
+/********************************************************************//**
+Updates the data structures when an i/o operation finishes, acquiring
+fil_system->mutex only if needed. */
+static
+void
+fil_io_complete(
+/*============*/
+	fil_node_t*	node,	/*!< in: file node */
+	ulint		type)	/*!< in: OS_FILE_WRITE or OS_FILE_READ */
+{
+#ifdef FIL_IO_SHARED
+	/* A read does not dirty the file; unless the node must return
+	to the LRU list, fil_system is not affected. */
+	if (type == OS_FILE_READ && fil_node_complete_read_shared(node)) {
+		MONITOR_ATOMIC_INC(MONITOR_FIL_IO_SHARED);
+		return;
+	}
+#endif /* FIL_IO_SHARED */
+
+	fil_mutex_enter_for_io();
+
+	fil_node_complete_io(node, fil_system, type);
+
+	mutex_exit(&fil_system->mutex);
+}
+#endif /* !UNIV_HOTBACKUP */
+
+#ifndef UNIV_HOTBACKUP
+/********************************************************************//**
+Opens again the file of a single-table tablespace that was closed by the
+LRU policy, doing the system call without holding fil_system->mutex. The
+file is only installed in the node if the tablespace was not renamed,
+dropped or re-created, and the file was not opened by another thread in
+the meantime. The caller must hold fil_system->mutex; it is released and
+acquired again, so the caller must look up the tablespace again. */
+static
+void
+fil_node_reopen_file(
+/*=================*/
+	fil_node_t*	node)	/*!< in: closed file node whose size
+				is known */
+{
+	fil_space_t*	space		= node->space;
+	ulint		space_id	= space->id;
+	ib_int64_t	version		= space->tablespace_version;
+	char*		name		= mem_strdup(node->name);
+	ulint		create_mode;
+	os_file_t	handle;
+	ibool		success;
+
+	ut_ad(mutex_own(&fil_system->mutex));
+	ut_ad(!node->open);
+	ut_ad(node->size > 0);
+	ut_ad(fil_space_belongs_in_lru(space));
+
+	create_mode = (node->is_raw_disk ? OS_FILE_OPEN_RAW : OS_FILE_OPEN)
+		| OS_FILE_ON_ERROR_NO_EXIT | OS_FILE_ON_ERROR_SILENT;
+
+	mutex_exit(&fil_system->mutex);
+
+	handle = os_file_create(innodb_file_data_key, name, create_mode,
+				OS_FILE_AIO, OS_DATA_FILE, &success);
+
+	fil_mutex_enter_for_io();
+
+	if (!success) {
+		/* Let fil_node_open_file() report the error, if the
+		file is still expected to exist */
+		mem_free(name);
+		return;
+	}
+
+	space = fil_space_get_by_id(space_id);
+	node = space != NULL ? UT_LIST_GET_FIRST(space->chain) : NULL;
+
+	if (node == NULL
+	    || space->tablespace_version != version
+	    || space->stop_ios
+	    || node->open
+	    || strcmp(node->name, name)) {
+
+		os_file_close(handle);
+		mem_free(name);
+		return;
+	}
+
+	mem_free(name);
+
+	if (fil_system->n_open >= fil_system->max_n_open) {
+		fil_try_to_close_file_in_LRU(FALSE);
+	}
+
+	ut_a(node->n_pending == 0);
+
+	node->handle = handle;
+	node->open = TRUE;
+
+	fil_system->n_open++;
+	fil_n_file_opened++;
+
+	if (fil_node_is_in_lru(node)) {
+		UT_LIST_ADD_FIRST(LRU, fil_system->LRU, node);
+	}
+
+	MONITOR_INC(MONITOR_FIL_REOPEN_WITHOUT_MUTEX);
+}
+#endif /* !UNIV_HOTBACKUP */
+
 /********************************************************************//**
 Report information about an invalid page access. */
 static
@@ -5623,6 +6275,18 @@ _fil_io(
 		srv_stats.data_written.add(len);
 	}
 
+#ifdef FIL_IO_SHARED
+	node = fil_space_prepare_for_io_shared(space_id, &block_offset,
+					       &space);
+
+	if (node != NULL) {
+		ut_ad(mode != OS_AIO_IBUF
+		      || space->purpose == FIL_TABLESPACE);
+
+		goto do_io;
+	}
+#endif /* FIL_IO_SHARED */
+
 	/* Reserve the fil_system mutex and make sure that we can open at
 	least one file while holding it, if the file is not already open */
 
@@ -5630,6 +6294,21 @@ _fil_io(
 
 	space = fil_space_get_by_id(space_id);
 
+#ifndef UNIV_HOTBACKUP
+	if (space != NULL && fil_space_belongs_in_lru(space)) {
+
+		node = UT_LIST_GET_FIRST(space->chain);
+
+		if (!node->open && node->size > 0) {
+			/* The file was closed by the LRU policy; do not
+			block all other i/o while opening it again */
+			fil_node_reopen_file(node);
+
+			space = fil_space_get_by_id(space_id);
+		}
+	}
+#endif /* !UNIV_HOTBACKUP */
+
 	/* If we are deleting a tablespace we don't allow async read operations
 	on that. However, we do allow write and sync read operations */
 	if (space == 0
@@ -5717,6 +6396,9 @@ _fil_io(
 	/* Now we have made the changes in the data structures of fil_system */
 	mutex_exit(&fil_system->mutex);
 
+#ifdef FIL_IO_SHARED
+do_io:
+#endif /* FIL_IO_SHARED */
 	/* Calculate the low 32 bits and the high 32 bits of the file offset */
 
 	if (!zip_size) {
@@ -5754,9 +6436,7 @@ _fil_io(
 		if (srv_pass_corrupt_table == 1 ||
 		    type == OS_FILE_WRITE) {
 
-			mutex_enter(&fil_system->mutex);
-			fil_node_complete_io(node, fil_system, type);
-			mutex_exit(&fil_system->mutex);
+			fil_io_complete(node, type);
 			if (mode == OS_AIO_NORMAL) {
 				ut_a(space->purpose == FIL_TABLESPACE);
 				buf_page_io_complete(static_cast<buf_page_t *>
@@ -5794,11 +6474,15 @@ _fil_io(
 		/* The i/o operation is already completed when we return from
 		os_aio: */
 
+#ifndef UNIV_HOTBACKUP
+		fil_io_complete(node, type);
+#else /* !UNIV_HOTBACKUP */
 		mutex_enter(&fil_system->mutex);
 
 		fil_node_complete_io(node, fil_system, type);
 
 		mutex_exit(&fil_system->mutex);
+#endif /* !UNIV_HOTBACKUP */
 
 		ut_ad(fil_validate_skip());
 	}
@@ -5854,11 +6538,7 @@ fil_aio_wait(
 
 	srv_set_io_thread_op_info(segment, "complete io for fil node");
 
-	mutex_enter(&fil_system->mutex);
-
-	fil_node_complete_io(fil_node, fil_system, type);
-
-	mutex_exit(&fil_system->mutex);
+	fil_io_complete(fil_node, type);
 
 	ut_ad(fil_validate_skip());
 
@@ -5992,6 +6672,13 @@ skip_flush:
 		if (node->flush_counter < old_mod_counter) {
 			node->flush_counter = old_mod_counter;
 
+			if (fil_node_is_in_lru(node)) {
+				/* The file was waiting for this flush
+				before it could be closed */
+				UT_LIST_ADD_FIRST(LRU, fil_system->LRU,
+						  node);
+			}
+
 			if (space->is_in_unflushed_spaces
 			    && fil_space_is_flushed(space)) {
 
@@ -6070,6 +6757,76 @@ fil_flush_file_spaces(
 	mem_free(space_ids);
 }
 
+#ifndef UNIV_HOTBACKUP
+/*********************************************************************//**
+Checks if the file flush thread is running.
+@return true if fil_flush_thread is active */
+UNIV_INTERN
+bool
+fil_flush_thread_is_active(void)
+/*============================*/
+{
+	return(fil_flush_thread_active);
+}
+
+/*********************************************************************//**
+This thread flushes the tablespace files with unflushed writes in a batch
+when few of the open files could be closed without an fsync. Files with
+unflushed writes are kept out of fil_system->LRU, and flushing them here
+returns them to it, so that the threads doing i/o seldom have to flush
+files themselves before they can open another file.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(fil_flush_thread)(
+/*=============================*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	ut_ad(!srv_read_only_mode);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(fil_flush_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "InnoDB: file flush thread running, id %lu\n",
+		os_thread_pf(os_thread_get_curr_id()));
+#endif /* UNIV_DEBUG_THREAD_CREATION */
+
+	fil_flush_thread_active = true;
+
+	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+		ib_int64_t	sig_count;
+		bool		need_flush;
+
+		sig_count = os_event_reset(srv_fil_flush_event);
+
+		mutex_enter(&fil_system->mutex);
+		need_flush = fil_open_files_need_flush();
+		mutex_exit(&fil_system->mutex);
+
+		if (!need_flush) {
+			os_event_wait_low(srv_fil_flush_event, sig_count);
+			continue;
+		}
+
+		fil_flush_file_spaces(FIL_TABLESPACE);
+
+		MONITOR_INC(MONITOR_FIL_FLUSH_BATCH);
+	}
+
+	fil_flush_thread_active = false;
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+#endif /* !UNIV_HOTBACKUP */
+
 /** Functor to validate the space list. */
 struct	Check {
 	void	operator()(const fil_node_t* elem)
@@ -6132,6 +6889,8 @@ fil_validate(void)
 		ut_a(fil_node->n_pending == 0);
 		ut_a(!fil_node->being_extended);
 		ut_a(fil_node->open);
+		ut_a(fil_node->modification_counter
+		     == fil_node->flush_counter);
 		ut_a(fil_space_belongs_in_lru(fil_node->space));
 	}
 
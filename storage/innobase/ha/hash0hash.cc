@@ -400,4 +400,45 @@ hash_create_sync_obj_func(
 
 	table->n_sync_obj = n_sync_obj;
 }
+
+/*************************************************************//**
+Frees the sync objects created by hash_create_sync_obj(). */
+UNIV_INTERN
+void
+hash_free_sync_obj(
+/*===============*/
+	hash_table_t*	table)	/*!< in/out: hash table */
+{
+	ulint	i;
+
+	ut_ad(table);
+	ut_ad(table->magic_n == HASH_TABLE_MAGIC_N);
+
+	switch (table->type) {
+	case HASH_TABLE_SYNC_MUTEX:
+		for (i = 0; i < table->n_sync_obj; i++) {
+			mutex_free(table->sync_obj.mutexes + i);
+		}
+
+		mem_free(table->sync_obj.mutexes);
+		table->sync_obj.mutexes = NULL;
+		break;
+
+	case HASH_TABLE_SYNC_RW_LOCK:
+		for (i = 0; i < table->n_sync_obj; i++) {
+			rw_lock_free(table->sync_obj.rw_locks + i);
+		}
+
+		mem_free(table->sync_obj.rw_locks);
+		table->sync_obj.rw_locks = NULL;
+		break;
+
+	case HASH_TABLE_SYNC_NONE:
+		/* do nothing */
+		break;
+	}
+
+	table->n_sync_obj = 0;
+	table->type = HASH_TABLE_SYNC_NONE;
+}
 #endif /* !UNIV_HOTBACKUP */
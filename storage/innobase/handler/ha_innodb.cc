@@ -457,6 +457,10 @@ static PSI_thread_info	all_innodb_threads[] = {
 	{&srv_purge_thread_key, "srv_purge_thread", 0},
 	{&buf_page_cleaner_thread_key, "page_cleaner_thread", 0},
 	{&buf_lru_manager_thread_key, "lru_manager_thread", 0},
+	{&ibuf_merge_thread_key, "ibuf_merge_thread", 0},
+	{&fil_flush_thread_key, "fil_flush_thread", 0},
+	{&fil_load_thread_key, "fil_load_thread", 0},
+	{&row_pread_thread_key, "row_pread_thread", 0},
 	{&recv_writer_thread_key, "recv_writer_thread", 0},
 	{&srv_log_tracking_thread_key, "srv_redo_log_follow_thread", 0}
 };
@@ -4653,12 +4657,19 @@ ha_innobase::table_flags() const
 	/* Need to use tx_isolation here since table flags is (also)
 	called before prebuilt is inited. */
 	ulong const tx_isolation = thd_tx_isolation(ha_thd());
+	Table_flags flags = int_table_flags;
+
+	/* records() counts the rows with a parallel scan, which is only
+	worth it when the session allows more than one thread. */
+	if (thd_parallel_degree(ha_thd()) > 1) {
+		flags |= HA_HAS_RECORDS;
+	}
 
 	if (tx_isolation <= ISO_READ_COMMITTED) {
-		return(int_table_flags);
+		return(flags);
 	}
 
-	return(int_table_flags | HA_BINLOG_STMT_CAPABLE);
+	return(flags | HA_BINLOG_STMT_CAPABLE);
 }
 
 /****************************************************************//**
@@ -11380,6 +11391,65 @@ ha_innobase::estimate_rows_upper_bound()
 	DBUG_RETURN((ha_rows) estimate);
 }
 
+/*********************************************************************//**
+Counts the rows visible to the current statement. This is called by the
+optimizer for COUNT(*) without a WHERE clause when HA_HAS_RECORDS is set,
+that is, when max_parallel_degree allows a parallel scan. The clustered
+index is scanned in key ranges by up to max_parallel_degree threads.
+@return	number of rows, or HA_POS_ERROR if the rows must be counted by
+a regular scan */
+UNIV_INTERN
+ha_rows
+ha_innobase::records()
+/*==================*/
+{
+	dict_index_t*	index;
+	ulint		n_rows;
+	dberr_t		err;
+
+	DBUG_ENTER("ha_innobase::records");
+
+	update_thd(ha_thd());
+
+	index = dict_table_get_first_index(prebuilt->table);
+
+	/* Locking reads and READ UNCOMMITTED do not use a read view. */
+	if (prebuilt->select_lock_type != LOCK_NONE
+	    || prebuilt->trx->isolation_level == TRX_ISO_READ_UNCOMMITTED
+	    || dict_table_is_discarded(prebuilt->table)
+	    || prebuilt->table->ibd_file_missing
+	    || dict_index_is_corrupted(index)) {
+		DBUG_RETURN(HA_POS_ERROR);
+	}
+
+	prebuilt->trx->op_info = "counting rows";
+
+	/* In case MySQL calls this in the middle of a SELECT query, release
+	possible adaptive hash latch to avoid deadlocks of threads */
+
+	trx_search_latch_release_if_reserved(prebuilt->trx);
+
+	innobase_srv_conc_enter_innodb(prebuilt->trx);
+
+	trx_start_if_not_started_xa(prebuilt->trx);
+	trx_assign_read_view(prebuilt->trx);
+
+	err = row_pread_count_rows(prebuilt->trx, index,
+				   thd_parallel_degree(user_thd), &n_rows);
+
+	innobase_srv_conc_exit_innodb(prebuilt->trx);
+
+	prebuilt->trx->op_info = "";
+
+	if (err != DB_SUCCESS) {
+		/* The statement was killed. Let the regular scan report
+		it. */
+		DBUG_RETURN(HA_POS_ERROR);
+	}
+
+	DBUG_RETURN((ha_rows) n_rows);
+}
+
 /*********************************************************************//**
 How many seeks it will take to read through the table. This is to be
 comparable to the number returned by records_in_range so that we can
@@ -17270,6 +17340,12 @@ static MYSQL_SYSVAR_BOOL(buffer_pool_populate, srv_buf_pool_populate,
   "established by the buffer pool memory region. Disabled by default.",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_BOOL(buffer_pool_numa, srv_buf_pool_numa,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Place the memory of each buffer pool instance on one NUMA node, "
+  "spreading the instances over the nodes round robin. Disabled by default.",
+  NULL, NULL, FALSE);
+
 static MYSQL_SYSVAR_ENUM(foreground_preflush, srv_foreground_preflush,
   PLUGIN_VAR_OPCMDARG,
   "The algorithm InnoDB uses for the query threads at sync preflush.  "
@@ -17753,6 +17829,15 @@ static MYSQL_SYSVAR_UINT(change_buffer_max_size,
   NULL, innodb_change_buffer_max_size_update,
   CHANGE_BUFFER_DEFAULT_SIZE, 0, 50, 0);
 
+static MYSQL_SYSVAR_ULONG(change_buffer_merge_threads, srv_ibuf_merge_threads,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of dedicated background threads merging the change buffer. "
+  "0 (the default) means the master thread does the merge.",
+  NULL, NULL,
+  0,			/* Default setting */
+  0,			/* Minimum value */
+  32, 0);		/* Maximum value */
+
 static MYSQL_SYSVAR_ENUM(stats_method, srv_innodb_stats_method,
    PLUGIN_VAR_RQCMDARG,
   "Specifies how InnoDB index statistics collection code should "
@@ -17933,6 +18018,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(autoextend_increment),
   MYSQL_SYSVAR(buffer_pool_size),
   MYSQL_SYSVAR(buffer_pool_populate),
+  MYSQL_SYSVAR(buffer_pool_numa),
   MYSQL_SYSVAR(buffer_pool_instances),
   MYSQL_SYSVAR(buffer_pool_filename),
   MYSQL_SYSVAR(buffer_pool_dump_now),
@@ -18047,6 +18133,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(use_native_aio),
   MYSQL_SYSVAR(change_buffering),
   MYSQL_SYSVAR(change_buffer_max_size),
+  MYSQL_SYSVAR(change_buffer_merge_threads),
   MYSQL_SYSVAR(track_changed_pages),
   MYSQL_SYSVAR(max_bitmap_file_size),
   MYSQL_SYSVAR(max_changed_pages),
@@ -18140,6 +18227,7 @@ mysql_declare_plugin(innobase)
 i_s_xtradb_read_view,
 i_s_xtradb_internal_hash_tables,
 i_s_xtradb_rseg,
+i_s_xtradb_change_buffer_pending,
 i_s_innodb_trx,
 i_s_innodb_locks,
 i_s_innodb_lock_waits,
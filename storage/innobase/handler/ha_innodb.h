@@ -168,6 +168,7 @@ class ha_innobase: public handler
 	ha_rows records_in_range(uint inx, key_range *min_key, key_range
 								*max_key);
 	ha_rows estimate_rows_upper_bound();
+	ha_rows records();
 
 	void update_create_info(HA_CREATE_INFO* create_info);
 	int parse_table_name(const char*name,
@@ -210,6 +210,14 @@ UNIV_INTERN mysql_pfs_key_t	ibuf_mutex_key;
 UNIV_INTERN mysql_pfs_key_t	ibuf_bitmap_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
+#ifdef UNIV_PFS_THREAD
+UNIV_INTERN mysql_pfs_key_t	ibuf_merge_thread_key;
+#endif /* UNIV_PFS_THREAD */
+
+/** Number of running ibuf_merge_thread instances, protected by
+ibuf_mutex */
+static ulint	ibuf_n_merge_threads_active	= 0;
+
 #ifdef UNIV_IBUF_COUNT_DEBUG
 /** Number of tablespaces in the ibuf_counts array */
 #define IBUF_COUNT_N_SPACES	4
@@ -2898,6 +2906,109 @@ ibuf_contract_in_background(
 	return(sum_bytes);
 }
 
+/*********************************************************************//**
+Returns the number of running dedicated change buffer merge threads.
+@return number of active ibuf_merge_thread instances */
+UNIV_INTERN
+ulint
+ibuf_merge_threads_active(void)
+/*===========================*/
+{
+	/* A dirty read is enough: the value only changes when a merge
+	thread starts or exits. */
+	return(ibuf_n_merge_threads_active);
+}
+
+/*********************************************************************//**
+Signals the dedicated change buffer merge threads, if any are running,
+that the insert buffer should be contracted.
+@return true if a merge thread was signalled, false if there are no
+merge threads and the caller must do the contraction itself */
+UNIV_INTERN
+bool
+ibuf_merge_threads_wakeup(void)
+/*===========================*/
+{
+	if (ibuf_merge_threads_active() == 0) {
+		return(false);
+	}
+
+	os_event_set(srv_ibuf_merge_event);
+
+	return(true);
+}
+
+/*********************************************************************//**
+A thread which contracts the insert buffer in the background, so that
+neither the master thread nor user threads have to do it. There are
+srv_ibuf_merge_threads instances of this thread. Each of them wakes up
+once per second or when signalled by ibuf_merge_threads_wakeup(), and
+issues a batch of asynchronous reads of the pages which have the most
+buffered changes around a random position of the ibuf tree. The merge
+itself happens in the i/o completion of those reads.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(ibuf_merge_thread)(
+/*==============================*/
+	void*	arg __attribute__((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	ulint	old_activity_count = srv_get_activity_count();
+
+	ut_ad(!srv_read_only_mode);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(ibuf_merge_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "InnoDB: ibuf merge thread running, id %lu\n",
+		os_thread_pf(os_thread_get_curr_id()));
+#endif /* UNIV_DEBUG_THREAD_CREATION */
+
+	mutex_enter(&ibuf_mutex);
+	++ibuf_n_merge_threads_active;
+	mutex_exit(&ibuf_mutex);
+
+	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+		ib_int64_t	sig_count;
+		ibool		full;
+
+		sig_count = os_event_reset(srv_ibuf_merge_event);
+
+		os_event_wait_time_low(srv_ibuf_merge_event, 1000000,
+				       sig_count);
+
+		if (srv_shutdown_state != SRV_SHUTDOWN_NONE) {
+			break;
+		}
+
+		/* Like the master thread, do a full batch when the
+		server is idle, and also when the insert buffer has
+		outgrown its maximum size. Dirty reads of ibuf->size
+		are fine here, see ibuf_contract_after_insert(). */
+		full = !srv_check_activity(old_activity_count)
+			|| ibuf->size >= ibuf->max_size;
+
+		ibuf_contract_in_background(0, full);
+
+		old_activity_count = srv_get_activity_count();
+	}
+
+	mutex_enter(&ibuf_mutex);
+	ut_ad(ibuf_n_merge_threads_active > 0);
+	--ibuf_n_merge_threads_active;
+	mutex_exit(&ibuf_mutex);
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /*********************************************************************//**
 Contract insert buffer trees after insert if they are too big. */
 UNIV_INLINE
@@ -2928,6 +3039,12 @@ ibuf_contract_after_insert(
 
 	sync = (size >= max_size + IBUF_CONTRACT_ON_INSERT_SYNC);
 
+	/* Unless the insert buffer has grown so big that we must wait
+	for the merge, leave the contraction to the merge threads. */
+	if (!sync && ibuf_merge_threads_wakeup()) {
+		return;
+	}
+
 	/* Contract at least entry_size many bytes */
 	sum_sizes = 0;
 	size = 1;
@@ -5091,6 +5208,71 @@ leave_loop:
 	mem_heap_free(heap);
 }
 
+/*********************************************************************//**
+Scans the insert buffer tree and counts the buffered changes for each
+tablespace. Only one leaf page of the tree is latched at a time, so the
+result is not a consistent snapshot when the tree is being modified. */
+UNIV_INTERN
+void
+ibuf_get_pending_per_space(
+/*=======================*/
+	ibuf_pending_t*	pending)	/*!< out: buffered changes,
+					one element per tablespace */
+{
+	btr_pcur_t		pcur;
+	mtr_t			mtr;
+	ibuf_space_pending_t*	cur = NULL;
+	ulint			prev_page_no = ULINT_UNDEFINED;
+
+	pending->clear();
+
+	ibuf_mtr_start(&mtr);
+
+	btr_pcur_open_at_index_side(
+		true, ibuf->index, BTR_SEARCH_LEAF, &pcur, true, 0, &mtr);
+
+	while (btr_pcur_move_to_next_user_rec(&pcur, &mtr)) {
+		const rec_t*	rec = btr_pcur_get_rec(&pcur);
+		ulint		space = ibuf_rec_get_space(&mtr, rec);
+		ulint		page_no = ibuf_rec_get_page_no(&mtr, rec);
+
+		/* The tree is ordered by (space, page_no, counter), so
+		all records of a tablespace are adjacent. */
+		if (cur == NULL || cur->space != space) {
+			ibuf_space_pending_t	elem;
+
+			memset(&elem, 0, sizeof elem);
+			elem.space = space;
+
+			pending->push_back(elem);
+			cur = &pending->back();
+			prev_page_no = ULINT_UNDEFINED;
+		}
+
+		if (page_no != prev_page_no) {
+			++cur->n_pages;
+			prev_page_no = page_no;
+		}
+
+		++cur->n_ops[ibuf_rec_get_op_type(&mtr, rec)];
+
+		if (page_rec_is_supremum(page_rec_get_next_const(rec))) {
+			/* Do not keep the ibuf tree latched while
+			the caller is waiting: release the leaf page
+			before moving to the next one. */
+			btr_pcur_store_position(&pcur, &mtr);
+			ibuf_mtr_commit(&mtr);
+
+			ibuf_mtr_start(&mtr);
+			btr_pcur_restore_position(
+				BTR_SEARCH_LEAF, &pcur, &mtr);
+		}
+	}
+
+	ibuf_mtr_commit(&mtr);
+	btr_pcur_close(&pcur);
+}
+
 /******************************************************************//**
 Looks if the insert buffer is empty.
 @return	true if empty */
@@ -1201,7 +1201,10 @@ struct dict_table_t{
 				to this table; dropping of the table is
 				NOT allowed until this count gets to zero;
 				MySQL does NOT itself check the number of
-				open handles at drop */
+				open handles at drop. Updated atomically; it
+				may only be incremented from 0 while holding
+				dict_sys->mutex, see dict_table_open_on_name()
+				and dict_table_close() */
 	UT_LIST_BASE_NODE_T(lock_t)
 			locks;	/*!< list of locks on the table; protected
 				by lock_sys->mutex */
@@ -37,6 +37,7 @@ Created 10/25/1995 Heikki Tuuri
 #include "sync0rw.h"
 #include "ibuf0types.h"
 #include "log0log.h"
+#include "os0thread.h"
 #endif /* !UNIV_HOTBACKUP */
 #include "trx0types.h"
 
@@ -618,6 +619,31 @@ fil_open_single_table_tablespace(
 	const char*	filepath)	/*!< in: tablespace filepath */
 	__attribute__((nonnull(5), warn_unused_result));
 
+/** A tablespace to be opened by fil_open_single_table_tablespaces() */
+struct fil_open_item_t {
+	ulint		id;		/*!< in: space id */
+	ulint		flags;		/*!< in: tablespace flags */
+	const char*	tablename;	/*!< in: table name in the
+					databasename/tablename format */
+	bool		has_link;	/*!< out: true if the tablespace
+					has an .isl file and was not
+					opened */
+	dberr_t		err;		/*!< out: DB_SUCCESS or error code
+					of fil_open_single_table_tablespace() */
+};
+
+/********************************************************************//**
+Opens the single-table tablespaces of tables found in the data dictionary
+at a normal startup. The existence checks done by
+fil_open_single_table_tablespace() are spread over several threads. The
+dictionary is not updated: item->has_link is set instead for tablespaces
+with an .isl file, and the caller must open those itself. */
+UNIV_INTERN
+void
+fil_open_single_table_tablespaces(
+/*==============================*/
+	fil_open_item_t**	items,	/*!< in/out: tablespaces to open */
+	ulint			n_items);/*!< in: number of items */
 #endif /* !UNIV_HOTBACKUP */
 /********************************************************************//**
 At the server startup, if we need crash recovery, scans the database
@@ -798,6 +824,25 @@ void
 fil_flush_file_spaces(
 /*==================*/
 	ulint	purpose);	/*!< in: FIL_TABLESPACE, FIL_LOG */
+#ifndef UNIV_HOTBACKUP
+/*********************************************************************//**
+Checks if the file flush thread is running.
+@return true if fil_flush_thread is active */
+UNIV_INTERN
+bool
+fil_flush_thread_is_active(void);
+/*============================*/
+/*********************************************************************//**
+This thread flushes the tablespace files with unflushed writes in a batch
+when few of the open files could be closed without an fsync.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(fil_flush_thread)(
+/*=============================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+#endif /* !UNIV_HOTBACKUP */
 /******************************************************************//**
 Checks the consistency of the tablespace cache.
 @return	TRUE if ok */
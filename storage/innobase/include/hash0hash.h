@@ -88,6 +88,13 @@ hash_create_sync_obj_func(
 # define hash_create_sync_obj(t, s, n, level)			\
 			hash_create_sync_obj_func(t, s, n)
 #endif /* UNIV_SYNC_DEBUG */
+/*************************************************************//**
+Frees the sync objects created by hash_create_sync_obj(). */
+UNIV_INTERN
+void
+hash_free_sync_obj(
+/*===============*/
+	hash_table_t*	table);	/*!< in/out: hash table */
 #endif /* !UNIV_HOTBACKUP */
 
 /*************************************************************//**
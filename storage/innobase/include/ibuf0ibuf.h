@@ -34,6 +34,9 @@ Created 7/19/1997 Heikki Tuuri
 
 #ifndef UNIV_HOTBACKUP
 # include "ibuf0types.h"
+# include "os0thread.h"
+
+# include <vector>
 
 /** Default value for maximum on-disk size of change buffer in terms
 of percentage of the buffer pool. */
@@ -381,6 +384,57 @@ ibuf_contract_in_background(
 					If FALSE then the size of contract
 					batch is determined based on the
 					current size of the ibuf tree. */
+/*********************************************************************//**
+Signals the dedicated change buffer merge threads, if any are running,
+that the insert buffer should be contracted.
+@return true if a merge thread was signalled, false if there are no
+merge threads and the caller must do the contraction itself */
+UNIV_INTERN
+bool
+ibuf_merge_threads_wakeup(void);
+/*===========================*/
+/*********************************************************************//**
+Returns the number of running dedicated change buffer merge threads.
+@return number of active ibuf_merge_thread instances */
+UNIV_INTERN
+ulint
+ibuf_merge_threads_active(void);
+/*===========================*/
+/*********************************************************************//**
+A thread which contracts the insert buffer in the background, so that
+neither the master thread nor user threads have to do it. There are
+srv_ibuf_merge_threads instances of this thread.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(ibuf_merge_thread)(
+/*==============================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+
+/** Number of buffered changes for one tablespace, as reported by
+ibuf_get_pending_per_space() */
+struct ibuf_space_pending_t {
+	ulint	space;			/*!< tablespace id */
+	ulint	n_pages;		/*!< number of distinct pages
+					with buffered changes */
+	ulint	n_ops[IBUF_OP_COUNT];	/*!< number of buffered
+					operations of each type */
+};
+
+/** Buffered changes of all tablespaces, ordered by space id */
+typedef std::vector<ibuf_space_pending_t> ibuf_pending_t;
+
+/*********************************************************************//**
+Scans the insert buffer tree and counts the buffered changes for each
+tablespace. Only one leaf page of the tree is latched at a time, so the
+result is not a consistent snapshot when the tree is being modified. */
+UNIV_INTERN
+void
+ibuf_get_pending_per_space(
+/*=======================*/
+	ibuf_pending_t*	pending);	/*!< out: buffered changes,
+					one element per tablespace */
 #endif /* !UNIV_HOTBACKUP */
 /*********************************************************************//**
 Parses a redo log record of an ibuf bitmap page init.
@@ -192,6 +192,20 @@ row_search_max_autoinc(
 	ib_uint64_t*	value)		/*!< out: AUTOINC value read */
 	__attribute__((nonnull, warn_unused_result));
 
+/********************************************************************//**
+Counts the records of a clustered index that are visible in the read view
+of a transaction, scanning key ranges of the index in parallel.
+@return DB_SUCCESS or DB_INTERRUPTED */
+UNIV_INTERN
+dberr_t
+row_pread_count_rows(
+/*=================*/
+	trx_t*		trx,		/*!< in: transaction with a read view */
+	dict_index_t*	index,		/*!< in: clustered index */
+	ulint		n_threads,	/*!< in: maximum number of threads */
+	ulint*		n_rows)		/*!< out: number of records */
+	__attribute__((nonnull, warn_unused_result));
+
 /** A structure for caching column values for prefetched rows */
 struct sel_buf_t{
 	byte*		data;	/*!< data, or NULL; if not NULL, this field
@@ -328,6 +328,10 @@ enum monitor_id_t {
 	/* Tablespace related counters */
 	MONITOR_MODULE_FIL_SYSTEM,
 	MONITOR_OVLD_N_FILE_OPENED,
+	MONITOR_FIL_IO_SHARED,
+	MONITOR_FIL_SYSTEM_MUTEX_WAIT,
+	MONITOR_FIL_FLUSH_BATCH,
+	MONITOR_FIL_REOPEN_WITHOUT_MUTEX,
 
 	/* InnoDB Change Buffer related counters */
 	MONITOR_MODULE_IBUF_SYSTEM,
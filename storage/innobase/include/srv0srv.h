@@ -145,6 +145,12 @@ extern os_event_t	srv_error_event;
 /** The buffer pool dump/load thread waits on this event. */
 extern os_event_t	srv_buf_dump_event;
 
+/** The change buffer merge threads wait on this event. */
+extern os_event_t	srv_ibuf_merge_event;
+
+/** The file flush thread waits on this event. */
+extern os_event_t	srv_fil_flush_event;
+
 /** The buffer pool dump/load file name */
 #define SRV_BUF_DUMP_FILENAME_DEFAULT	"ib_buffer_pool"
 extern char*		srv_buf_dump_filename;
@@ -300,6 +306,8 @@ extern ibool	srv_use_sys_malloc;
 #endif /* UNIV_HOTBACKUP */
 extern ulint	srv_buf_pool_size;	/*!< requested size in bytes */
 extern my_bool	srv_buf_pool_populate;	/*!< virtual page preallocation */
+extern my_bool	srv_buf_pool_numa;	/*!< place the buffer pool instances
+					on the NUMA nodes */
 extern ulint    srv_buf_pool_instances; /*!< requested number of buffer pool instances */
 extern ulong	srv_n_page_hash_locks;	/*!< number of locks to
 					protect buf_pool->page_hash */
@@ -569,6 +577,10 @@ extern ulong srv_n_purge_threads;
 /* the number of pages to purge in one batch */
 extern ulong srv_purge_batch_size;
 
+/* the number of dedicated change buffer merge threads, 0 if the master
+thread merges the change buffer */
+extern ulong srv_ibuf_merge_threads;
+
 /* the number of sync wait arrays */
 extern ulong srv_sync_array_size;
 
@@ -592,6 +604,10 @@ extern my_bool srv_fake_changes_locks;
 /* Keys to register InnoDB threads with performance schema */
 extern mysql_pfs_key_t	buf_page_cleaner_thread_key;
 extern mysql_pfs_key_t	buf_lru_manager_thread_key;
+extern mysql_pfs_key_t	ibuf_merge_thread_key;
+extern mysql_pfs_key_t	fil_flush_thread_key;
+extern mysql_pfs_key_t	fil_load_thread_key;
+extern mysql_pfs_key_t	row_pread_thread_key;
 extern mysql_pfs_key_t	trx_rollback_clean_thread_key;
 extern mysql_pfs_key_t	io_handler_thread_key;
 extern mysql_pfs_key_t	srv_lock_timeout_thread_key;
@@ -910,7 +910,10 @@ or row lock! */
 #define	SYNC_BUF_FLUSH_STATE	142
 #define	SYNC_BUF_FLUSH_LIST	141	/* Buffer flush list mutex */
 #define	SYNC_DOUBLEWRITE	139
+#define	SYNC_DICT_TABLE_HASH	138	/* dict_sys->table_hash and
+					dict_sys->table_id_hash rw_locks */
 #define	SYNC_ANY_LATCH		135
+#define	SYNC_FIL_SPACE_HASH	134	/* fil_system->spaces rw_locks */
 #define	SYNC_MEM_HASH		131
 #define	SYNC_MEM_POOL		130
 
@@ -5388,3 +5388,419 @@ row_search_max_autoinc(
 
 	return(error);
 }
+
+#ifdef UNIV_PFS_THREAD
+UNIV_INTERN mysql_pfs_key_t	row_pread_thread_key;
+#endif /* UNIV_PFS_THREAD */
+
+/** Number of key ranges per thread that a parallel scan of an index is
+split into. Having more ranges than threads lets the threads that finish
+early take over the work of the others. */
+#define ROW_PREAD_RANGES_PER_THREAD	8
+
+/** A parallel count of the records of a clustered index */
+struct row_pread_t {
+	os_fast_mutex_t	mutex;		/*!< protects next, n_rows, err
+					and n_running */
+	trx_t*		trx;		/*!< transaction of the statement */
+	dict_index_t*	index;		/*!< clustered index */
+	dtuple_t**	keys;		/*!< range boundaries in ascending
+					order: range i covers the keys in
+					[keys[i - 1], keys[i]) */
+	ulint		n_keys;		/*!< number of boundaries; there
+					are n_keys + 1 ranges */
+	ulint		next;		/*!< next range to be scanned */
+	ulint		n_rows;		/*!< records counted so far */
+	dberr_t		err;		/*!< first error, or DB_SUCCESS */
+	ulint		n_running;	/*!< number of helper threads that
+					have not finished yet */
+	os_event_t	done;		/*!< set when n_running drops to 0 */
+};
+
+/********************************************************************//**
+Splits a clustered index into key ranges for a parallel scan. The range
+boundaries are sampled from the node pointers of the root page, or of the
+level below the root when the root has too few of them.
+@return number of boundaries stored in keys */
+static
+ulint
+row_pread_split(
+/*============*/
+	dict_index_t*	index,	/*!< in: clustered index */
+	ulint		n_max,	/*!< in: maximum number of boundaries */
+	dtuple_t**	keys,	/*!< out: boundaries, in ascending order */
+	mem_heap_t*	heap)	/*!< in/out: memory heap for keys */
+{
+	mtr_t		mtr;
+	const ulint	space = dict_index_get_space(index);
+	const ulint	zip_size = dict_table_zip_size(index->table);
+	const ulint	comp = dict_table_is_comp(index->table);
+	const ulint	n_uniq = dict_index_get_n_unique_in_tree(index);
+	buf_block_t**	blocks;
+	ulint		n_blocks;
+	const rec_t**	recs;
+	ulint		n_recs;
+	ulint		n_keys = 0;
+	const page_t*	root;
+	ulint		level;
+
+	mtr_start(&mtr);
+
+	/* Prevent changes of the tree structure while the node
+	pointers are being sampled. */
+	mtr_s_lock(dict_index_get_lock(index), &mtr);
+
+	blocks = static_cast<buf_block_t**>(
+		mem_heap_alloc(heap, sizeof *blocks));
+	blocks[0] = btr_block_get(space, zip_size, dict_index_get_page(index),
+				  RW_S_LATCH, index, &mtr);
+	n_blocks = 1;
+
+	root = buf_block_get_frame(blocks[0]);
+	level = btr_page_get_level(root, &mtr);
+
+	if (level == 0) {
+		/* The whole index fits in one page. */
+		mtr_commit(&mtr);
+		return(0);
+	}
+
+	if (page_get_n_recs(root) <= n_max && level > 1) {
+		/* Sample the level below the root. */
+		ulint		offsets_[REC_OFFS_NORMAL_SIZE];
+		ulint*		offsets = offsets_;
+		mem_heap_t*	offsets_heap = NULL;
+		const rec_t*	rec;
+
+		rec_offs_init(offsets_);
+
+		blocks = static_cast<buf_block_t**>(
+			mem_heap_alloc(heap,
+				       page_get_n_recs(root) * sizeof *blocks));
+		n_blocks = 0;
+
+		for (rec = page_rec_get_next_const(page_get_infimum_rec(root));
+		     !page_rec_is_supremum(rec);
+		     rec = page_rec_get_next_const(rec)) {
+
+			offsets = rec_get_offsets(rec, index, offsets,
+						  ULINT_UNDEFINED,
+						  &offsets_heap);
+
+			blocks[n_blocks++] = btr_block_get(
+				space, zip_size,
+				btr_node_ptr_get_child_page_no(rec, offsets),
+				RW_S_LATCH, index, &mtr);
+		}
+
+		if (offsets_heap != NULL) {
+			mem_heap_free(offsets_heap);
+		}
+	}
+
+	n_recs = 0;
+
+	for (ulint i = 0; i < n_blocks; i++) {
+		n_recs += page_get_n_recs(buf_block_get_frame(blocks[i]));
+	}
+
+	recs = static_cast<const rec_t**>(
+		mem_heap_alloc(heap, (n_recs + 1) * sizeof *recs));
+	n_recs = 0;
+
+	for (ulint i = 0; i < n_blocks; i++) {
+		const page_t*	page = buf_block_get_frame(blocks[i]);
+		const rec_t*	rec;
+
+		for (rec = page_rec_get_next_const(page_get_infimum_rec(page));
+		     !page_rec_is_supremum(rec);
+		     rec = page_rec_get_next_const(rec)) {
+
+			/* The leftmost node pointer of a level carries
+			no key. */
+			if (!(rec_get_info_bits(rec, comp)
+			      & REC_INFO_MIN_REC_FLAG)) {
+				recs[n_recs++] = rec;
+			}
+		}
+	}
+
+	/* Pick at most n_max boundaries spread evenly over the sample. */
+	for (ulint i = 0; i < n_max && i < n_recs; i++) {
+		const rec_t*	rec = n_recs <= n_max
+			? recs[i]
+			: recs[(i + 1) * n_recs / (n_max + 1)];
+
+		keys[n_keys] = dict_index_build_data_tuple(
+			index, const_cast<rec_t*>(rec), n_uniq, heap);
+		dtuple_set_info_bits(keys[n_keys], 0);
+		n_keys++;
+	}
+
+	mtr_commit(&mtr);
+
+	return(n_keys);
+}
+
+/********************************************************************//**
+Counts the records of one key range of a clustered index that are visible
+in the read view of the transaction.
+@return DB_SUCCESS or DB_INTERRUPTED */
+static
+dberr_t
+row_pread_count_range(
+/*==================*/
+	trx_t*		trx,	/*!< in: transaction with a read view */
+	dict_index_t*	index,	/*!< in: clustered index */
+	const dtuple_t*	low,	/*!< in: first key of the range, or NULL */
+	const dtuple_t*	high,	/*!< in: first key after the range,
+				or NULL */
+	ulint*		n_rows)	/*!< in/out: number of records */
+{
+	mtr_t		mtr;
+	btr_pcur_t	pcur;
+	dberr_t		err = DB_SUCCESS;
+	mem_heap_t*	heap = mem_heap_create(UNIV_PAGE_SIZE / 4);
+	const ulint	comp = dict_table_is_comp(index->table);
+	read_view_t*	view = trx->read_view;
+	ulint		n = 0;
+
+	mtr_start(&mtr);
+
+	if (low != NULL) {
+		btr_pcur_open(index, low, PAGE_CUR_GE, BTR_SEARCH_LEAF,
+			      &pcur, &mtr);
+	} else {
+		btr_pcur_open_at_index_side(
+			true, index, BTR_SEARCH_LEAF, &pcur, true, 0, &mtr);
+	}
+
+	for (;;) {
+		const rec_t*	rec;
+		ulint*		offsets;
+
+		if (btr_pcur_is_before_first_on_page(&pcur)) {
+			btr_pcur_move_to_next_on_page(&pcur);
+		}
+
+		if (btr_pcur_is_after_last_on_page(&pcur)) {
+			if (trx_is_interrupted(trx)) {
+				err = DB_INTERRUPTED;
+				break;
+			}
+
+			if (btr_page_get_next(btr_pcur_get_page(&pcur), &mtr)
+			    == FIL_NULL) {
+				break;
+			}
+
+			/* Release the latches between the pages so that
+			a long scan does not block the other threads.
+			Store the cursor position on the last user record
+			of the page and continue from its successor. */
+			btr_pcur_move_to_prev_on_page(&pcur);
+			btr_pcur_store_position(&pcur, &mtr);
+			mtr_commit(&mtr);
+
+			mtr_start(&mtr);
+			btr_pcur_restore_position(BTR_SEARCH_LEAF, &pcur, &mtr);
+
+			if (!btr_pcur_move_to_next_user_rec(&pcur, &mtr)) {
+				break;
+			}
+		}
+
+		rec = btr_pcur_get_rec(&pcur);
+
+		mem_heap_empty(heap);
+		offsets = rec_get_offsets(rec, index, NULL, ULINT_UNDEFINED,
+					  &heap);
+
+		if (high != NULL && cmp_dtuple_rec(high, rec, offsets) <= 0) {
+			break;
+		}
+
+		if (!lock_clust_rec_cons_read_sees(rec, index, offsets,
+						   view)) {
+			rec_t*	old_vers;
+
+			row_vers_build_for_consistent_read(
+				rec, &mtr, index, &offsets, view, &heap,
+				heap, &old_vers);
+
+			rec = old_vers;
+		}
+
+		if (rec != NULL && !rec_get_deleted_flag(rec, comp)) {
+			n++;
+		}
+
+		btr_pcur_move_to_next_on_page(&pcur);
+	}
+
+	btr_pcur_close(&pcur);
+	mtr_commit(&mtr);
+	mem_heap_free(heap);
+
+	*n_rows += n;
+
+	return(err);
+}
+
+/********************************************************************//**
+Scans the ranges of a parallel count until all of them have been taken
+or an error has occurred. */
+static
+void
+row_pread_process(
+/*==============*/
+	row_pread_t*	pread)	/*!< in/out: parallel count */
+{
+	ulint	n_rows = 0;
+	dberr_t	err = DB_SUCCESS;
+
+	for (;;) {
+		ulint	i;
+
+		os_fast_mutex_lock(&pread->mutex);
+
+		if (pread->next > pread->n_keys
+		    || pread->err != DB_SUCCESS) {
+			os_fast_mutex_unlock(&pread->mutex);
+			break;
+		}
+
+		i = pread->next++;
+
+		os_fast_mutex_unlock(&pread->mutex);
+
+		err = row_pread_count_range(
+			pread->trx, pread->index,
+			i > 0 ? pread->keys[i - 1] : NULL,
+			i < pread->n_keys ? pread->keys[i] : NULL,
+			&n_rows);
+
+		if (err != DB_SUCCESS) {
+			break;
+		}
+	}
+
+	os_fast_mutex_lock(&pread->mutex);
+
+	pread->n_rows += n_rows;
+
+	if (err != DB_SUCCESS && pread->err == DB_SUCCESS) {
+		pread->err = err;
+	}
+
+	os_fast_mutex_unlock(&pread->mutex);
+}
+
+/********************************************************************//**
+Helper thread that scans ranges of a clustered index in parallel with the
+thread that started it.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(row_pread_thread)(
+/*=============================*/
+	void*	arg)	/*!< in: row_pread_t* */
+{
+	row_pread_t*	pread = static_cast<row_pread_t*>(arg);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(row_pread_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	row_pread_process(pread);
+
+	os_fast_mutex_lock(&pread->mutex);
+
+	ut_ad(pread->n_running > 0);
+
+	if (--pread->n_running == 0) {
+		os_event_set(pread->done);
+	}
+
+	os_fast_mutex_unlock(&pread->mutex);
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/********************************************************************//**
+Counts the records of a clustered index that are visible in the read view
+of a transaction. The index is split into key ranges that are scanned by
+the calling thread and up to n_threads - 1 helper threads. The helper
+threads share the read view of the transaction, which cannot change while
+the calling thread waits for them.
+@return DB_SUCCESS or DB_INTERRUPTED */
+UNIV_INTERN
+dberr_t
+row_pread_count_rows(
+/*=================*/
+	trx_t*		trx,		/*!< in: transaction with a read view */
+	dict_index_t*	index,		/*!< in: clustered index */
+	ulint		n_threads,	/*!< in: maximum number of threads */
+	ulint*		n_rows)		/*!< out: number of records */
+{
+	row_pread_t	pread;
+	mem_heap_t*	heap;
+	ulint		n_max;
+
+	ut_ad(dict_index_is_clust(index));
+	ut_ad(trx->read_view != NULL);
+
+	n_max = n_threads * ROW_PREAD_RANGES_PER_THREAD - 1;
+
+	heap = mem_heap_create(1024);
+
+	pread.trx = trx;
+	pread.index = index;
+	pread.keys = static_cast<dtuple_t**>(
+		mem_heap_alloc(heap, n_max * sizeof *pread.keys));
+	pread.n_keys = n_threads > 1
+		? row_pread_split(index, n_max, pread.keys, heap)
+		: 0;
+	pread.next = 0;
+	pread.n_rows = 0;
+	pread.err = DB_SUCCESS;
+
+	n_threads = ut_min(n_threads, pread.n_keys + 1);
+
+	os_fast_mutex_init(PFS_NOT_INSTRUMENTED, &pread.mutex);
+
+	if (n_threads > 1) {
+		pread.done = os_event_create();
+		pread.n_running = n_threads - 1;
+
+		for (ulint i = 1; i < n_threads; i++) {
+			os_thread_create(row_pread_thread, &pread, NULL);
+		}
+	}
+
+	row_pread_process(&pread);
+
+	if (n_threads > 1) {
+		os_event_wait(pread.done);
+
+		/* The last helper thread sets the event while holding
+		the mutex. Wait for it to release the mutex before
+		pread goes out of scope. */
+		os_fast_mutex_lock(&pread.mutex);
+		ut_ad(pread.n_running == 0);
+		os_fast_mutex_unlock(&pread.mutex);
+
+		os_event_free(pread.done);
+	}
+
+	os_fast_mutex_free(&pread.mutex);
+	mem_heap_free(heap);
+
+	*n_rows = pread.n_rows;
+
+	return(pread.err);
+}
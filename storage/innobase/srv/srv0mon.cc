@@ -972,6 +972,29 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_EXISTING | MONITOR_DISPLAY_CURRENT | MONITOR_DEFAULT_ON),
 	 MONITOR_DEFAULT_START, MONITOR_OVLD_N_FILE_OPENED},
 
+	{"file_io_without_mutex", "file_system",
+	 "Number of i/o requests started or completed without"
+	 " fil_system->mutex",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FIL_IO_SHARED},
+
+	{"file_system_mutex_waits", "file_system",
+	 "Number of times the i/o path found fil_system->mutex locked",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FIL_SYSTEM_MUTEX_WAIT},
+
+	{"file_flush_batches", "file_system",
+	 "Number of batches of tablespace flushes done by the file flush"
+	 " thread to keep open files closable",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FIL_FLUSH_BATCH},
+
+	{"file_reopens_without_mutex", "file_system",
+	 "Number of closed tablespace files opened again without holding"
+	 " fil_system->mutex",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FIL_REOPEN_WITHOUT_MUTEX},
+
 	/* ========== Counters for Change Buffer ========== */
 	{"module_ibuf_system", "change_buffer", "InnoDB Change Buffer",
 	 MONITOR_MODULE,
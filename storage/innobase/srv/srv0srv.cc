@@ -245,6 +245,8 @@ UNIV_INTERN my_bool	srv_use_sys_malloc	= TRUE;
 UNIV_INTERN ulint	srv_buf_pool_size	= ULINT_MAX;
 /* force virtual page preallocation (prefault) */
 UNIV_INTERN my_bool	srv_buf_pool_populate	= FALSE;
+/* place the buffer pool instances on the NUMA nodes */
+UNIV_INTERN my_bool	srv_buf_pool_numa	= FALSE;
 /* requested number of buffer pool instances */
 UNIV_INTERN ulint       srv_buf_pool_instances  = 1;
 /* number of locks to protect buf_pool->page_hash */
@@ -405,6 +407,9 @@ UNIV_INTERN ulong	srv_n_purge_threads = 1;
 /* the number of pages to purge in one batch */
 UNIV_INTERN ulong	srv_purge_batch_size = 20;
 
+/* The number of dedicated change buffer merge threads.*/
+UNIV_INTERN ulong	srv_ibuf_merge_threads = 0;
+
 /* Internal setting for "innodb_stats_method". Decides how InnoDB treats
 NULL value when collecting statistics. By default, it is set to
 SRV_STATS_NULLS_EQUAL(0), ie. all NULL value are treated equal */
@@ -727,6 +732,12 @@ UNIV_INTERN os_event_t	srv_error_event;
 /** Event to signal the buffer pool dump/load thread */
 UNIV_INTERN os_event_t	srv_buf_dump_event;
 
+/** Event to signal the change buffer merge threads */
+UNIV_INTERN os_event_t	srv_ibuf_merge_event;
+
+/** Event to signal the file flush thread */
+UNIV_INTERN os_event_t	srv_fil_flush_event;
+
 /** The buffer pool dump/load file name */
 UNIV_INTERN char*	srv_buf_dump_filename;
 
@@ -1097,6 +1108,10 @@ srv_init(void)
 
 		srv_buf_dump_event = os_event_create();
 
+		srv_ibuf_merge_event = os_event_create();
+
+		srv_fil_flush_event = os_event_create();
+
 		srv_checkpoint_completed_event = os_event_create();
 
 		if (srv_track_changed_pages) {
@@ -1152,6 +1167,12 @@ srv_free(void)
 	if (!srv_read_only_mode) {
 		os_event_free(srv_buf_dump_event);
 		srv_buf_dump_event = NULL;
+
+		os_event_free(srv_ibuf_merge_event);
+		srv_ibuf_merge_event = NULL;
+
+		os_event_free(srv_fil_flush_event);
+		srv_fil_flush_event = NULL;
 	}
 }
 
@@ -2259,11 +2280,17 @@ srv_any_background_threads_are_active(void)
 		thread_active = "buf_dump_thread";
 	} else if (srv_dict_stats_thread_active) {
 		thread_active = "dict_stats_thread";
+	} else if (ibuf_merge_threads_active() > 0) {
+		thread_active = "ibuf_merge_thread";
+	} else if (fil_flush_thread_is_active()) {
+		thread_active = "fil_flush_thread";
 	}
 
 	os_event_set(srv_error_event);
 	os_event_set(srv_monitor_event);
 	os_event_set(srv_buf_dump_event);
+	os_event_set(srv_ibuf_merge_event);
+	os_event_set(srv_fil_flush_event);
 	os_event_set(lock_sys->timeout_event);
 	os_event_set(dict_stats_event);
 
@@ -2688,12 +2715,14 @@ srv_master_do_active_tasks(void)
 	srv_main_thread_op_info = "checking free log space";
 	log_free_check();
 
-	/* Do an ibuf merge */
-	srv_main_thread_op_info = "doing insert buffer merge";
-	counter_time = ut_time_us(NULL);
-	ibuf_contract_in_background(0, FALSE);
-	MONITOR_INC_TIME_IN_MICRO_SECS(
-		MONITOR_SRV_IBUF_MERGE_MICROSECOND, counter_time);
+	/* Do an ibuf merge, unless the dedicated merge threads do it */
+	if (!ibuf_merge_threads_active()) {
+		srv_main_thread_op_info = "doing insert buffer merge";
+		counter_time = ut_time_us(NULL);
+		ibuf_contract_in_background(0, FALSE);
+		MONITOR_INC_TIME_IN_MICRO_SECS(
+			MONITOR_SRV_IBUF_MERGE_MICROSECOND, counter_time);
+	}
 
 	/* Flush logs if needed */
 	srv_main_thread_op_info = "flushing log";
@@ -2780,12 +2809,14 @@ srv_master_do_idle_tasks(void)
 	srv_main_thread_op_info = "checking free log space";
 	log_free_check();
 
-	/* Do an ibuf merge */
+	/* Do an ibuf merge, unless the dedicated merge threads do it */
 	counter_time = ut_time_us(NULL);
-	srv_main_thread_op_info = "doing insert buffer merge";
-	ibuf_contract_in_background(0, TRUE);
-	MONITOR_INC_TIME_IN_MICRO_SECS(
-		MONITOR_SRV_IBUF_MERGE_MICROSECOND, counter_time);
+	if (!ibuf_merge_threads_active()) {
+		srv_main_thread_op_info = "doing insert buffer merge";
+		ibuf_contract_in_background(0, TRUE);
+		MONITOR_INC_TIME_IN_MICRO_SECS(
+			MONITOR_SRV_IBUF_MERGE_MICROSECOND, counter_time);
+	}
 
 	if (srv_shutdown_state > 0) {
 		return;
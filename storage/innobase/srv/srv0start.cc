@@ -2783,6 +2783,20 @@ files_checked:
 	}
 	os_thread_create(buf_flush_lru_manager_thread, NULL, NULL);
 
+	if (!srv_read_only_mode
+	    && srv_force_recovery < SRV_FORCE_NO_BACKGROUND) {
+
+		/* Create the dedicated change buffer merge threads. If
+		there are none, the master thread merges the change buffer. */
+		for (i = 0; i < srv_ibuf_merge_threads; ++i) {
+			os_thread_create(ibuf_merge_thread, NULL, NULL);
+		}
+	}
+
+	if (!srv_read_only_mode) {
+		os_thread_create(fil_flush_thread, NULL, NULL);
+	}
+
 #ifdef UNIV_DEBUG
 	/* buf_debug_prints = TRUE; */
 #endif /* UNIV_DEBUG */
@@ -1256,6 +1256,8 @@ sync_thread_add_level(
 	case SYNC_ANY_LATCH:
 	case SYNC_FILE_FORMAT_TAG:
 	case SYNC_DOUBLEWRITE:
+	case SYNC_DICT_TABLE_HASH:
+	case SYNC_FIL_SPACE_HASH:
 	case SYNC_THREADS:
 	case SYNC_LOCK_SYS:
 	case SYNC_LOCK_WAIT_SYS:
@@ -121,8 +121,16 @@ MI_INFO *mi_open(const char *name, int mode, uint open_flags)
     share_buff.state.rec_per_key_part=rec_per_key_part;
     share_buff.state.key_root=key_root;
     share_buff.state.key_del=key_del;
-    share_buff.key_cache= multi_key_cache_search((uchar*) name_buff,
-                                                 strlen(name_buff));
+    /*
+      Internal temporary tables use a key cache of their own, if one is
+      set up, so that they do not evict the indexes of other tables.
+    */
+    if (internal_table && myisam_internal_key_cache &&
+        myisam_internal_key_cache->can_be_used)
+      share_buff.key_cache= myisam_internal_key_cache;
+    else
+      share_buff.key_cache= multi_key_cache_search((uchar*) name_buff,
+                                                   strlen(name_buff));
 
     DBUG_EXECUTE_IF("myisam_pretend_crashed_table_on_open",
                     if (strstr(name, "/t1"))
@@ -39,6 +39,7 @@ ulong myisam_concurrent_insert= 0;
 #endif
 ulonglong myisam_max_temp_length= MAX_FILE_SIZE;
 ulong    myisam_data_pointer_size=4;
+KEY_CACHE *myisam_internal_key_cache= 0;
 ulonglong    myisam_mmap_size= SIZE_T_MAX, myisam_mmap_used= 0;
 
 static int always_valid(const char *filename __attribute__((unused)))
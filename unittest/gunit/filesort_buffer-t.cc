@@ -20,6 +20,7 @@
 
 #include "filesort_utils.h"
 #include "table.h"
+#include "sql_sort.h"
 
 namespace filesort_buffer_unittest {
 
@@ -86,4 +87,39 @@ TEST_F(FileSortBufferTest, AssignmentOperator)
 }
 
 
+
+/*
+  Sorting with several threads must give the same order as sorting with one,
+  also for keys that compare equal.
+ */
+TEST_F(FileSortBufferTest, ParallelSortBuffer)
+{
+  const uint num_records= 100000;
+  Filesort_info serial_info;
+  fs_info.alloc_sort_buffer(num_records, sizeof(uint32));
+  serial_info.alloc_sort_buffer(num_records, sizeof(uint32));
+  for (uint ix= 0; ix < num_records; ++ix)
+  {
+    mi_int4store(fs_info.get_record_buffer(ix), (ix * 7919) % 1000);
+    mi_int4store(serial_info.get_record_buffer(ix), (ix * 7919) % 1000);
+  }
+  const uchar *start= fs_info.get_sort_keys()[0];
+  const uchar *serial_start= serial_info.get_sort_keys()[0];
+
+  Sort_param param;
+  param.sort_length= sizeof(uint32);
+  param.sort_threads= 4;
+  fs_info.sort_buffer(&param, num_records);
+  param.sort_threads= 1;
+  serial_info.sort_buffer(&param, num_records);
+
+  uchar **keys= fs_info.get_sort_keys();
+  uchar **serial_keys= serial_info.get_sort_keys();
+  for (uint ix= 0; ix < num_records; ++ix)
+  {
+    EXPECT_EQ(serial_keys[ix] - serial_start, keys[ix] - start);
+  }
+  serial_info.free_sort_buffer();
+}
+
 }  // namespace
@@ -33,6 +33,9 @@ namespace filesort_compare_unittest {
   radixsort -        requires extra memory: array of n pointers,
                      seems to be quite fast on intel *when it is appliccable*:
                      if (size <= 20 && items >= 1000 && items < 100000)
+  msd_radixsort -    requires extra memory: two arrays of n (prefix, pointer)
+                     pairs, works for any size, used by filesort for
+                     1000 items or more when radixsort is not appliccable
   std::sort -        requires no extra memory,
                      typically implemented with introsort/insertion sort
   std::stable_sort - requires extra memory: array of n pointers,
@@ -323,6 +326,35 @@ TEST_F(FileSortCompareTest, RadixSort)
   }
 }
 
+TEST_F(FileSortCompareTest, MsdRadixSort)
+{
+  for (int ix= 0; ix < num_iterations; ++ix)
+  {
+    std::vector<uchar*> keys(sort_keys, sort_keys + num_records);
+    EXPECT_TRUE(msd_radixsort_for_str_ptr(&keys[0], num_records,
+                                          record_size));
+  }
+}
+
+/*
+  The MSD radix sort is stable, so it must give exactly the same result as
+  std::stable_sort, for keys of any length.
+ */
+TEST_F(FileSortCompareTest, MsdRadixSortIsStable)
+{
+  const size_t key_lengths[]= { 1, 3, record_size, 9, 11 };
+  for (int ix= 0; ix < array_size(key_lengths); ++ix)
+  {
+    std::vector<uchar*> keys(sort_keys, sort_keys + num_records);
+    std::vector<uchar*> expected(sort_keys, sort_keys + num_records);
+    EXPECT_TRUE(msd_radixsort_for_str_ptr(&keys[0], num_records,
+                                          key_lengths[ix]));
+    std::stable_sort(expected.begin(), expected.end(),
+                     Mem_compare_memcmp(key_lengths[ix]));
+    EXPECT_TRUE(keys == expected);
+  }
+}
+
 TEST_F(FileSortCompareTest, MyQsort)
 {
   size_t size= record_size;
@@ -0,0 +1,222 @@
+/* Copyright (c) 2013, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include "test_utils.h"
+#include "fake_table.h"
+
+#include "item_cmpfunc.h"
+#include "sql_scan_filter.h"
+
+#include <vector>
+
+namespace scan_filter_unittest {
+
+using my_testing::Server_initializer;
+
+/*
+  A table with the columns a INT NOT NULL and b INT UNSIGNED NOT NULL,
+  stored in a record buffer of its own.
+*/
+class ScanFilterTest : public ::testing::Test
+{
+protected:
+  // Evaluate the conditions this many times. Increase value for benchmarking!
+  static const int num_iterations= 1;
+  // Number of rows.
+  static const int num_rows= 100 * 1000;
+
+  ScanFilterTest()
+    : field_a(record, 11, NULL, 0, Field::NONE, "a", false, false),
+      field_b(record + 4, 10, NULL, 0, Field::NONE, "b", false, true),
+      table(&field_a, &field_b)
+  {}
+
+  virtual void SetUp()
+  {
+    initializer.SetUp();
+    memset(record, 0, sizeof(record));
+    table.record[0]= record;
+    table.in_use= thd();
+    table.const_table= false;
+    table.map= 1;
+    // Constants are stored in the fields when the conditions are fixed.
+    bitmap_init(&table.get_share()->all_set, &all_set_buf, 2, false);
+    bitmap_set_all(&table.get_share()->all_set);
+    bitmap_set_all(table.write_set);
+    table.read_set= table.write_set;
+
+    rows.reserve(num_rows * 2);
+    for (int ix= 0; ix < num_rows; ++ix)
+    {
+      rows.push_back(ix * 7919 % 2001 - 1000);
+      rows.push_back(ix * 104729 % 5000);
+    }
+  }
+
+  virtual void TearDown() { initializer.TearDown(); }
+
+  THD *thd() { return initializer.thd(); }
+
+  void set_row(int ix)
+  {
+    int4store(record, rows[2 * ix]);
+    int4store(record + 4, rows[2 * ix + 1]);
+  }
+
+  Item *fix(Item *cond)
+  {
+    EXPECT_FALSE(cond->fix_fields(thd(), &cond));
+    return cond;
+  }
+
+  // -100 < a AND a <= 500 AND b <> 17 AND b > 1000
+  Item *make_condition()
+  {
+    Item_cond_and *cond=
+      new Item_cond_and(new Item_func_lt(new Item_int(-100),
+                                         new Item_field(&field_a)),
+                        new Item_func_le(new Item_field(&field_a),
+                                         new Item_int(500)));
+    cond->add(new Item_func_ne(new Item_field(&field_b), new Item_int(17)));
+    cond->add(new Item_func_gt(new Item_field(&field_b), new Item_int(1000)));
+    return fix(cond);
+  }
+
+  Server_initializer initializer;
+  uchar record[8];
+  Field_long field_a;
+  Field_long field_b;
+  Fake_TABLE table;
+  uint32 all_set_buf;
+  std::vector<int> rows;
+};
+
+
+TEST_F(ScanFilterTest, SameResultAsItems)
+{
+  Item *cond= make_condition();
+  Scan_filter *filter= Scan_filter::compile(&table, cond);
+  ASSERT_TRUE(filter != NULL);
+  EXPECT_TRUE(filter->is_complete());
+  EXPECT_EQ(4U, filter->predicate_count());
+
+  int found= 0;
+  for (int ix= 0; ix < num_rows; ++ix)
+  {
+    set_row(ix);
+    const bool expected= cond->val_int() != 0;
+    EXPECT_EQ(expected, filter->eval());
+    found+= expected;
+  }
+  EXPECT_LT(0, found);
+  EXPECT_GT(num_rows, found);
+}
+
+
+TEST_F(ScanFilterTest, UnsignedColumn)
+{
+  const longlong values[]= { -1, 0, 17, 4294967295LL, 4294967296LL };
+  for (size_t ix= 0; ix < array_elements(values); ++ix)
+  {
+    Item *cond= fix(new Item_func_ge(new Item_field(&field_b),
+                                     new Item_int(values[ix])));
+    Scan_filter *filter= Scan_filter::compile(&table, cond);
+    ASSERT_TRUE(filter != NULL);
+    for (int row= 0; row < 1000; ++row)
+    {
+      set_row(row);
+      EXPECT_EQ(cond->val_int() != 0, filter->eval());
+    }
+  }
+}
+
+
+TEST_F(ScanFilterTest, PrefixOfConjuncts)
+{
+  // a > 0 AND a + 1 > 1 AND b < 10: only the first conjunct is compiled.
+  Item_cond_and *cond=
+    new Item_cond_and(new Item_func_gt(new Item_field(&field_a),
+                                       new Item_int(0)),
+                      new Item_func_gt(new Item_func_plus(
+                                         new Item_field(&field_a),
+                                         new Item_int(1)),
+                                       new Item_int(1)));
+  cond->add(new Item_func_lt(new Item_field(&field_b), new Item_int(10)));
+  Item *item= fix(cond);
+  Scan_filter *filter= Scan_filter::compile(&table, item);
+  ASSERT_TRUE(filter != NULL);
+  EXPECT_FALSE(filter->is_complete());
+  EXPECT_EQ(1U, filter->predicate_count());
+
+  Item *unsupported= fix(new Item_func_gt(new Item_func_plus(
+                                            new Item_field(&field_a),
+                                            new Item_int(1)),
+                                          new Item_int(1)));
+  EXPECT_TRUE(Scan_filter::compile(&table, unsupported) == NULL);
+}
+
+
+TEST_F(ScanFilterTest, NullConstant)
+{
+  Item *cond= fix(new Item_func_eq(new Item_field(&field_a), new Item_null()));
+  Scan_filter *filter= Scan_filter::compile(&table, cond);
+  ASSERT_TRUE(filter != NULL);
+  set_row(0);
+  EXPECT_FALSE(filter->eval());
+}
+
+
+/*
+  The two tests below filter the same rows, each one runs num_iterations.
+  Compare their running times to get the rows filtered per second.
+ */
+TEST_F(ScanFilterTest, BenchmarkItems)
+{
+  Item *cond= make_condition();
+  int found= 0;
+  for (int iter= 0; iter < num_iterations; ++iter)
+  {
+    for (int ix= 0; ix < num_rows; ++ix)
+    {
+      set_row(ix);
+      found+= cond->val_int() != 0;
+    }
+  }
+  EXPECT_LT(0, found);
+}
+
+
+TEST_F(ScanFilterTest, BenchmarkScanFilter)
+{
+  Item *cond= make_condition();
+  Scan_filter *filter= Scan_filter::compile(&table, cond);
+  ASSERT_TRUE(filter != NULL);
+  int found= 0;
+  for (int iter= 0; iter < num_iterations; ++iter)
+  {
+    for (int ix= 0; ix < num_rows; ++ix)
+    {
+      set_row(ix);
+      found+= filter->eval();
+    }
+  }
+  EXPECT_LT(0, found);
+}
+
+}